@@ -9,11 +9,17 @@
 #include "encoder-ffmpeg.hpp"
 #include "strings.hpp"
 #include "codecs/hevc.hpp"
+#include "ffmpeg/catalog.hpp"
+#include "ffmpeg/format-negotiator.hpp"
 #include "ffmpeg/tools.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
+#include "util/util-affinity.hpp"
+#include "util/util-hugepage.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include "warning-enable.hpp"
 
@@ -46,6 +52,9 @@ extern "C" {
 #define ST_KEY_FFMPEG_FRAMERATE "FFmpeg.Framerate"
 #define ST_I18N_FFMPEG_GPU ST_I18N_FFMPEG ".GPU"
 #define ST_KEY_FFMPEG_GPU "FFmpeg.GPU"
+#define ST_I18N_FFMPEG_GPUCONVERSION ST_I18N_FFMPEG ".GPUConversion"
+#define ST_I18N_FFMPEG_PARALLEL ST_I18N_FFMPEG ".Parallel"
+#define ST_KEY_FFMPEG_PARALLEL "FFmpeg.Parallel"
 
 #define ST_I18N_KEYFRAMES ST_I18N_FFMPEG ".KeyFrames"
 #define ST_I18N_KEYFRAMES_INTERVALTYPE ST_I18N_KEYFRAMES ".IntervalType"
@@ -55,6 +64,22 @@ extern "C" {
 #define ST_KEY_KEYFRAMES_INTERVAL_SECONDS "KeyFrames.Interval.Seconds"
 #define ST_KEY_KEYFRAMES_INTERVAL_FRAMES "KeyFrames.Interval.Frames"
 
+#define ST_I18N_ROI ST_I18N_FFMPEG ".RegionOfInterest"
+#define ST_I18N_ROI_TRACKING ST_I18N_ROI ".Tracking"
+#define ST_KEY_ROI_TRACKING "RegionOfInterest.Tracking"
+#define ST_I18N_ROI_MANUAL ST_I18N_ROI ".Manual"
+#define ST_KEY_ROI_MANUAL "RegionOfInterest.Manual"
+#define ST_I18N_ROI_MANUAL_LEFT ST_I18N_ROI_MANUAL ".Left"
+#define ST_KEY_ROI_MANUAL_LEFT "RegionOfInterest.Manual.Left"
+#define ST_I18N_ROI_MANUAL_TOP ST_I18N_ROI_MANUAL ".Top"
+#define ST_KEY_ROI_MANUAL_TOP "RegionOfInterest.Manual.Top"
+#define ST_I18N_ROI_MANUAL_RIGHT ST_I18N_ROI_MANUAL ".Right"
+#define ST_KEY_ROI_MANUAL_RIGHT "RegionOfInterest.Manual.Right"
+#define ST_I18N_ROI_MANUAL_BOTTOM ST_I18N_ROI_MANUAL ".Bottom"
+#define ST_KEY_ROI_MANUAL_BOTTOM "RegionOfInterest.Manual.Bottom"
+#define ST_I18N_ROI_STRENGTH ST_I18N_ROI ".Strength"
+#define ST_KEY_ROI_STRENGTH "RegionOfInterest.Strength"
+
 using namespace streamfx::encoder::ffmpeg;
 using namespace streamfx::encoder::codec;
 
@@ -71,28 +96,57 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 
 	  _hwapi(), _hwinst(),
 
-	  _lag_in_frames(0), _sent_frames(0), _have_first_frame(false), _extra_data(), _sei_data(),
+	  _lag_in_frames(0), _sent_frames(0), _last_key_pts(AV_NOPTS_VALUE), _have_first_frame(false), _headers_pending(false), _extra_data(), _sei_data(),
+
+	  _free_frames(), _used_frames(), _free_frames_last_used(),
+
+	  _realtime(), _realtime_pending(false), _custom_options(),
+
+	  _standby_lock(), _standby_settings(nullptr), _standby(nullptr), _configuring(nullptr), _standby_task(), _standby_requested(), _standby_open_time(0),
+
+	  _retired(), _pending_packets(), _switch_count(0), _switch_dropped(0),
 
-	  _free_frames(), _used_frames(), _free_frames_last_used()
+	  _roi_lock(), _roi_registry(::streamfx::util::roi::registry::instance()), _roi_tracking(false), _roi_manual(false), _roi_manual_region(), _roi_strength(0),
+
+	  _parallel()
 {
+#ifdef ENABLE_PROFILING
+	_profile_encode = ::streamfx::util::profiler::create();
+#endif
+
 	// Initialize GPU Stuff
 	if (is_hw) {
+		auto format = video_output_get_info(obs_encoder_video(_self))->format;
+
 		// Abort if user specified manual override.
-		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || (obs_encoder_scaling_enabled(_self)) || (video_output_get_info(obs_encoder_video(_self))->format != VIDEO_FORMAT_NV12)) {
+		if ((obs_data_get_int(settings, ST_KEY_FFMPEG_GPU) != -1) || (obs_encoder_scaling_enabled(_self)) || ((format != VIDEO_FORMAT_NV12) && (format != VIDEO_FORMAT_P010))) {
 			throw std::runtime_error("Selected settings prevent the use of hardware encoding, falling back to software.");
 		}
 
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+		// Textures are converted on the GPU and read back, so no hardware API is necessary. This is opt-in, through its own encoder.
+		if (!_factory->is_texture_variant(_self)) {
+			throw std::runtime_error("OBS Studio currently does not support zero copy encoding for this platform.");
+		}
+#else
+		if (format != VIDEO_FORMAT_NV12) {
+			throw std::runtime_error("Selected settings prevent the use of hardware encoding, falling back to software.");
+		}
+#endif
+
 #ifdef WIN32
 		auto gctx = streamfx::obs::gs::context();
 		if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
 			_hwapi = std::make_shared<::streamfx::ffmpeg::hwapi::d3d11>();
 		}
 #endif
+#if !(defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30))
 		if (!_hwapi) {
 			throw std::runtime_error("Failed to create acceleration context.");
 		}
 
 		_hwinst = _hwapi->create_from_obs();
+#endif
 	}
 
 	// Initialize context.
@@ -121,19 +175,141 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 		_context->framerate.den *= _framerate_divisor;
 	}
 
+	// Set up realtime control, if the handler supports it. The level is applied while configuring, before custom options.
+	if (realtime_controller::settings rt; !_hwinst && _handler && _handler->has_realtime_control(_factory, settings, rt)) {
+		auto interval = std::chrono::nanoseconds(static_cast<int64_t>(1000000000. * av_q2d(_context->time_base)));
+		_realtime     = std::make_unique<realtime_controller>(rt, interval);
+	}
+
 	// Update settings
 	update(settings);
 
-	// Initialize Encoder
-	auto gctx = streamfx::obs::gs::context();
-	int  res  = avcodec_open2(_context, _codec, NULL);
-	if (res < 0) {
-		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	// Initialize Encoder, any threads it spawns start out on the encoder processors.
+	if (std::size_t parallel = static_cast<std::size_t>(obs_data_get_int(settings, ST_KEY_FFMPEG_PARALLEL)); !_hwinst && (parallel > 1) && _handler && _handler->has_frame_parallelism(_factory)) {
+		// The contexts take turns instead, so frame threading would only add delay. The remaining threads are split between them.
+		_context->thread_type &= ~FF_THREAD_FRAME;
+		_context->thread_count = (_context->thread_type != 0) ? std::max(1, _context->thread_count / static_cast<int>(parallel)) : 1;
+		_context->delay        = 0;
+
+		// The original context only serves as a template from here on.
+		std::vector<AVCodecContext*> contexts;
+		try {
+			streamfx::util::affinity::scope affinity(streamfx::util::affinity::role::Encoder);
+			for (std::size_t idx = 0; idx < parallel; idx++) {
+				contexts.push_back(clone_context(true));
+				int res = avcodec_open2(contexts.back(), _codec, NULL);
+				if (res < 0) {
+					throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+				}
+			}
+			_parallel = std::make_unique<parallel_encoder>(contexts);
+		} catch (...) {
+			for (auto context : contexts) {
+				avcodec_free_context(&context);
+			}
+			throw;
+		}
+		DLOG_INFO("[%s] Encoding in parallel on %zu contexts, with %" PRId32 " threads each.", _codec->name, _parallel->size(), _context->thread_count);
+	} else {
+		auto                            gctx = streamfx::obs::gs::context();
+		streamfx::util::affinity::scope affinity(streamfx::util::affinity::role::Encoder);
+		int                             res = avcodec_open2(_context, _codec, NULL);
+		if (res < 0) {
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
+	}
+	streamfx::util::affinity::policy::instance()->report();
+
+	if (!_hwinst) {
+		// Fill the pool with as many frames as the encoder holds on to, so that their pages are faulted in before the first frame arrives.
+		std::size_t                           count = (_parallel ? (_parallel->size() * 2) : static_cast<std::size_t>(std::max(_context->delay, 0))) + 1;
+		std::vector<std::shared_ptr<AVFrame>> frames;
+		for (std::size_t idx = 0; idx < count; idx++) {
+			frames.push_back(pop_free_frame());
+		}
+		for (auto& frame : frames) {
+			push_free_frame(frame);
+		}
+		::streamfx::util::hugepage::report();
 	}
 }
 
 ffmpeg_instance::~ffmpeg_instance()
 {
+	// Wait for any background work on contexts to finish.
+	if (_standby_task) {
+		_standby_task->await_completion();
+		_standby_task.reset();
+	}
+	if (_standby) {
+		avcodec_free_context(&_standby);
+	}
+	if (_standby_settings) {
+		obs_data_release(_standby_settings);
+		_standby_settings = nullptr;
+	}
+	for (auto& retired : _retired) {
+		retired->task->await_completion();
+		_switch_dropped += retired->dropped;
+	}
+	_retired.clear();
+	if (_switch_count > 0) {
+		DLOG_INFO("[%s] Switched context %zu times, dropping %zu frames in total.", _codec->name, _switch_count, _switch_dropped);
+	}
+#ifdef ENABLE_PROFILING
+	if (_profile_encode->count() > 0) {
+		// Compare against the same encoder with and without GPU conversion to see what the conversion saves.
+		const char* path = _hwinst ? "hardware frames" : "libswscale";
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+		if (_converter) {
+			path = "GPU conversion";
+		}
+#endif
+		DLOG_INFO("[%s] CPU time per frame (%s): %.3fus average, %" PRId64 "us 50th percentile, %" PRId64 "us 99th percentile, over %" PRIu64 " frames.", _codec->name, path, _profile_encode->average_duration() / 1000., static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(_profile_encode->percentile(0.5)).count()), static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(_profile_encode->percentile(0.99)).count()), _profile_encode->count());
+	}
+#endif
+
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+	if (_converter) {
+		// Frames still staged on the GPU have to reach the codec before it is flushed.
+		while (_context && (_converter->size() > 0)) {
+			std::shared_ptr<AVFrame> vframe = pop_free_frame();
+			vframe->color_range             = _context->color_range;
+			vframe->colorspace              = _context->colorspace;
+			vframe->color_primaries         = _context->color_primaries;
+			vframe->color_trc               = _context->color_trc;
+			if (!_converter->pop(vframe.get())) {
+				continue;
+			}
+
+			int res = 0;
+			while ((res = send_frame(vframe)) == AVERROR(EAGAIN)) {
+				// Full, make room by discarding the oldest packet. Nothing is read anymore at this point.
+				auto gctx = streamfx::obs::gs::context();
+				if (avcodec_receive_packet(_context, _packet.get()) != 0) {
+					break;
+				}
+				push_free_frame(pop_used_frame());
+			}
+		}
+
+		auto gctx = streamfx::obs::gs::context();
+		_converter.reset();
+	}
+#endif
+
+	if (_parallel) {
+		// Every frame that was handed to a context is encoded before the threads stop. libOBS has no way to drain an encoder though, so those packets can't be handed out anymore, just like the ones flushed from a single context below.
+		std::size_t undelivered = _parallel->finish();
+		if (_parallel->received() > 0) {
+			DLOG_INFO("[%s] Encoded %zu frames on %zu contexts at %.2f frames per second, with the contexts busy %.1f%% of the time, %zu frames failed and %zu dropped because the contexts couldn't keep up.", _codec->name, _parallel->received(), _parallel->size(), _parallel->throughput(), _parallel->utilization() * 100., _parallel->failed(), _parallel->dropped());
+		}
+		if (undelivered > 0) {
+			DLOG_INFO("[%s] %zu packets were still in flight when encoding stopped.", _codec->name, undelivered);
+		}
+		_parallel.reset();
+	}
+
 	auto gctx = streamfx::obs::gs::context();
 	if (_context) {
 		// Flush encoders that require it.
@@ -165,6 +341,7 @@ void ffmpeg_instance::get_properties(obs_properties_t* props)
 
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_THREADS), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_GPU), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_PARALLEL), false);
 }
 
 void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
@@ -175,6 +352,52 @@ void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
 
 bool ffmpeg_instance::update(obs_data_t* settings)
 {
+	if (_handler && _handler->has_roi(_factory)) {
+		// Regions of Interest are applied per frame, so they never need a standby context.
+		std::lock_guard<std::mutex> lg(_roi_lock);
+		_roi_tracking             = obs_data_get_bool(settings, ST_KEY_ROI_TRACKING);
+		_roi_manual               = obs_data_get_bool(settings, ST_KEY_ROI_MANUAL);
+		_roi_manual_region.left   = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROI_MANUAL_LEFT) / 100.);
+		_roi_manual_region.top    = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROI_MANUAL_TOP) / 100.);
+		_roi_manual_region.right  = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROI_MANUAL_RIGHT) / 100.);
+		_roi_manual_region.bottom = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROI_MANUAL_BOTTOM) / 100.);
+		_roi_strength             = static_cast<float>(obs_data_get_double(settings, ST_KEY_ROI_STRENGTH) / 100.);
+	}
+
+	if (_parallel) {
+		// Every context would have to be replaced at once, and intra-only codecs are rarely used for anything but recording.
+		DLOG_WARNING("[%s] Settings can't be changed while encoding in parallel.", _codec->name);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lg(_standby_lock);
+
+	bool support_reconfig = false;
+	if (_handler) {
+		bool threads = false, gpu = false, keyframes = false;
+		support_reconfig = _handler->is_reconfigurable(_factory, threads, gpu, keyframes);
+	}
+
+	if (_context->internal && !support_reconfig) {
+		// The open context can't be changed, so the settings go to a standby context which takes over at the next key frame.
+		if (_standby_settings) {
+			obs_data_release(_standby_settings);
+		}
+		obs_data_addref(settings);
+		_standby_settings  = settings;
+		_standby_requested = std::chrono::high_resolution_clock::now();
+		return true;
+	}
+
+	configure(settings);
+	return true;
+}
+
+void ffmpeg_instance::configure(obs_data_t* settings)
+{
+	// Either the live context, or a standby context that is being prepared.
+	AVCodecContext* context = get_avcodeccontext();
+
 	bool support_reconfig           = false;
 	bool support_reconfig_threads   = false;
 	bool support_reconfig_gpu       = false;
@@ -183,48 +406,48 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 		support_reconfig = _handler->is_reconfigurable(_factory, support_reconfig_threads, support_reconfig_gpu, support_reconfig_keyframes);
 	}
 
-	if (!_context->internal) {
+	if (!context->internal) {
 		// FFmpeg Options
-		_context->debug                 = 0;
-		_context->strict_std_compliance = FF_COMPLIANCE_NORMAL;
+		context->debug                 = 0;
+		context->strict_std_compliance = FF_COMPLIANCE_NORMAL;
 	}
 
-	if (!_context->internal || (support_reconfig && support_reconfig_threads)) {
+	if (!context->internal || (support_reconfig && support_reconfig_threads)) {
 		/// Threading
 		if (!_hwinst) {
-			_context->thread_type = 0;
+			context->thread_type = 0;
 			if (_codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
-				_context->thread_type |= FF_THREAD_FRAME;
+				context->thread_type |= FF_THREAD_FRAME;
 			}
 			if (_codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
-				_context->thread_type |= FF_THREAD_SLICE;
+				context->thread_type |= FF_THREAD_SLICE;
 			}
-			if (_context->thread_type != 0) {
+			if (context->thread_type != 0) {
 				int64_t threads = obs_data_get_int(settings, ST_I18N_FFMPEG_THREADS);
 				if (threads > 0) {
-					_context->thread_count = static_cast<int>(threads);
+					context->thread_count = static_cast<int>(threads);
 				} else {
-					_context->thread_count = static_cast<int>(std::thread::hardware_concurrency());
+					context->thread_count = static_cast<int>(streamfx::util::affinity::policy::instance()->concurrency(streamfx::util::affinity::role::Encoder));
 				}
 			} else {
-				_context->thread_count = 1;
+				context->thread_count = 1;
 			}
 
 			// Frame Delay (Lag In Frames)
-			_context->delay = _context->thread_count;
+			context->delay = context->thread_count;
 		} else {
-			_context->delay = 0;
+			context->delay = 0;
 		}
 	}
 
-	if (!_context->internal || (support_reconfig && support_reconfig_gpu)) {
+	if (!context->internal || (support_reconfig && support_reconfig_gpu)) {
 		// Apply GPU Selection
-		if (!_hwinst && ::streamfx::ffmpeg::tools::can_hardware_encode(_codec)) {
-			av_opt_set_int(_context, "gpu", (int)obs_data_get_int(settings, ST_KEY_FFMPEG_GPU), AV_OPT_SEARCH_CHILDREN);
+		if (!_hwinst && ::streamfx::ffmpeg::catalog::instance()->get(_codec)->is_hardware()) {
+			av_opt_set_int(context, "gpu", (int)obs_data_get_int(settings, ST_KEY_FFMPEG_GPU), AV_OPT_SEARCH_CHILDREN);
 		}
 	}
 
-	if (!_context->internal || (support_reconfig && support_reconfig_keyframes)) {
+	if (!context->internal || (support_reconfig && support_reconfig_keyframes)) {
 		// Keyframes
 		if (_handler && _handler->has_keyframes(_factory)) {
 			// Key-Frame Options
@@ -237,25 +460,30 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 			bool    is_seconds = (kf_type == 0);
 
 			if (is_seconds) {
-				double framerate   = static_cast<double>(ovi.fps_num) / (static_cast<double>(ovi.fps_den) * _framerate_divisor);
-				_context->gop_size = static_cast<int>(obs_data_get_double(settings, ST_KEY_KEYFRAMES_INTERVAL_SECONDS) * framerate);
+				double framerate  = static_cast<double>(ovi.fps_num) / (static_cast<double>(ovi.fps_den) * _framerate_divisor);
+				context->gop_size = static_cast<int>(obs_data_get_double(settings, ST_KEY_KEYFRAMES_INTERVAL_SECONDS) * framerate);
 			} else {
-				_context->gop_size = static_cast<int>(obs_data_get_int(settings, ST_KEY_KEYFRAMES_INTERVAL_FRAMES));
+				context->gop_size = static_cast<int>(obs_data_get_int(settings, ST_KEY_KEYFRAMES_INTERVAL_FRAMES));
 			}
-			_context->keyint_min = _context->gop_size;
+			context->keyint_min = context->gop_size;
 		}
 	}
 
-	if (!_context->internal || support_reconfig) {
+	if (!context->internal || support_reconfig) {
 		// Handler Options
 		if (_handler)
 			_handler->update(this->_factory, this, settings);
 
+		// Realtime Control, before custom options so that those always win.
+		if (_handler && _realtime)
+			_handler->apply_realtime_level(this->_factory, this, _realtime->level());
+
 		{ // FFmpeg Custom Options
 			const char* opts     = obs_data_get_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS);
 			std::size_t opts_len = strnlen(opts, 65535);
 
-			parse_ffmpeg_commandline(std::string{opts, opts + opts_len});
+			_custom_options = std::string{opts, opts + opts_len};
+			parse_ffmpeg_commandline(_custom_options);
 		}
 
 		// Handler Overrides
@@ -264,38 +492,54 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	}
 
 	// Handler Logging
-	if (!_context->internal || support_reconfig) {
+	if (!context->internal || support_reconfig) {
 		DLOG_INFO("[%s] Configuration:", _codec->name);
 		DLOG_INFO("[%s]   FFmpeg:", _codec->name);
 		DLOG_INFO("[%s]     Custom Settings: %s", _codec->name, obs_data_get_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS));
-		DLOG_INFO("[%s]     Standard Compliance: %s", _codec->name, ::streamfx::ffmpeg::tools::get_std_compliance_name(_context->strict_std_compliance));
-		DLOG_INFO("[%s]     Threading: %s (with %i threads)", _codec->name, ::streamfx::ffmpeg::tools::get_thread_type_name(_context->thread_type), _context->thread_count);
+		DLOG_INFO("[%s]     Standard Compliance: %s", _codec->name, ::streamfx::ffmpeg::tools::get_std_compliance_name(context->strict_std_compliance));
+		DLOG_INFO("[%s]     Threading: %s (with %i threads)", _codec->name, ::streamfx::ffmpeg::tools::get_thread_type_name(context->thread_type), context->thread_count);
 
 		DLOG_INFO("[%s]   Video:", _codec->name);
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+		if (_converter) {
+			DLOG_INFO("[%s]     Texture: %" PRId32 "x%" PRId32 " %s %s %s (converted on GPU, %zu frames in flight)", _codec->name, context->width, context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(context->pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(context->colorspace), av_color_range_name(context->color_range), _converter->depth());
+		} else if (_hwinst) {
+#else
 		if (_hwinst) {
-			DLOG_INFO("[%s]     Texture: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _context->width, _context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(_context->sw_pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(_context->colorspace), av_color_range_name(_context->color_range));
+#endif
+			DLOG_INFO("[%s]     Texture: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, context->width, context->height, ::streamfx::ffmpeg::tools::get_pixel_format_name(context->sw_pix_fmt), ::streamfx::ffmpeg::tools::get_color_space_name(context->colorspace), av_color_range_name(context->color_range));
 		} else {
 			DLOG_INFO("[%s]     Input: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_source_width(), _scaler.get_source_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()), _scaler.is_source_full_range() ? "Full" : "Partial");
 			DLOG_INFO("[%s]     Output: %" PRId32 "x%" PRId32 " %s %s %s", _codec->name, _scaler.get_target_width(), _scaler.get_target_height(), ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()), ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_target_colorspace()), _scaler.is_target_full_range() ? "Full" : "Partial");
 			if (!_hwinst)
 				DLOG_INFO("[%s]     On GPU Index: %lli", _codec->name, obs_data_get_int(settings, ST_KEY_FFMPEG_GPU));
 		}
-		DLOG_INFO("[%s]     Framerate: %" PRId32 "/%" PRId32 " (%f FPS)", _codec->name, _context->time_base.den, _context->time_base.num, static_cast<double_t>(_context->time_base.den) / static_cast<double_t>(_context->time_base.num));
+		DLOG_INFO("[%s]     Framerate: %" PRId32 "/%" PRId32 " (%f FPS)", _codec->name, context->time_base.den, context->time_base.num, static_cast<double_t>(context->time_base.den) / static_cast<double_t>(context->time_base.num));
 
 		DLOG_INFO("[%s]   Keyframes: ", _codec->name);
-		if (_context->keyint_min != _context->gop_size) {
-			DLOG_INFO("[%s]     Minimum: %i frames", _codec->name, _context->keyint_min);
-			DLOG_INFO("[%s]     Maximum: %i frames", _codec->name, _context->gop_size);
+		if (context->keyint_min != context->gop_size) {
+			DLOG_INFO("[%s]     Minimum: %i frames", _codec->name, context->keyint_min);
+			DLOG_INFO("[%s]     Maximum: %i frames", _codec->name, context->gop_size);
 		} else {
-			DLOG_INFO("[%s]     Distance: %i frames", _codec->name, _context->gop_size);
+			DLOG_INFO("[%s]     Distance: %i frames", _codec->name, context->gop_size);
+		}
+
+		if (_handler && _handler->has_roi(_factory)) {
+			std::lock_guard<std::mutex> lg(_roi_lock);
+			DLOG_INFO("[%s]   Regions of Interest:", _codec->name);
+			DLOG_INFO("[%s]     Tracking: %s", _codec->name, _roi_tracking ? "Enabled" : "Disabled");
+			if (_roi_manual) {
+				DLOG_INFO("[%s]     Manual: %.1f%%x%.1f%% to %.1f%%x%.1f%%", _codec->name, _roi_manual_region.left * 100., _roi_manual_region.top * 100., _roi_manual_region.right * 100., _roi_manual_region.bottom * 100.);
+			} else {
+				DLOG_INFO("[%s]     Manual: Disabled", _codec->name);
+			}
+			DLOG_INFO("[%s]     Strength: %.1f%%", _codec->name, _roi_strength * 100.);
 		}
 
 		if (_handler) {
 			_handler->log(this->_factory, this, settings);
 		}
 	}
-
-	return true;
 }
 
 static inline void copy_data(encoder_frame* frame, AVFrame* vframe)
@@ -339,6 +583,10 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		return true;
 	}
 
+#ifdef ENABLE_PROFILING
+	auto profile = _profile_encode->track();
+#endif
+
 	std::shared_ptr<AVFrame> vframe = pop_free_frame(); // Retrieve an empty frame.
 
 	// Convert frame.
@@ -402,23 +650,70 @@ bool ffmpeg_instance::encode_video(uint32_t handle, int64_t pts, uint64_t lock_k
 #endif
 }
 
-void ffmpeg_instance::initialize_sw(obs_data_t* settings)
+#if LIBOBS_API_MAJOR_VER >= 30
+bool ffmpeg_instance::encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet)
+{
+#if defined(D_PLATFORM_LINUX)
+	*next_key = lock_key;
+	if ((_framerate_divisor > 1) && (pts % _framerate_divisor != 0)) {
+		return true;
+	}
+
+	if (!_converter) {
+		return encode_video(texture->handle, pts, lock_key, next_key, packet, received_packet);
+	}
+
+#ifdef ENABLE_PROFILING
+	auto profile = _profile_encode->track();
+#endif
+
+	auto gctx = streamfx::obs::gs::context();
+
+	// Read back the oldest frame once the ring is full, by now the GPU should be done with it.
+	if (_converter->is_full()) {
+		std::shared_ptr<AVFrame> vframe = pop_free_frame();
+
+		vframe->color_range     = _context->color_range;
+		vframe->colorspace      = _context->colorspace;
+		vframe->color_primaries = _context->color_primaries;
+		vframe->color_trc       = _context->color_trc;
+		if (!_converter->pop(vframe.get())) {
+			// The frame is lost, but the ring has moved on. Skip it instead of stopping the encoder.
+			push_free_frame(vframe);
+		} else if (!encode_avframe(vframe, packet, received_packet)) {
+			return false;
+		}
+	}
+
+	return _converter->push(texture->tex, pts);
+#else
+	return encode_video(texture->handle, pts, lock_key, next_key, packet, received_packet);
+#endif
+}
+#endif
+
+AVPixelFormat ffmpeg_instance::initialize_format(obs_data_t* settings)
 {
-	// Initialize Video Encoding
 	auto voi = video_output_get_info(obs_encoder_video(_self));
 
-	// Figure out a suitable pixel format to convert to if necessary.
-	AVPixelFormat pix_fmt_source = ::streamfx::ffmpeg::tools::obs_videoformat_to_avpixelformat(voi->format);
+	// Figure out the cheapest suitable pixel format to convert to, if necessary.
+	auto          negotiator     = ::streamfx::ffmpeg::format_negotiator::instance();
+	AVPixelFormat pix_fmt_obs    = ::streamfx::ffmpeg::tools::obs_videoformat_to_avpixelformat(voi->format);
+	AVPixelFormat pix_fmt_source = AV_PIX_FMT_NONE;
 	AVPixelFormat pix_fmt_target = AV_PIX_FMT_NONE;
 	{
-		if (_codec->pix_fmts) {
-			pix_fmt_target = ::streamfx::ffmpeg::tools::get_least_lossy_format(_codec->pix_fmts, pix_fmt_source);
-		} else { // If there are no supported formats, just pass in the current one.
-			pix_fmt_target = pix_fmt_source;
-		}
+		auto negotiated = negotiator->negotiate(_codec->pix_fmts, pix_fmt_obs);
+		pix_fmt_source  = negotiated.source;
+		pix_fmt_target  = negotiated.target;
 
-		if (_handler) // Allow Handler to override the automatic color format for sanity reasons.
+		if (_handler) { // Allow Handler to override the automatic color format for sanity reasons.
 			_handler->override_colorformat(this->_factory, this, settings, pix_fmt_target);
+
+			// The cheapest source may be different for the format the handler wants.
+			if (pix_fmt_target != negotiated.target) {
+				pix_fmt_source = negotiator->negotiate(pix_fmt_target, pix_fmt_obs).source;
+			}
+		}
 	}
 
 	// Setup from OBS information.
@@ -429,6 +724,16 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 	_context->height  = static_cast<int>(obs_encoder_get_height(_self));
 	_context->pix_fmt = pix_fmt_target;
 
+	return pix_fmt_source;
+}
+
+void ffmpeg_instance::initialize_sw(obs_data_t* settings)
+{
+	// Initialize Video Encoding
+	auto          negotiator     = ::streamfx::ffmpeg::format_negotiator::instance();
+	AVPixelFormat pix_fmt_source = initialize_format(settings);
+	AVPixelFormat pix_fmt_target = _context->pix_fmt;
+
 	_scaler.set_source_size(static_cast<uint32_t>(_context->width), static_cast<uint32_t>(_context->height));
 	_scaler.set_source_color(_context->color_range == AVCOL_RANGE_JPEG, _context->colorspace);
 	_scaler.set_source_format(pix_fmt_source);
@@ -438,16 +743,27 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 	_scaler.set_target_format(pix_fmt_target);
 
 	// Create Scaler
-	if (!_scaler.initialize(SWS_SINC | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND | SWS_BITEXACT)) {
+	if (!_scaler.initialize(negotiator->flags())) {
 		std::stringstream sstr;
 		sstr << "Initializing scaler failed for conversion from '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_source_format()) << "' to '" << ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()) << "' with color space '" << ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_source_colorspace()) << "' and " << (_scaler.is_source_full_range() ? "full" : "partial") << " range.";
 		throw std::runtime_error(sstr.str());
 	}
 }
 
-void ffmpeg_instance::initialize_hw(obs_data_t*)
+void ffmpeg_instance::initialize_hw(obs_data_t* settings)
 {
-#ifndef D_PLATFORM_WINDOWS
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+	// Same setup as software encoding, except that the conversion happens on the GPU instead of in libswscale.
+	initialize_format(settings);
+	if (!::streamfx::ffmpeg::gpu_converter::is_supported(_context->pix_fmt)) {
+		throw std::runtime_error("Pixel format is not supported by GPU conversion, falling back to software.");
+	}
+
+	auto voi  = video_output_get_info(obs_encoder_video(_self));
+	auto gctx = streamfx::obs::gs::context();
+	_converter = std::make_unique<::streamfx::ffmpeg::gpu_converter>(static_cast<uint32_t>(_context->width), static_cast<uint32_t>(_context->height), _context->pix_fmt, _context->colorspace, _context->color_range);
+	_converter->set_source(voi->format, ::streamfx::ffmpeg::tools::obs_to_av_color_space(voi->colorspace), ::streamfx::ffmpeg::tools::obs_to_av_color_range(voi->range));
+#elif !defined(D_PLATFORM_WINDOWS)
 	throw std::runtime_error("OBS Studio currently does not support zero copy encoding for this platform.");
 #else
 	// Initialize Video Encoding
@@ -513,7 +829,7 @@ std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
 			frame->height = _context->height;
 			frame->format = _context->pix_fmt;
 
-			int res = av_frame_get_buffer(frame.get(), 32);
+			int res = ::streamfx::ffmpeg::tools::get_frame_buffer(frame.get(), 32);
 			if (res < 0) {
 				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
 			}
@@ -557,6 +873,11 @@ bool ffmpeg_instance::get_sei_data(uint8_t** data, size_t* size)
 
 void ffmpeg_instance::get_video_info(struct video_scale_info* info)
 {
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+	if (_converter) {
+		return;
+	}
+#endif
 	if (!is_hardware_encode()) {
 		// Override input with supported format if software encode.
 		info->format = ::streamfx::ffmpeg::tools::avpixelformat_to_obs_videoformat(_scaler.get_source_format());
@@ -569,47 +890,44 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 
 	av_packet_unref(_packet.get());
 
-	{
-		auto gctx = streamfx::obs::gs::context();
-		res       = avcodec_receive_packet(_context, _packet.get());
-	}
-	if (res != 0) {
-		return res;
-	}
-
-	if (!_have_first_frame) {
-		if (_codec->id == AV_CODEC_ID_H264) {
-			uint8_t*    tmp_packet;
-			uint8_t*    tmp_header;
-			uint8_t*    tmp_sei;
-			std::size_t sz_packet, sz_header, sz_sei;
-
-			obs_extract_avc_headers(_packet->data, static_cast<size_t>(_packet->size), &tmp_packet, &sz_packet, &tmp_header, &sz_header, &tmp_sei, &sz_sei);
-
-			if (sz_header) {
-				_extra_data.resize(sz_header);
-				std::memcpy(_extra_data.data(), tmp_header, sz_header);
+	if ((!_retired.empty() || !_pending_packets.empty()) && pop_pending_packet(_packet.get())) {
+		// Packets held back by a context switch go first. The live context only gets a turn once none of them are ready, as they would otherwise pile up faster than they leave.
+	} else {
+		if (_parallel) {
+			// Frames come back in whichever order the contexts finish them.
+			_parallel->reclaim([this](std::shared_ptr<AVFrame> frame) { push_free_frame(frame); });
+			res = _parallel->receive(_packet.get()) ? 0 : AVERROR(EAGAIN);
+		} else {
+			{
+				auto gctx = streamfx::obs::gs::context();
+				res       = avcodec_receive_packet(_context, _packet.get());
 			}
+			if (res == 0) {
+				// Push free frame back into pool.
+				push_free_frame(pop_used_frame());
 
-			if (sz_sei) {
-				_sei_data.resize(sz_sei);
-				std::memcpy(_sei_data.data(), tmp_sei, sz_sei);
+				// Key frames may come earlier than planned (scene cuts, forced key frames), so GOPs are counted from the last one actually produced.
+				if ((_packet->flags & AV_PKT_FLAG_KEY) != 0) {
+					_last_key_pts = _packet->pts;
+				}
 			}
+		}
 
-			// Not required, we only need the Extra Data and SEI Data anyway.
-			//std::memcpy(_current_packet.data, tmp_packet, sz_packet);
-			//_current_packet.size = static_cast<int>(sz_packet);
+		if ((res == 0) && (!_have_first_frame || _headers_pending)) {
+			update_headers(_packet.get());
+		}
 
-			bfree(tmp_packet);
-			bfree(tmp_header);
-			bfree(tmp_sei);
-		} else if (_codec->id == AV_CODEC_ID_HEVC) {
-			hevc::extract_header_sei(_packet->data, static_cast<size_t>(_packet->size), _extra_data, _sei_data);
-		} else if (_context->extradata != nullptr) {
-			_extra_data.resize(static_cast<size_t>(_context->extradata_size));
-			std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
+		if (!_retired.empty()) {
+			// A retired context is still draining, so new packets have to queue up behind its packets.
+			if (res == 0) {
+				std::shared_ptr<AVPacket> pending{av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
+				av_packet_move_ref(pending.get(), _packet.get());
+				_pending_packets.push(pending);
+			}
+			return AVERROR(EAGAIN);
+		} else if (res != 0) {
+			return res;
 		}
-		_have_first_frame = true;
 	}
 
 	// Allow Handler Post-Processing
@@ -675,14 +993,63 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 		}
 	}
 
-	// Push free frame back into pool.
-	push_free_frame(pop_used_frame());
-
 	return res;
 }
 
+void ffmpeg_instance::update_headers(AVPacket* packet)
+{
+	std::vector<uint8_t> extra_data = _extra_data;
+
+	if (_codec->id == AV_CODEC_ID_H264) {
+		uint8_t*    tmp_packet;
+		uint8_t*    tmp_header;
+		uint8_t*    tmp_sei;
+		std::size_t sz_packet, sz_header, sz_sei;
+
+		obs_extract_avc_headers(packet->data, static_cast<size_t>(packet->size), &tmp_packet, &sz_packet, &tmp_header, &sz_header, &tmp_sei, &sz_sei);
+
+		if (sz_header) {
+			_extra_data.resize(sz_header);
+			std::memcpy(_extra_data.data(), tmp_header, sz_header);
+		}
+
+		if (sz_sei) {
+			_sei_data.resize(sz_sei);
+			std::memcpy(_sei_data.data(), tmp_sei, sz_sei);
+		}
+
+		// Not required, we only need the Extra Data and SEI Data anyway.
+		//std::memcpy(_current_packet.data, tmp_packet, sz_packet);
+		//_current_packet.size = static_cast<int>(sz_packet);
+
+		bfree(tmp_packet);
+		bfree(tmp_header);
+		bfree(tmp_sei);
+	} else if (_codec->id == AV_CODEC_ID_HEVC) {
+		hevc::extract_header_sei(packet->data, static_cast<size_t>(packet->size), _extra_data, _sei_data);
+	} else if (_context->extradata != nullptr) {
+		_extra_data.resize(static_cast<size_t>(_context->extradata_size));
+		std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
+	}
+
+	if (_headers_pending && (extra_data != _extra_data)) {
+		// Muxers and outputs started from here on pick up the new headers, the stream itself carries them in band.
+		DLOG_INFO("[%s] Standby context uses different headers, republished %zu bytes of extra data.", _codec->name, _extra_data.size());
+	}
+	_have_first_frame = true;
+	_headers_pending  = false;
+}
+
 int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
 {
+	if (_parallel) {
+		if (!_parallel->submit(frame)) {
+			// Dropped, the frame can go straight back into the pool.
+			push_free_frame(frame);
+		}
+		return 0;
+	}
+
 	int res = 0;
 	{
 		auto gctx = streamfx::obs::gs::context();
@@ -697,18 +1064,54 @@ int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
 
 bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
 {
+	apply_roi(frame.get());
+
+	if (!_parallel) { // Only switch at the start of a GOP, so that the new context starts with a key frame where one was expected anyway.
+		int64_t gop_size = (_context->gop_size > 0) ? static_cast<int64_t>(_context->gop_size) : 1;
+		int64_t distance = (_last_key_pts != AV_NOPTS_VALUE) ? ((frame->pts - _last_key_pts) / static_cast<int64_t>(_framerate_divisor)) : 0;
+		bool    boundary = (distance >= 0) && ((distance % gop_size) == 0);
+
+		if (_standby_task && _standby_task->is_completed()) {
+			if (!_standby) {
+				// Opening failed, stay on the current context.
+				_standby_task.reset();
+			} else if (boundary) {
+				switch_context();
+
+				// The new context starts its first GOP with this frame.
+				_last_key_pts = frame->pts;
+			}
+		}
+
+		if (_realtime && boundary && !_standby_task && !_realtime_pending && _realtime->evaluate()) {
+			DLOG_INFO("[%s] Realtime Control: Switching to level %zu, took %.3fms per frame with a budget of %.3fms.", _codec->name, _realtime->level(), _realtime->average() / 1000000., static_cast<double>(_realtime->budget().count()) / 1000000.);
+			_realtime_pending = true;
+			{
+				std::lock_guard<std::mutex> lg(_standby_lock);
+				_standby_requested = std::chrono::high_resolution_clock::now();
+			}
+		}
+
+		if (!_standby_task) {
+			prepare_standby();
+		}
+	}
+
 	bool sent_frame  = false;
 	bool recv_packet = false;
 	bool should_lag  = (_sent_frames >= _lag_in_frames);
 
-	auto loop_begin = std::chrono::high_resolution_clock::now();
-	auto loop_end   = loop_begin + std::chrono::milliseconds(50);
+	auto                     loop_begin = std::chrono::high_resolution_clock::now();
+	auto                     loop_end   = loop_begin + std::chrono::milliseconds(50);
+	std::chrono::nanoseconds work{0}; // Time spent in the codec, without the waits in between.
 
 	while ((!sent_frame || (should_lag && !recv_packet)) && !(std::chrono::high_resolution_clock::now() > loop_end)) {
 		bool eagain_is_stupid = false;
 
 		if (!sent_frame) {
-			int res = send_frame(frame);
+			auto begin = std::chrono::high_resolution_clock::now();
+			int  res   = send_frame(frame);
+			work += std::chrono::high_resolution_clock::now() - begin;
 			switch (res) {
 			case 0:
 				sent_frame = true;
@@ -734,7 +1137,9 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 		}
 
 		if (!recv_packet) {
-			int res = receive_packet(received_packet, packet);
+			auto begin = std::chrono::high_resolution_clock::now();
+			int  res   = receive_packet(received_packet, packet);
+			work += std::chrono::high_resolution_clock::now() - begin;
 			switch (res) {
 			case 0:
 				recv_packet = true;
@@ -766,9 +1171,267 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 	if (!sent_frame)
 		push_free_frame(frame);
 
+	if (_realtime) {
+		_realtime->track(work);
+	}
+
+	return true;
+}
+
+AVCodecContext* ffmpeg_instance::clone_context(bool copy_options)
+{
+	AVCodecContext* context = avcodec_alloc_context3(_codec);
+	if (!context) {
+		throw std::runtime_error("Failed to create encoder context.");
+	}
+
+	if (copy_options) {
+		av_opt_copy(context, _context);
+		if (context->priv_data && _context->priv_data) {
+			av_opt_copy(context->priv_data, _context->priv_data);
+		}
+	}
+
+	// Anything that was set up by initialize_sw or initialize_hw, and the framerate divisor.
+	context->width                  = _context->width;
+	context->height                 = _context->height;
+	context->pix_fmt                = _context->pix_fmt;
+	context->sw_pix_fmt             = _context->sw_pix_fmt;
+	context->color_range            = _context->color_range;
+	context->colorspace             = _context->colorspace;
+	context->color_primaries        = _context->color_primaries;
+	context->color_trc              = _context->color_trc;
+	context->chroma_sample_location = _context->chroma_sample_location;
+	context->sample_aspect_ratio    = _context->sample_aspect_ratio;
+	context->field_order            = _context->field_order;
+	context->time_base              = _context->time_base;
+	context->framerate              = _context->framerate;
+	context->ticks_per_frame        = _context->ticks_per_frame;
+	context->gop_size               = _context->gop_size;
+	context->keyint_min             = _context->keyint_min;
+	context->thread_type            = _context->thread_type;
+	context->thread_count           = _context->thread_count;
+	context->delay                  = _context->delay;
+	if (_context->hw_device_ctx) {
+		context->hw_device_ctx = av_buffer_ref(_context->hw_device_ctx);
+	}
+	if (_context->hw_frames_ctx) {
+		context->hw_frames_ctx = av_buffer_ref(_context->hw_frames_ctx);
+	}
+
+	return context;
+}
+
+void ffmpeg_instance::prepare_standby()
+{
+	std::lock_guard<std::mutex> lg(_standby_lock);
+
+	if (!_standby_settings && !_realtime_pending) {
+		return;
+	}
+
+	try {
+		// New settings start from scratch, a realtime level change keeps everything else as is.
+		AVCodecContext* context = clone_context(_standby_settings == nullptr);
+
+		// Handlers only know about the instance, so they are pointed at the standby context while configuring. The live context is never touched.
+		_configuring = context;
+		try {
+			if (_standby_settings) {
+				configure(_standby_settings);
+			} else if (_realtime) {
+				// The clone carries the custom options, which have to win over the level again.
+				_handler->apply_realtime_level(_factory, this, _realtime->level());
+				parse_ffmpeg_commandline(_custom_options);
+			}
+		} catch (...) {
+			_configuring = nullptr;
+			avcodec_free_context(&context);
+			throw;
+		}
+		_configuring = nullptr;
+		_standby     = context;
+
+		_standby_task = streamfx::threadpool()->push(std::bind(&ffmpeg_instance::task_open_standby, this, std::placeholders::_1), nullptr);
+	} catch (std::exception const& ex) {
+		DLOG_ERROR("[%s] Failed to prepare standby context: %s", _codec->name, ex.what());
+	}
+
+	if (_standby_settings) {
+		obs_data_release(_standby_settings);
+		_standby_settings = nullptr;
+	}
+	_realtime_pending = false;
+}
+
+void ffmpeg_instance::task_open_standby(::streamfx::util::threadpool::task_data_t data)
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	int res = 0;
+	if (_hwinst) {
+		auto gctx = streamfx::obs::gs::context();
+		res       = avcodec_open2(_standby, _codec, NULL);
+	} else {
+		streamfx::util::affinity::scope affinity(streamfx::util::affinity::role::Encoder);
+		res = avcodec_open2(_standby, _codec, NULL);
+	}
+
+	_standby_open_time = std::chrono::high_resolution_clock::now() - begin;
+	if (res < 0) {
+		DLOG_ERROR("[%s] Failed to open standby context: %s (%" PRId32 ").", _codec->name, ::streamfx::ffmpeg::tools::get_error_description(res), res);
+		avcodec_free_context(&_standby);
+	}
+}
+
+void ffmpeg_instance::switch_context()
+{
+	std::lock_guard<std::mutex> lg(_standby_lock);
+
+	// Hand the current context over to be drained in the background, along with the frames it still holds.
+	auto retired      = std::make_shared<retired_context>();
+	retired->context  = _context;
+	retired->graphics = !!_hwinst;
+	retired->dropped  = 0;
+	retired->duration = std::chrono::nanoseconds(0);
+	retired->done     = false;
+	std::swap(retired->frames, _used_frames);
+	std::size_t in_flight = retired->frames.size();
+
+	_context         = _standby;
+	_standby         = nullptr;
+	_headers_pending = true;
+	_standby_task.reset();
+	if (_realtime) {
+		// Measurements so far belong to the previous level.
+		_realtime->reset();
+	}
+
+	retired->task = streamfx::threadpool()->push(std::bind(&ffmpeg_instance::task_drain_context, this, std::placeholders::_1), retired);
+	_retired.push_back(retired);
+
+	_switch_count++;
+	DLOG_INFO("[%s] Switched to standby context %.3fms after request (opened in %.3fms), %zu frames left to drain.", _codec->name, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - _standby_requested).count()) / 1000000., static_cast<double>(_standby_open_time.count()) / 1000000., in_flight);
+}
+
+void ffmpeg_instance::task_drain_context(::streamfx::util::threadpool::task_data_t data)
+{
+	auto retired = std::static_pointer_cast<retired_context>(data);
+	auto begin   = std::chrono::high_resolution_clock::now();
+
+	std::size_t drained = 0;
+	avcodec_send_frame(retired->context, nullptr);
+	while (true) {
+		std::shared_ptr<AVPacket> packet{av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
+
+		int res = 0;
+		if (retired->graphics) {
+			auto gctx = streamfx::obs::gs::context();
+			res       = avcodec_receive_packet(retired->context, packet.get());
+		} else {
+			res = avcodec_receive_packet(retired->context, packet.get());
+		}
+
+		if (res == AVERROR(EAGAIN)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		} else if (res != 0) {
+			break;
+		}
+
+		std::lock_guard<std::mutex> lg(retired->lock);
+		retired->packets.push(packet);
+		drained++;
+	}
+
+	if (retired->graphics) {
+		auto gctx = streamfx::obs::gs::context();
+		avcodec_free_context(&retired->context);
+	} else {
+		avcodec_free_context(&retired->context);
+	}
+
+	std::lock_guard<std::mutex> lg(retired->lock);
+	retired->dropped  = (retired->frames.size() > drained) ? (retired->frames.size() - drained) : 0;
+	retired->duration = std::chrono::high_resolution_clock::now() - begin;
+	retired->frames   = {};
+	retired->done     = true;
+}
+
+bool ffmpeg_instance::pop_pending_packet(AVPacket* packet)
+{
+	while (!_retired.empty()) {
+		auto                         retired = _retired.front();
+		std::unique_lock<std::mutex> ul(retired->lock);
+
+		if (!retired->packets.empty()) {
+			av_packet_move_ref(packet, retired->packets.front().get());
+			retired->packets.pop();
+			return true;
+		} else if (!retired->done) {
+			// Still draining, anything newer has to wait.
+			return false;
+		}
+
+		DLOG_INFO("[%s] Retired context drained in %.3fms, dropping %zu frames.", _codec->name, static_cast<double>(retired->duration.count()) / 1000000., retired->dropped);
+		_switch_dropped += retired->dropped;
+		_retired.pop_front();
+	}
+
+	if (_pending_packets.empty()) {
+		return false;
+	}
+
+	av_packet_move_ref(packet, _pending_packets.front().get());
+	_pending_packets.pop();
 	return true;
 }
 
+void ffmpeg_instance::apply_roi(AVFrame* frame)
+{
+	// Frames are reused, so regions from the last time this frame was sent have to go first.
+	av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+	std::vector<::streamfx::util::roi::region> regions;
+	float                                      strength;
+	{
+		std::lock_guard<std::mutex> lg(_roi_lock);
+		if (_roi_strength <= 0.f) {
+			return;
+		}
+		if (_roi_manual && (_roi_manual_region.right > _roi_manual_region.left) && (_roi_manual_region.bottom > _roi_manual_region.top)) {
+			regions.push_back(_roi_manual_region);
+		}
+		if (_roi_tracking) {
+			auto published = _roi_registry->collect(obs_encoder_video(_self));
+			regions.insert(regions.end(), published.begin(), published.end());
+		}
+		strength = _roi_strength;
+	}
+	if (regions.empty()) {
+		return;
+	}
+
+	AVFrameSideData* side_data = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, sizeof(AVRegionOfInterest) * regions.size());
+	if (!side_data) {
+		DLOG_WARNING("[%s] Failed to attach %zu regions of interest to frame.", _codec->name, regions.size());
+		return;
+	}
+
+	// Negative offsets lower the quantizer, so -1 asks for the best quality the encoder can give.
+	AVRational qoffset = av_make_q(-static_cast<int>(std::lround(strength * 1000.f)), 1000);
+	auto       rois    = reinterpret_cast<AVRegionOfInterest*>(side_data->data);
+	for (std::size_t idx = 0; idx < regions.size(); idx++) {
+		auto& region        = regions[idx];
+		rois[idx].self_size = sizeof(AVRegionOfInterest);
+		rois[idx].left      = static_cast<int>(std::floor(region.left * _context->width));
+		rois[idx].top       = static_cast<int>(std::floor(region.top * _context->height));
+		rois[idx].right     = static_cast<int>(std::ceil(region.right * _context->width));
+		rois[idx].bottom    = static_cast<int>(std::ceil(region.bottom * _context->height));
+		rois[idx].qoffset   = qoffset;
+	}
+}
+
 bool ffmpeg_instance::is_hardware_encode()
 {
 	return _hwinst != nullptr;
@@ -781,7 +1444,7 @@ const AVCodec* ffmpeg_instance::get_avcodec()
 
 AVCodecContext* ffmpeg_instance::get_avcodeccontext()
 {
-	return _context;
+	return _configuring ? _configuring : _context;
 }
 
 void ffmpeg_instance::parse_ffmpeg_commandline(std::string_view text)
@@ -898,7 +1561,7 @@ void ffmpeg_instance::parse_ffmpeg_commandline(std::string_view text)
 			std::string key   = opt.substr(1, static_cast<size_t>((eq_at - cstr) - 1));
 			std::string value = opt.substr(static_cast<size_t>((eq_at - cstr) + 1));
 
-			int res = av_opt_set(_context, key.c_str(), value.c_str(), AV_OPT_SEARCH_CHILDREN);
+			int res = av_opt_set(get_avcodeccontext(), key.c_str(), value.c_str(), AV_OPT_SEARCH_CHILDREN);
 			if (res < 0) {
 				DLOG_WARNING("Option '%s' (key: '%s', value: '%s') encountered error: %s", opt.c_str(), key.c_str(), value.c_str(), ::streamfx::ffmpeg::tools::get_error_description(res));
 			}
@@ -963,6 +1626,13 @@ ffmpeg_factory::ffmpeg_factory(ffmpeg_manager* manager, const AVCodec* codec) :
 
 	// Register encoder and proxies.
 	finish_setup();
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+	if (_handler && (_avcodec->type == AVMEDIA_TYPE_VIDEO)) {
+		// Any video encoder can take textures if they are converted and read back on the GPU. This is a separate encoder, so that existing setups are left as they are.
+		_name_texture = _name + D_TRANSLATE(ST_I18N_FFMPEG_GPUCONVERSION);
+		register_texture_variant("_gpu");
+	}
+#endif
 	const std::string proxies[] = {
 		std::string("streamfx--") + _avcodec->name,
 		std::string("StreamFX-") + _avcodec->name,
@@ -984,6 +1654,11 @@ const char* ffmpeg_factory::get_name()
 	return _name.c_str();
 }
 
+const char* ffmpeg_factory::get_name_texture()
+{
+	return _name_texture.c_str();
+}
+
 void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 {
 	if (_handler) {
@@ -994,6 +1669,16 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 			obs_data_set_default_double(settings, ST_KEY_KEYFRAMES_INTERVAL_SECONDS, 2.0);
 			obs_data_set_default_int(settings, ST_KEY_KEYFRAMES_INTERVAL_FRAMES, 300);
 		}
+
+		if (_handler->has_roi(this)) {
+			obs_data_set_default_bool(settings, ST_KEY_ROI_TRACKING, false);
+			obs_data_set_default_bool(settings, ST_KEY_ROI_MANUAL, false);
+			obs_data_set_default_double(settings, ST_KEY_ROI_MANUAL_LEFT, 25.);
+			obs_data_set_default_double(settings, ST_KEY_ROI_MANUAL_TOP, 25.);
+			obs_data_set_default_double(settings, ST_KEY_ROI_MANUAL_RIGHT, 75.);
+			obs_data_set_default_double(settings, ST_KEY_ROI_MANUAL_BOTTOM, 75.);
+			obs_data_set_default_double(settings, ST_KEY_ROI_STRENGTH, 25.);
+		}
 	}
 
 	{ // Integrated Options
@@ -1001,6 +1686,7 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 		obs_data_set_default_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS, "");
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_THREADS, 0);
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_GPU, -1);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_PARALLEL, 1);
 	}
 }
 
@@ -1026,6 +1712,23 @@ static bool modified_keyframes(obs_properties_t* props, obs_property_t*, obs_dat
 	}
 }
 
+static bool modified_roi(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	try {
+		bool manual = obs_data_get_bool(settings, ST_KEY_ROI_MANUAL);
+		for (auto key : {ST_KEY_ROI_MANUAL_LEFT, ST_KEY_ROI_MANUAL_TOP, ST_KEY_ROI_MANUAL_RIGHT, ST_KEY_ROI_MANUAL_BOTTOM}) {
+			obs_property_set_visible(obs_properties_get(props, key), manual);
+		}
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+		return false;
+	} catch (...) {
+		DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+		return false;
+	}
+}
+
 obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 {
 	obs_properties_t* props = obs_properties_create();
@@ -1067,6 +1770,36 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 		}
 	}
 
+	if (_handler && _handler->has_roi(this)) {
+		// Region of Interest Options
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_I18N_ROI, D_TRANSLATE(ST_I18N_ROI), OBS_GROUP_NORMAL, grp);
+		}
+
+		{ // Published by tracking filters
+			obs_properties_add_bool(grp, ST_KEY_ROI_TRACKING, D_TRANSLATE(ST_I18N_ROI_TRACKING));
+		}
+		{ // Manual Rectangle
+			auto p = obs_properties_add_bool(grp, ST_KEY_ROI_MANUAL, D_TRANSLATE(ST_I18N_ROI_MANUAL));
+			obs_property_set_modified_callback(p, modified_roi);
+		}
+		for (auto kv : std::initializer_list<std::pair<const char*, const char*>>{
+				 {ST_KEY_ROI_MANUAL_LEFT, ST_I18N_ROI_MANUAL_LEFT},
+				 {ST_KEY_ROI_MANUAL_TOP, ST_I18N_ROI_MANUAL_TOP},
+				 {ST_KEY_ROI_MANUAL_RIGHT, ST_I18N_ROI_MANUAL_RIGHT},
+				 {ST_KEY_ROI_MANUAL_BOTTOM, ST_I18N_ROI_MANUAL_BOTTOM},
+			 }) {
+			auto p = obs_properties_add_float_slider(grp, kv.first, D_TRANSLATE(kv.second), 0., 100., 0.1);
+			obs_property_float_set_suffix(p, " %");
+		}
+		{ // Strength
+			auto p = obs_properties_add_float_slider(grp, ST_KEY_ROI_STRENGTH, D_TRANSLATE(ST_I18N_ROI_STRENGTH), 0., 100., 0.1);
+			obs_property_float_set_suffix(p, " %");
+		}
+	}
+
 	{
 		obs_properties_t* grp = props;
 		if (!streamfx::util::are_property_groups_broken()) {
@@ -1087,6 +1820,10 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_THREADS, D_TRANSLATE(ST_I18N_FFMPEG_THREADS), 0, static_cast<int64_t>(std::thread::hardware_concurrency()) * 2, 1);
 		}
 
+		if (_handler && _handler->has_frame_parallelism(this)) {
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_PARALLEL, D_TRANSLATE(ST_I18N_FFMPEG_PARALLEL), 1, std::max<int64_t>(1, static_cast<int64_t>(std::thread::hardware_concurrency())), 1);
+		}
+
 		{ // Frame Skipping
 			obs_video_info ovi;
 			if (!obs_get_video_info(&ovi)) {
@@ -6,13 +6,24 @@
 #pragma once
 #include "common.hpp"
 #include "encoders/ffmpeg/handler.hpp"
+#include "encoders/ffmpeg/parallel-encoder.hpp"
 #include "ffmpeg/avframe-queue.hpp"
 #include "ffmpeg/hwapi/base.hpp"
 #include "ffmpeg/swscale.hpp"
 #include "obs/obs-encoder-factory.hpp"
+#include "util/util-roi.hpp"
+#include "util/util-threadpool.hpp"
+
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+#include "ffmpeg/gpu-converter.hpp"
+#endif
+#ifdef ENABLE_PROFILING
+#include "util/util-profiler.hpp"
+#endif
 
 #include "warning-disable.hpp"
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -33,6 +44,21 @@ namespace streamfx::encoder::ffmpeg {
 	class ffmpeg_manager;
 
 	class ffmpeg_instance : public obs::encoder_instance {
+		// A context that was replaced and is now being drained in the background.
+		struct retired_context {
+			AVCodecContext*                      context;
+			std::queue<std::shared_ptr<AVFrame>> frames;
+			bool                                 graphics;
+
+			std::mutex                            lock;
+			std::queue<std::shared_ptr<AVPacket>> packets;
+			std::size_t                           dropped;
+			std::chrono::nanoseconds              duration;
+			bool                                  done;
+
+			std::shared_ptr<::streamfx::util::threadpool::task> task;
+		};
+
 		ffmpeg_factory* _factory;
 		const AVCodec*  _codec;
 		AVCodecContext* _context;
@@ -45,12 +71,19 @@ namespace streamfx::encoder::ffmpeg {
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::base>     _hwapi;
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::instance> _hwinst;
 
+#if defined(D_PLATFORM_LINUX) && (LIBOBS_API_MAJOR_VER >= 30)
+		// Texture input without a hardware API, converted on the GPU.
+		std::unique_ptr<::streamfx::ffmpeg::gpu_converter> _converter;
+#endif
+
 		std::size_t _lag_in_frames;
 		std::size_t _sent_frames;
 		std::size_t _framerate_divisor;
+		int64_t     _last_key_pts; // Of the last key frame the live context produced.
 
 		// Extra Data
 		bool                 _have_first_frame;
+		bool                 _headers_pending; // Set after a context switch, until the new context produced its headers.
 		std::vector<uint8_t> _extra_data;
 		std::vector<uint8_t> _sei_data;
 
@@ -59,6 +92,42 @@ namespace streamfx::encoder::ffmpeg {
 		std::queue<std::shared_ptr<AVFrame>>           _used_frames;
 		std::chrono::high_resolution_clock::time_point _free_frames_last_used;
 
+		// Realtime Control
+		std::unique_ptr<realtime_controller> _realtime;
+		bool                                 _realtime_pending;
+		std::string                          _custom_options; // Last applied, realtime levels must not override them.
+
+		// Standby Context
+		std::mutex                                          _standby_lock;
+		obs_data_t*                                         _standby_settings;
+		AVCodecContext*                                     _standby;
+		AVCodecContext*                                     _configuring; // Handed to handlers instead of _context while preparing _standby.
+		std::shared_ptr<::streamfx::util::threadpool::task> _standby_task;
+		std::chrono::high_resolution_clock::time_point      _standby_requested;
+		std::chrono::nanoseconds                            _standby_open_time;
+
+		// Context Switching
+		std::deque<std::shared_ptr<retired_context>> _retired;
+		std::queue<std::shared_ptr<AVPacket>>        _pending_packets;
+		std::size_t                                  _switch_count;
+		std::size_t                                  _switch_dropped;
+
+		// Regions of Interest
+		std::mutex                                       _roi_lock;
+		std::shared_ptr<::streamfx::util::roi::registry> _roi_registry;
+		bool                                             _roi_tracking;
+		bool                                             _roi_manual;
+		::streamfx::util::roi::region                    _roi_manual_region;
+		float                                            _roi_strength;
+
+		// Frame Parallelism, replaces the context for intra-only codecs.
+		std::unique_ptr<parallel_encoder> _parallel;
+
+#ifdef ENABLE_PROFILING
+		// CPU time spent per submitted frame.
+		std::shared_ptr<::streamfx::util::profiler> _profile_encode;
+#endif
+
 		public:
 		ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw);
 		virtual ~ffmpeg_instance();
@@ -76,6 +145,10 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool encode_video(uint32_t handle, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) override;
 
+#if LIBOBS_API_MAJOR_VER >= 30
+		bool encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) override;
+#endif
+
 		bool get_extra_data(uint8_t** extra_data, size_t* size) override;
 
 		bool get_sei_data(uint8_t** sei_data, size_t* size) override;
@@ -83,7 +156,8 @@ namespace streamfx::encoder::ffmpeg {
 		void get_video_info(struct video_scale_info* info) override;
 
 		public:
-		void initialize_sw(obs_data_t* settings);
+		AVPixelFormat initialize_format(obs_data_t* settings);
+		void          initialize_sw(obs_data_t* settings);
 		void initialize_hw(obs_data_t* settings);
 
 		void                     push_free_frame(std::shared_ptr<AVFrame> frame);
@@ -98,6 +172,22 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool encode_avframe(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
 
+		private:
+		void configure(obs_data_t* settings);
+
+		AVCodecContext* clone_context(bool copy_options);
+
+		void prepare_standby();
+		void switch_context();
+		void task_open_standby(::streamfx::util::threadpool::task_data_t data);
+		void task_drain_context(::streamfx::util::threadpool::task_data_t data);
+
+		bool pop_pending_packet(AVPacket* packet);
+
+		void update_headers(AVPacket* packet);
+
+		void apply_roi(AVFrame* frame);
+
 		public: // Handler API
 		bool is_hardware_encode();
 
@@ -112,6 +202,7 @@ namespace streamfx::encoder::ffmpeg {
 		std::string _id;
 		std::string _codec;
 		std::string _name;
+		std::string _name_texture;
 
 		const AVCodec* _avcodec;
 
@@ -123,6 +214,8 @@ namespace streamfx::encoder::ffmpeg {
 
 		const char* get_name() override;
 
+		const char* get_name_texture() override;
+
 		void get_defaults2(obs_data_t* data) override;
 
 		void migrate(obs_data_t* data, uint64_t version) override;
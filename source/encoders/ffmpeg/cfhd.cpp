@@ -7,6 +7,7 @@
 #include "cfhd.hpp"
 #include "common.hpp"
 #include "encoders/encoder-ffmpeg.hpp"
+#include "ffmpeg/catalog.hpp"
 #include "ffmpeg/tools.hpp"
 #include "handler.hpp"
 #include "plugin.hpp"
@@ -38,18 +39,14 @@ bool cfhd::has_keyframes(ffmpeg_factory* factory)
 	return false;
 }
 
+bool cfhd::has_frame_parallelism(ffmpeg_factory* factory)
+{
+	return true;
+}
+
 void cfhd::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
 {
-	// Try and acquire a valid context.
-	std::shared_ptr<AVCodecContext> ctx;
-	if (instance) {
-		ctx = std::shared_ptr<AVCodecContext>(instance->get_avcodeccontext(), [](AVCodecContext*) {});
-	} else { // If we don't have a context, create a temporary one that is automatically freed.
-		ctx = std::shared_ptr<AVCodecContext>(avcodec_alloc_context3(factory->get_avcodec()), [](AVCodecContext* v) { avcodec_free_context(&v); });
-		if (!ctx->priv_data) {
-			return;
-		}
-	}
+	auto options = streamfx::ffmpeg::catalog::instance()->get(factory->get_avcodec());
 
 	{ // Quality parameter
 		auto to_string = [](const char* v) {
@@ -59,7 +56,7 @@ void cfhd::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_pr
 		};
 
 		auto p = obs_properties_add_list(props, strings::quality::obs, D_TRANSLATE(strings::quality::i18n), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
-		streamfx::ffmpeg::tools::avoption_list_add_entries(ctx->priv_data, strings::quality::ffmpeg, [&p, &to_string](const AVOption* opt) {
+		options->list(strings::quality::ffmpeg, [&p, &to_string](const AVOption* opt) {
 			// FFmpeg returns this list in the wrong order. We want to start at the lowest, and go to the highest.
 			// So simply always insert at the top, and this will reverse the list.
 			obs_property_list_insert_string(p, 0, to_string(opt->name), opt->name);
@@ -13,6 +13,8 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool has_keyframes(ffmpeg_factory* factory) override;
 
+		bool has_frame_parallelism(ffmpeg_factory* factory) override;
+
 		std::string help(ffmpeg_factory* factory) override;
 
 		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
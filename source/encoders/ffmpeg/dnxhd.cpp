@@ -8,6 +8,7 @@
 #include "dnxhd.hpp"
 #include "common.hpp"
 #include "../codecs/dnxhr.hpp"
+#include "ffmpeg/catalog.hpp"
 #include "ffmpeg/tools.hpp"
 #include "plugin.hpp"
 
@@ -41,6 +42,11 @@ bool dnxhd::has_keyframes(ffmpeg_factory* instance)
 	return false;
 }
 
+bool dnxhd::has_frame_parallelism(ffmpeg_factory* instance)
+{
+	return true;
+}
+
 void dnxhd::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 {
 	obs_data_set_default_string(settings, S_CODEC_DNXHR_PROFILE, "dnxhr_sq");
@@ -48,20 +54,11 @@ void dnxhd::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 
 void dnxhd::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
 {
-	// Try and acquire a valid context.
-	std::shared_ptr<AVCodecContext> ctx;
-	if (instance) {
-		ctx = std::shared_ptr<AVCodecContext>(instance->get_avcodeccontext(), [](AVCodecContext*) {});
-	} else { // If we don't have a context, create a temporary one that is automatically freed.
-		ctx = std::shared_ptr<AVCodecContext>(avcodec_alloc_context3(factory->get_avcodec()), [](AVCodecContext* v) { avcodec_free_context(&v); });
-		if (!ctx->priv_data) {
-			return;
-		}
-	}
+	auto options = streamfx::ffmpeg::catalog::instance()->get(factory->get_avcodec());
 
 	auto p = obs_properties_add_list(props, S_CODEC_DNXHR_PROFILE, D_TRANSLATE(S_CODEC_DNXHR_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 
-	streamfx::ffmpeg::tools::avoption_list_add_entries(ctx->priv_data, "profile", [&p](const AVOption* opt) {
+	options->list("profile", [&p](const AVOption* opt) {
 		if (strcmp(opt->name, "dnxhd") == 0) {
 			//Do not show DNxHD profile as it is outdated and should not be used.
 			//It's also very picky about framerate and framesize combos, which makes it even less useful
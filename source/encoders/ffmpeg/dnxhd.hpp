@@ -22,6 +22,8 @@ namespace streamfx::encoder::ffmpeg {
 
 		virtual bool has_keyframes(ffmpeg_factory* factory);
 
+		virtual bool has_frame_parallelism(ffmpeg_factory* factory);
+
 		virtual void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec);
 
 		virtual std::string help(ffmpeg_factory* factory) {
@@ -59,6 +59,16 @@ bool streamfx::encoder::ffmpeg::handler::is_reconfigurable(ffmpeg_factory* facto
 	return false;
 }
 
+bool streamfx::encoder::ffmpeg::handler::has_roi(ffmpeg_factory* factory)
+{
+	return false;
+}
+
+bool streamfx::encoder::ffmpeg::handler::has_frame_parallelism(ffmpeg_factory* factory)
+{
+	return false;
+}
+
 void streamfx::encoder::ffmpeg::handler::adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec) {}
 
 std::string streamfx::encoder::ffmpeg::handler::help(ffmpeg_factory* factory)
@@ -79,3 +89,10 @@ void streamfx::encoder::ffmpeg::handler::override_update(ffmpeg_factory* factory
 void streamfx::encoder::ffmpeg::handler::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) {}
 
 void streamfx::encoder::ffmpeg::handler::override_colorformat(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, AVPixelFormat& target_format) {}
+
+bool streamfx::encoder::ffmpeg::handler::has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt)
+{
+	return false;
+}
+
+void streamfx::encoder::ffmpeg::handler::apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level) {}
@@ -3,6 +3,8 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "realtime-controller.hpp"
+
 #include "warning-disable.hpp"
 #include <cstdint>
 #include <map>
@@ -25,6 +27,12 @@ namespace streamfx::encoder::ffmpeg {
 		virtual bool is_hardware(ffmpeg_factory* factory);
 		virtual bool is_reconfigurable(ffmpeg_factory* factory, bool& threads, bool& gpu, bool& keyframes);
 
+		// Whether the encoder reads AV_FRAME_DATA_REGIONS_OF_INTEREST, others silently ignore it.
+		virtual bool has_roi(ffmpeg_factory* factory);
+
+		// Whether frames can be spread over several contexts, which requires every frame to be coded on its own.
+		virtual bool has_frame_parallelism(ffmpeg_factory* factory);
+
 		virtual void adjust_info(ffmpeg_factory* factory, std::string& id, std::string& name, std::string& codec);
 
 		virtual std::string help(ffmpeg_factory* factory);
@@ -38,6 +46,10 @@ namespace streamfx::encoder::ffmpeg {
 
 		virtual void override_colorformat(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, AVPixelFormat& target_format);
 
+		// Realtime Control
+		virtual bool has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt);
+		virtual void apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level);
+
 		public:
 		typedef std::map<std::string, handler*> handler_map_t;
 
@@ -10,6 +10,7 @@
 #include "encoders/codecs/h264.hpp"
 #include "encoders/codecs/hevc.hpp"
 #include "encoders/encoder-ffmpeg.hpp"
+#include "ffmpeg/catalog.hpp"
 #include "ffmpeg/tools.hpp"
 #include "plugin.hpp"
 
@@ -216,22 +217,22 @@ static bool modified_aq(obs_properties_t* props, obs_property_t*, obs_data_t* se
 	return true;
 }
 
-void nvenc::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context)
+void nvenc::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const ::streamfx::ffmpeg::catalog::entry& options)
 {
 	auto codec = factory->get_avcodec();
 
 	{
 		auto p = obs_properties_add_list(props, ST_KEY_PRESET, D_TRANSLATE(ST_I18N_PRESET), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
-		streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "preset", [&p](const AVOption* opt) {
+		options.list("preset", [&p](const AVOption* opt) {
 			char buffer[1024];
 			snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_PRESET, opt->name);
 			obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
 		});
 	}
 
-	if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "tune")) {
+	if (options.has_option("tune")) {
 		auto p = obs_properties_add_list(props, ST_KEY_TUNE, D_TRANSLATE(ST_I18N_TUNE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
-		streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "tune", [&p](const AVOption* opt) {
+		options.list("tune", [&p](const AVOption* opt) {
 			char buffer[1024];
 			snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_TUNE, opt->name);
 			obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -239,7 +240,7 @@ void nvenc::properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance
 	}
 }
 
-void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context)
+void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const ::streamfx::ffmpeg::catalog::entry& options)
 {
 	auto codec   = factory->get_avcodec();
 
@@ -254,7 +255,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 			auto p = obs_properties_add_list(grp, ST_KEY_RATECONTROL_MODE, D_TRANSLATE(ST_I18N_RATECONTROL_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_set_modified_callback(p, modified_ratecontrol);
 			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "rc", [&p](const AVOption* opt) {
+			options.list("rc", [&p](const AVOption* opt) {
 				// Ignore options that are "deprecated" but not flagged as such.
 				if (opt->default_val.i64 & (1 << 23))
 					return;
@@ -265,10 +266,10 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 			});
 		}
 
-		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "multipass")) {
+		if (options.has_option("multipass")) {
 			auto p = obs_properties_add_list(grp, ST_KEY_RATECONTROL_MULTIPASS, D_TRANSLATE(ST_I18N_RATECONTROL_MULTIPASS), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "multipass", [&p](const AVOption* opt) {
+			options.list("multipass", [&p](const AVOption* opt) {
 				char buffer[1024];
 				snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_RATECONTROL_MULTIPASS, opt->name);
 				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -378,7 +379,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_OTHER_BFRAMEREFERENCEMODE, D_TRANSLATE(ST_I18N_OTHER_BFRAMEREFERENCEMODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "b_ref_mode", [&p](const AVOption* opt) {
+			options.list("b_ref_mode", [&p](const AVOption* opt) {
 				char buffer[1024];
 				snprintf(buffer, sizeof(buffer), "%s.%s", ST_I18N_OTHER_BFRAMEREFERENCEMODE, opt->name);
 				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -402,7 +403,7 @@ void nvenc::properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance,
 			obs_property_int_set_suffix(p, " frames");
 		}
 
-		if (streamfx::ffmpeg::tools::avoption_exists(context->priv_data, "ldkfs")) {
+		if (options.has_option("ldkfs")) {
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_OTHER_LOWDELAYKEYFRAMESCALE, D_TRANSLATE(ST_I18N_OTHER_LOWDELAYKEYFRAMESCALE), -1, 255, 1);
 		}
 	}
@@ -951,13 +952,9 @@ void nvenc_h264::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 {
 	auto codec   = factory->get_avcodec();
 
-	AVCodecContext* context = avcodec_alloc_context3(codec);
-	if (!context->priv_data) {
-		avcodec_free_context(&context);
-		return;
-	}
+	auto options = ::streamfx::ffmpeg::catalog::instance()->get(codec);
 
-	nvenc::properties_before(factory, instance, props, context);
+	nvenc::properties_before(factory, instance, props, *options);
 
 	{
 		obs_properties_t* grp = props;
@@ -969,7 +966,7 @@ void nvenc_h264::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_H264_PROFILE, D_TRANSLATE(S_CODEC_H264_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_string(p, D_TRANSLATE(S_STATE_DEFAULT), "");
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "profile", [&p](const AVOption* opt) {
+			options->list("profile", [&p](const AVOption* opt) {
 				char buffer[1024];
 				snprintf(buffer, sizeof(buffer), "%s.%s", S_CODEC_H264_PROFILE, opt->name);
 				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -978,7 +975,7 @@ void nvenc_h264::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_H264_LEVEL, D_TRANSLATE(S_CODEC_H264_LEVEL), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "level", [&p](const AVOption* opt) {
+			options->list("level", [&p](const AVOption* opt) {
 				if (opt->default_val.i64 == 0) {
 					obs_property_list_add_string(p, D_TRANSLATE(S_STATE_AUTOMATIC), "auto");
 				} else {
@@ -988,11 +985,7 @@ void nvenc_h264::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		}
 	}
 
-	nvenc::properies_after(factory, instance, props, context);
-
-	if (context) {
-		avcodec_free_context(&context);
-	}
+	nvenc::properies_after(factory, instance, props, *options);
 }
 
 void nvenc_h264::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
@@ -1138,13 +1131,9 @@ void nvenc_hevc::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 {
 	auto codec   = factory->get_avcodec();
 
-	AVCodecContext* context = avcodec_alloc_context3(codec);
-	if (!context->priv_data) {
-		avcodec_free_context(&context);
-		return;
-	}
+	auto options = ::streamfx::ffmpeg::catalog::instance()->get(codec);
 
-	nvenc::properties_before(factory, instance, props, context);
+	nvenc::properties_before(factory, instance, props, *options);
 
 	{
 		obs_properties_t* grp = props;
@@ -1156,7 +1145,7 @@ void nvenc_hevc::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_H265_PROFILE, D_TRANSLATE(S_CODEC_HEVC_PROFILE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DEFAULT), -1);
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "profile", [&p](const AVOption* opt) {
+			options->list("profile", [&p](const AVOption* opt) {
 				char buffer[1024];
 				snprintf(buffer, sizeof(buffer), "%s.%s", S_CODEC_HEVC_PROFILE, opt->name);
 				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -1165,7 +1154,7 @@ void nvenc_hevc::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_H265_TIER, D_TRANSLATE(S_CODEC_HEVC_TIER), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_int(p, D_TRANSLATE(S_STATE_DEFAULT), -1);
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "tier", [&p](const AVOption* opt) {
+			options->list("tier", [&p](const AVOption* opt) {
 				char buffer[1024];
 				snprintf(buffer, sizeof(buffer), "%s.%s", S_CODEC_HEVC_TIER, opt->name);
 				obs_property_list_add_string(p, D_TRANSLATE(buffer), opt->name);
@@ -1174,7 +1163,7 @@ void nvenc_hevc::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		{
 			auto p = obs_properties_add_list(grp, ST_KEY_H264_LEVEL, D_TRANSLATE(S_CODEC_HEVC_LEVEL), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 
-			streamfx::ffmpeg::tools::avoption_list_add_entries(context->priv_data, "level", [&p](const AVOption* opt) {
+			options->list("level", [&p](const AVOption* opt) {
 				if (opt->default_val.i64 == 0) {
 					obs_property_list_add_string(p, D_TRANSLATE(S_STATE_AUTOMATIC), "auto");
 				} else {
@@ -1184,11 +1173,7 @@ void nvenc_hevc::properties_encoder(ffmpeg_factory* factory, ffmpeg_instance* in
 		}
 	}
 
-	nvenc::properies_after(factory, instance, props, context);
-
-	if (context) {
-		avcodec_free_context(&context);
-	}
+	nvenc::properies_after(factory, instance, props, *options);
 }
 
 void nvenc_hevc::properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
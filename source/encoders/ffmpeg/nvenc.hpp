@@ -6,6 +6,7 @@
 #pragma once
 #include "encoders/encoder-ffmpeg.hpp"
 #include "encoders/ffmpeg/handler.hpp"
+#include "ffmpeg/catalog.hpp"
 
 #include "warning-disable.hpp"
 #include <cinttypes>
@@ -27,8 +28,8 @@ namespace streamfx::encoder::ffmpeg {
 		bool is_available();
 
 		void defaults(ffmpeg_factory* factory, obs_data_t* settings);
-		void properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context);
-		void properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, AVCodecContext* context);
+		void properties_before(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const ::streamfx::ffmpeg::catalog::entry& options);
+		void properies_after(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const ::streamfx::ffmpeg::catalog::entry& options);
 		void properties_runtime(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props);
 		void migrate(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings, uint64_t version);
 		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
@@ -0,0 +1,268 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "parallel-encoder.hpp"
+#include "util/util-affinity.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+using namespace streamfx::encoder::ffmpeg;
+
+// Frames in flight per context before receiving waits for the oldest one.
+static constexpr std::size_t frames_per_context = 2;
+
+// Frames in flight per context before new ones are dropped. Each one holds a whole uncompressed frame.
+static constexpr std::size_t max_frames_per_context = 4;
+
+// Longest wait for the oldest frame, after which it is tried again with the next frame.
+static constexpr std::chrono::milliseconds receive_timeout = std::chrono::milliseconds(50);
+
+parallel_encoder::~parallel_encoder()
+{
+	finish();
+
+	for (auto& worker : _workers) {
+		avcodec_free_context(&worker->context);
+	}
+}
+
+parallel_encoder::parallel_encoder(const std::vector<AVCodecContext*>& contexts)
+	: _lock(), _wake(), _ready(), _exit(false),
+
+	  _workers(), _next(0),
+
+	  _order(), _packets(), _finished(),
+
+	  _received(0), _failed(0), _dropped(0), _first(), _last()
+{
+	if (contexts.empty()) {
+		throw std::invalid_argument("At least one context is required.");
+	}
+
+	for (auto context : contexts) {
+		auto worker     = std::make_unique<parallel_encoder::worker>();
+		worker->context = context;
+		worker->busy    = std::chrono::nanoseconds(0);
+		_workers.push_back(std::move(worker));
+	}
+
+	// Threads only start once every context is owned, so that a failure can't leave any behind.
+	for (auto& worker : _workers) {
+		worker->thread = std::thread(&parallel_encoder::work, this, worker.get());
+	}
+}
+
+bool parallel_encoder::submit(std::shared_ptr<AVFrame> frame)
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		if (_order.size() >= (_workers.size() * max_frames_per_context)) {
+			// The contexts can't keep up, queueing more would only grow memory use without bound.
+			_dropped++;
+			return false;
+		}
+		if (_order.empty() && (_received == 0)) {
+			_first = std::chrono::high_resolution_clock::now();
+		}
+
+		_order.push_back(frame->pts);
+		_workers[_next]->frames.push(frame);
+		_next = (_next + 1) % _workers.size();
+	}
+	_wake.notify_all();
+	return true;
+}
+
+bool parallel_encoder::receive(AVPacket* packet)
+{
+	std::unique_lock<std::mutex> ul(_lock);
+
+	while (!_order.empty()) {
+		int64_t pts   = _order.front();
+		auto    ready = [this, pts]() { return _packets.find(pts) != _packets.end(); };
+
+		if (!ready()) {
+			// Only wait once enough frames are queued up to keep every context busy.
+			if (_order.size() <= (_workers.size() * frames_per_context)) {
+				return false;
+			}
+			if (!_ready.wait_for(ul, receive_timeout, ready)) {
+				return false;
+			}
+		}
+
+		auto kv     = _packets.find(pts);
+		auto result = kv->second;
+		_packets.erase(kv);
+		_order.pop_front();
+
+		if (!result) {
+			// The frame failed to encode, there is nothing to return for it.
+			_failed++;
+			continue;
+		}
+
+		av_packet_move_ref(packet, result.get());
+		_received++;
+		_last = std::chrono::high_resolution_clock::now();
+		return true;
+	}
+
+	return false;
+}
+
+void parallel_encoder::reclaim(std::function<void(std::shared_ptr<AVFrame>)> fn)
+{
+	std::vector<std::shared_ptr<AVFrame>> frames;
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		std::swap(frames, _finished);
+	}
+
+	for (auto& frame : frames) {
+		fn(frame);
+	}
+}
+
+std::size_t parallel_encoder::finish()
+{
+	{
+		std::lock_guard<std::mutex> lg(_lock);
+		_exit = true;
+	}
+	_wake.notify_all();
+
+	// Workers only stop once their queues are empty, and collect everything their context still holds.
+	for (auto& worker : _workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+
+	std::lock_guard<std::mutex> lg(_lock);
+	std::size_t                 count = 0;
+	for (auto& kv : _packets) {
+		if (kv.second) {
+			count++;
+		}
+	}
+	return count;
+}
+
+std::size_t parallel_encoder::size()
+{
+	return _workers.size();
+}
+
+std::size_t parallel_encoder::received()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _received;
+}
+
+std::size_t parallel_encoder::failed()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _failed;
+}
+
+std::size_t parallel_encoder::dropped()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	return _dropped;
+}
+
+double parallel_encoder::throughput()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	auto                        elapsed = std::chrono::duration<double>(_last - _first).count();
+	if ((_received == 0) || (elapsed <= 0.)) {
+		return 0.;
+	}
+	return static_cast<double>(_received) / elapsed;
+}
+
+double parallel_encoder::utilization()
+{
+	std::lock_guard<std::mutex> lg(_lock);
+	auto                        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(_last - _first);
+	if (elapsed.count() <= 0) {
+		return 0.;
+	}
+
+	double busy = 0.;
+	for (auto& worker : _workers) {
+		busy += static_cast<double>(worker->busy.count());
+	}
+	return busy / (static_cast<double>(elapsed.count()) * static_cast<double>(_workers.size()));
+}
+
+void parallel_encoder::work(worker* self)
+{
+	streamfx::util::affinity::scope affinity(streamfx::util::affinity::role::Encoder);
+
+	// Frames the context may still reference, in the order they were sent.
+	std::queue<std::shared_ptr<AVFrame>> used;
+	std::shared_ptr<AVPacket>            packet{av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
+
+	auto drain = [this, self, &used, &packet]() {
+		std::size_t count = 0;
+		while (avcodec_receive_packet(self->context, packet.get()) == 0) {
+			std::shared_ptr<AVPacket> result{av_packet_alloc(), [](AVPacket* ptr) { av_packet_free(&ptr); }};
+			av_packet_move_ref(result.get(), packet.get());
+			count++;
+
+			std::lock_guard<std::mutex> lg(_lock);
+			_packets.emplace(result->pts, result);
+			if (!used.empty()) {
+				_finished.push_back(used.front());
+				used.pop();
+			}
+			_ready.notify_all();
+		}
+		return count;
+	};
+
+	std::unique_lock<std::mutex> ul(_lock);
+	while (true) {
+		_wake.wait(ul, [this, self]() { return _exit || !self->frames.empty(); });
+		if (self->frames.empty()) {
+			break;
+		}
+
+		auto frame = self->frames.front();
+		self->frames.pop();
+		ul.unlock();
+
+		auto begin = std::chrono::high_resolution_clock::now();
+		int  res   = 0;
+		while ((res = avcodec_send_frame(self->context, frame.get())) == AVERROR(EAGAIN)) {
+			// Full, so make room. If nothing comes out either, the context is broken.
+			if (drain() == 0) {
+				break;
+			}
+		}
+		if (res == 0) {
+			used.push(frame);
+			drain();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		ul.lock();
+		self->busy += end - begin;
+		if (res != 0) {
+			// Leave a marker, so that receiving doesn't wait for a packet that will never arrive.
+			_packets.emplace(frame->pts, nullptr);
+			_finished.push_back(frame);
+			_ready.notify_all();
+		}
+	}
+	ul.unlock();
+
+	// Collect whatever the context still holds on to.
+	avcodec_send_frame(self->context, nullptr);
+	drain();
+}
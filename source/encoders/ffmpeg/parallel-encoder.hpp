@@ -0,0 +1,110 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+#include "warning-enable.hpp"
+
+/* parallel_encoder spreads the frames of an intra-only codec over several
+ *  contexts, each with its own thread.
+ *
+ * Intra-only codecs code every frame on its own, so frames can be handed out
+ *  in turns and the resulting packets put back in order of presentation. This
+ *  scales far better at high resolutions than the codecs' own threading, which
+ *  usually only splits a frame into slices. Up to two frames per context may be
+ *  in flight before receiving starts to wait for the oldest one, and new frames
+ *  are dropped once four per context are in flight.
+ */
+
+namespace streamfx::encoder::ffmpeg {
+	class parallel_encoder {
+		struct worker {
+			AVCodecContext*                      context;
+			std::queue<std::shared_ptr<AVFrame>> frames;
+			std::chrono::nanoseconds             busy;
+			std::thread                          thread;
+		};
+
+		std::mutex              _lock;
+		std::condition_variable _wake;
+		std::condition_variable _ready;
+		bool                    _exit;
+
+		std::vector<std::unique_ptr<worker>> _workers;
+		std::size_t                          _next;
+
+		std::deque<int64_t>                          _order;
+		std::map<int64_t, std::shared_ptr<AVPacket>> _packets;
+		std::vector<std::shared_ptr<AVFrame>>        _finished;
+
+		std::size_t                                    _received;
+		std::size_t                                    _failed;
+		std::size_t                                    _dropped;
+		std::chrono::high_resolution_clock::time_point _first;
+		std::chrono::high_resolution_clock::time_point _last;
+
+		public:
+		~parallel_encoder();
+
+		/** Take over already opened contexts, and start a thread for each of them.
+		 */
+		parallel_encoder(const std::vector<AVCodecContext*>& contexts);
+
+		/** Queue a frame on the next context in turn.
+		 *
+		 * @return false if too many frames are in flight, in which case the frame is dropped.
+		 */
+		bool submit(std::shared_ptr<AVFrame> frame);
+
+		/** Retrieve the next packet in order of presentation.
+		 *
+		 * @return false if the packet isn't ready yet, or frames failed to encode.
+		 */
+		bool receive(AVPacket* packet);
+
+		/** Hand back frames which no context needs anymore.
+		 */
+		void reclaim(std::function<void(std::shared_ptr<AVFrame>)> fn);
+
+		/** Let every context encode what it was given, and stop the threads.
+		 *
+		 * @return Number of packets that were encoded but not received.
+		 */
+		std::size_t finish();
+
+		std::size_t size();
+
+		std::size_t received();
+
+		std::size_t failed();
+
+		std::size_t dropped();
+
+		/** Packets received per second, from the first submitted frame to the last received packet.
+		 */
+		double throughput();
+
+		/** Average part of the time the contexts spent encoding, 0..1.
+		 */
+		double utilization();
+
+		private:
+		void work(worker* self);
+	};
+} // namespace streamfx::encoder::ffmpeg
@@ -45,6 +45,11 @@ bool prores_aw::has_keyframes(ffmpeg_factory* instance)
 	return false;
 }
 
+bool prores_aw::has_frame_parallelism(ffmpeg_factory* instance)
+{
+	return true;
+}
+
 void prores_aw::defaults(ffmpeg_factory* factory, obs_data_t* settings)
 {
 	obs_data_set_default_int(settings, S_CODEC_PRORES_PROFILE, 0);
@@ -21,6 +21,8 @@ namespace streamfx::encoder::ffmpeg {
 
 		virtual bool has_keyframes(ffmpeg_factory* factory);
 
+		virtual bool has_frame_parallelism(ffmpeg_factory* factory);
+
 		virtual std::string help(ffmpeg_factory* factory) {
 			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-Apple-ProRes";
 		}
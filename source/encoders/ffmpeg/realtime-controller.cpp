@@ -0,0 +1,104 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "realtime-controller.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+using namespace streamfx::encoder::ffmpeg;
+
+// Expected slow down of an unmeasured level compared to the one below it.
+static constexpr double step_factor = 1.35;
+
+// Windows to wait after backing off before trying a slower level again.
+static constexpr std::size_t cooldown_windows = 3;
+
+realtime_controller::~realtime_controller() = default;
+
+realtime_controller::realtime_controller(const settings& settings, std::chrono::nanoseconds interval)
+	: _minimum(settings.minimum), _maximum(settings.maximum), _level(settings.initial), _interval(interval), _budget(),
+
+	  _window_total(0), _window_count(0), _window_average(0.),
+
+	  _costs(settings.levels, 0.), _cooldown(0)
+{
+	if ((settings.levels == 0) || (_maximum >= settings.levels) || (_minimum > _maximum)) {
+		throw std::invalid_argument("Invalid level range.");
+	}
+
+	_level  = std::clamp(_level, _minimum, _maximum);
+	_budget = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(interval.count()) * (1. - std::clamp(settings.margin, 0., 1.))));
+}
+
+void realtime_controller::track(std::chrono::nanoseconds duration)
+{
+	_window_total += duration;
+	_window_count++;
+}
+
+bool realtime_controller::evaluate()
+{
+	if (_window_count == 0) {
+		return false;
+	}
+
+	// Close the window.
+	double average  = static_cast<double>(_window_total.count()) / static_cast<double>(_window_count);
+	_window_average = average;
+	_window_total   = std::chrono::nanoseconds(0);
+	_window_count   = 0;
+
+	// Content changes affect all levels alike, so carry the change over to previous measurements.
+	if (_costs[_level] > 0.) {
+		double scale = average / _costs[_level];
+		for (auto& cost : _costs) {
+			cost *= scale;
+		}
+	}
+	_costs[_level] = average;
+
+	std::size_t level  = _level;
+	double      budget = static_cast<double>(_budget.count());
+	if (average > budget) {
+		// Too slow, back off. If we are not even realtime anymore, back off harder.
+		std::size_t steps = (average > static_cast<double>(_interval.count())) ? 2 : 1;
+		level             = (_level > (_minimum + steps)) ? (_level - steps) : _minimum;
+		_cooldown         = cooldown_windows;
+	} else if (_cooldown > 0) {
+		_cooldown--;
+	} else if (_level < _maximum) {
+		double expected = (_costs[_level + 1] > 0.) ? _costs[_level + 1] : (average * step_factor);
+		if (expected < budget) {
+			level = _level + 1;
+		}
+	}
+
+	bool changed = (level != _level);
+	_level       = level;
+	return changed;
+}
+
+void realtime_controller::reset()
+{
+	_window_total = std::chrono::nanoseconds(0);
+	_window_count = 0;
+}
+
+std::size_t realtime_controller::level()
+{
+	return _level;
+}
+
+std::chrono::nanoseconds realtime_controller::budget()
+{
+	return _budget;
+}
+
+double realtime_controller::average()
+{
+	return _window_average;
+}
@@ -0,0 +1,77 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "warning-enable.hpp"
+
+/* realtime_controller keeps a software encoder just below realtime.
+ *
+ * Handlers provide an ordered list of levels, from fastest (0) to best
+ *  quality, and the controller picks one based on how long each frame took
+ *  to encode. Decisions are made once per window (usually a GOP), so that the
+ *  encoder only ever changes at a key frame:
+ * - If the window took longer than the budget (frame interval minus a safety
+ *   margin), move to a faster level, skipping one if realtime was missed.
+ * - Otherwise, move to a slower level if it is expected to fit the budget. The
+ *   expectation is the last measurement on that level, scaled by how the
+ *   current level changed since, or a fixed step factor if never measured.
+ * After backing off, a few windows have to pass before trying again.
+ */
+
+namespace streamfx::encoder::ffmpeg {
+	class realtime_controller {
+		public:
+		struct settings {
+			std::size_t levels;  // Number of levels the handler offers.
+			std::size_t minimum; // Fastest level allowed.
+			std::size_t maximum; // Slowest level allowed.
+			std::size_t initial; // Level to start with.
+			double      margin;  // Part of the frame interval to keep free, 0..1.
+		};
+
+		private:
+		std::size_t              _minimum;
+		std::size_t              _maximum;
+		std::size_t              _level;
+		std::chrono::nanoseconds _interval;
+		std::chrono::nanoseconds _budget;
+
+		std::chrono::nanoseconds _window_total;
+		std::size_t              _window_count;
+		double                   _window_average;
+
+		std::vector<double> _costs;
+		std::size_t         _cooldown;
+
+		public:
+		~realtime_controller();
+		realtime_controller(const settings& settings, std::chrono::nanoseconds interval);
+
+		/** Record the time it took to encode a single frame.
+		 */
+		void track(std::chrono::nanoseconds duration);
+
+		/** Close the current window and decide on the level for the next one.
+		 *
+		 * @return true if the level changed.
+		 */
+		bool evaluate();
+
+		/** Discard the current window without making a decision.
+		 */
+		void reset();
+
+		std::size_t level();
+
+		std::chrono::nanoseconds budget();
+
+		/** Average time per frame of the last closed window, in nanoseconds.
+		 */
+		double average();
+	};
+} // namespace streamfx::encoder::ffmpeg
@@ -0,0 +1,296 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "software.hpp"
+#include "common.hpp"
+#include "encoders/encoder-ffmpeg.hpp"
+#include "ffmpeg/tools.hpp"
+#include "plugin.hpp"
+#include "util/utility.hpp"
+
+#include "warning-disable.hpp"
+#include <sstream>
+extern "C" {
+#include <libavutil/dict.h>
+#include <libavutil/opt.h>
+}
+#include "warning-enable.hpp"
+
+#define ST_I18N_PRESET "Encoder.FFmpeg.Software.Preset"
+#define ST_KEY_PRESET "Preset"
+#define ST_I18N_REALTIME "Encoder.FFmpeg.Software.Realtime"
+#define ST_KEY_REALTIME "Realtime"
+#define ST_I18N_REALTIME_MARGIN ST_I18N_REALTIME ".Margin"
+#define ST_KEY_REALTIME_MARGIN "Realtime.Margin"
+
+using namespace streamfx::encoder::ffmpeg;
+
+// Presets from superfast to slower all use 3 B-Frames with a normal pyramid.
+static const std::vector<software::level> levels_x264 = {
+	{"superfast", -1, -1}, {"veryfast", -1, -1}, {"faster", -1, -1}, {"fast", -1, -1}, {"medium", 20, 2}, {"medium", -1, -1}, {"slow", 30, 3}, {"slow", -1, -1}, {"slower", -1, -1},
+};
+
+// Presets from veryfast to slow all use 4 B-Frames.
+static const std::vector<software::level> levels_x265 = {
+	{"veryfast", -1, -1}, {"faster", -1, -1}, {"fast", -1, -1}, {"medium", 15, -1}, {"medium", -1, -1}, {"slow", 20, 3}, {"slow", -1, -1},
+};
+
+// Presets above 12 change the prediction structure, and presets below 4 are far from realtime.
+static const std::vector<software::level> levels_svtav1 = {
+	{"12", -1, -1}, {"11", -1, -1}, {"10", -1, -1}, {"9", -1, -1}, {"8", -1, -1}, {"7", -1, -1}, {"6", -1, -1}, {"5", -1, -1}, {"4", -1, -1},
+};
+
+std::string software::level_name(const level& level)
+{
+	std::stringstream sstr;
+	sstr << level.preset;
+	if (level.lookahead >= 0) {
+		sstr << ", " << level.lookahead << " frames look ahead";
+	}
+	if (level.references >= 0) {
+		sstr << ", " << level.references << " references";
+	}
+	return sstr.str();
+}
+
+std::size_t software::find_level(obs_data_t* settings, const std::vector<level>& levels)
+{
+	std::string_view name = obs_data_get_string(settings, ST_KEY_PRESET);
+	for (std::size_t idx = 0; idx < levels.size(); idx++) {
+		if (software::level_name(levels[idx]) == name) {
+			return idx;
+		}
+	}
+	return levels.size() - 1;
+}
+
+void software::defaults(ffmpeg_factory* factory, obs_data_t* settings, const std::vector<level>& levels, std::size_t initial)
+{
+	obs_data_set_default_string(settings, ST_KEY_PRESET, level_name(levels[initial]).c_str());
+	obs_data_set_default_bool(settings, ST_KEY_REALTIME, true);
+	obs_data_set_default_double(settings, ST_KEY_REALTIME_MARGIN, 20.);
+}
+
+void software::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const std::vector<level>& levels)
+{
+	if (instance) {
+		return;
+	}
+
+	{
+		auto p = obs_properties_add_list(props, ST_KEY_PRESET, D_TRANSLATE(ST_I18N_PRESET), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		for (const auto& level : levels) {
+			auto name = level_name(level);
+			obs_property_list_add_string(p, name.c_str(), name.c_str());
+		}
+	}
+
+	{
+		obs_properties_t* grp = props;
+		if (!streamfx::util::are_property_groups_broken()) {
+			grp = obs_properties_create();
+			obs_properties_add_group(props, ST_KEY_REALTIME, D_TRANSLATE(ST_I18N_REALTIME), OBS_GROUP_CHECKABLE, grp);
+		} else {
+			obs_properties_add_bool(grp, ST_KEY_REALTIME, D_TRANSLATE(ST_I18N_REALTIME));
+		}
+
+		auto p = obs_properties_add_float_slider(grp, ST_KEY_REALTIME_MARGIN, D_TRANSLATE(ST_I18N_REALTIME_MARGIN), 0., 50., .1);
+		obs_property_float_set_suffix(p, " %");
+	}
+}
+
+void software::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	auto codec   = factory->get_avcodec();
+	auto context = instance->get_avcodeccontext();
+
+	DLOG_INFO("[%s]   Software:", codec->name);
+	if (uint8_t* v = nullptr; av_opt_get(context->priv_data, "preset", AV_OPT_SEARCH_CHILDREN, &v) >= 0) {
+		DLOG_INFO("[%s]     Preset: %s", codec->name, reinterpret_cast<const char*>(v));
+		av_free(v);
+	}
+	DLOG_INFO("[%s]     Realtime Control: %s", codec->name, obs_data_get_bool(settings, ST_KEY_REALTIME) ? "Enabled" : "Disabled");
+	if (obs_data_get_bool(settings, ST_KEY_REALTIME)) {
+		DLOG_INFO("[%s]       Safety Margin: %.1f %%", codec->name, obs_data_get_double(settings, ST_KEY_REALTIME_MARGIN));
+	}
+}
+
+bool software::has_realtime_control(obs_data_t* settings, realtime_controller::settings& rt, const std::vector<level>& levels)
+{
+	if (!obs_data_get_bool(settings, ST_KEY_REALTIME)) {
+		return false;
+	}
+
+	// The selected preset is the best we may go to, and we start in the middle of the allowed range.
+	rt.levels  = levels.size();
+	rt.minimum = 0;
+	rt.maximum = software::find_level(settings, levels);
+	rt.initial = rt.maximum / 2;
+	rt.margin  = obs_data_get_double(settings, ST_KEY_REALTIME_MARGIN) / 100.;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// x264
+//------------------------------------------------------------------------------
+
+libx264::libx264() : handler("libx264") {}
+
+libx264::~libx264() {}
+
+bool libx264::has_roi(ffmpeg_factory* factory)
+{
+	return true;
+}
+
+void libx264::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	software::defaults(factory, settings, levels_x264, levels_x264.size() - 1);
+}
+
+void libx264::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	software::properties(factory, instance, props, levels_x264);
+}
+
+void libx264::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	// The selected preset is only the starting point if realtime control is enabled.
+	if (!instance->get_avcodeccontext()->internal) {
+		apply_realtime_level(factory, instance, software::find_level(settings, levels_x264));
+	}
+}
+
+void libx264::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	software::log(factory, instance, settings);
+	::streamfx::ffmpeg::tools::print_av_option_int(instance->get_avcodeccontext(), instance->get_avcodeccontext()->priv_data, "rc-lookahead", "    Look Ahead", "frames");
+	::streamfx::ffmpeg::tools::print_av_option_int(instance->get_avcodeccontext(), "refs", "    References", "frames");
+}
+
+bool libx264::has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt)
+{
+	return software::has_realtime_control(settings, rt, levels_x264);
+}
+
+void libx264::apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level)
+{
+	auto  context = instance->get_avcodeccontext();
+	auto& entry   = levels_x264.at(level);
+
+	av_opt_set(context->priv_data, "preset", entry.preset, AV_OPT_SEARCH_CHILDREN);
+	av_opt_set_int(context->priv_data, "rc-lookahead", entry.lookahead, AV_OPT_SEARCH_CHILDREN);
+	context->refs = entry.references;
+}
+
+//------------------------------------------------------------------------------
+// x265
+//------------------------------------------------------------------------------
+
+libx265::libx265() : handler("libx265") {}
+
+libx265::~libx265() {}
+
+bool libx265::has_roi(ffmpeg_factory* factory)
+{
+	return true;
+}
+
+void libx265::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	software::defaults(factory, settings, levels_x265, levels_x265.size() - 1);
+}
+
+void libx265::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	software::properties(factory, instance, props, levels_x265);
+}
+
+void libx265::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	// The selected preset is only the starting point if realtime control is enabled.
+	if (!instance->get_avcodeccontext()->internal) {
+		apply_realtime_level(factory, instance, software::find_level(settings, levels_x265));
+	}
+}
+
+void libx265::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	software::log(factory, instance, settings);
+}
+
+bool libx265::has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt)
+{
+	return software::has_realtime_control(settings, rt, levels_x265);
+}
+
+void libx265::apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level)
+{
+	auto  context = instance->get_avcodeccontext();
+	auto& entry   = levels_x265.at(level);
+
+	av_opt_set(context->priv_data, "preset", entry.preset, AV_OPT_SEARCH_CHILDREN);
+
+	// Look ahead and references are only available through x265-params, which may already hold user options.
+	AVDictionary* params = nullptr;
+	av_opt_get_dict_val(context->priv_data, "x265-params", AV_OPT_SEARCH_CHILDREN, &params);
+	if (entry.lookahead >= 0) {
+		av_dict_set_int(&params, "rc-lookahead", entry.lookahead, 0);
+	} else {
+		av_dict_set(&params, "rc-lookahead", nullptr, 0);
+	}
+	if (entry.references >= 0) {
+		av_dict_set_int(&params, "ref", entry.references, 0);
+	} else {
+		av_dict_set(&params, "ref", nullptr, 0);
+	}
+	av_opt_set_dict_val(context->priv_data, "x265-params", params, AV_OPT_SEARCH_CHILDREN);
+	av_dict_free(&params);
+}
+
+//------------------------------------------------------------------------------
+// SVT-AV1
+//------------------------------------------------------------------------------
+
+libsvtav1::libsvtav1() : handler("libsvtav1") {}
+
+libsvtav1::~libsvtav1() {}
+
+void libsvtav1::defaults(ffmpeg_factory* factory, obs_data_t* settings)
+{
+	software::defaults(factory, settings, levels_svtav1, levels_svtav1.size() - 1);
+}
+
+void libsvtav1::properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props)
+{
+	software::properties(factory, instance, props, levels_svtav1);
+}
+
+void libsvtav1::update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	// The selected preset is only the starting point if realtime control is enabled.
+	if (!instance->get_avcodeccontext()->internal) {
+		apply_realtime_level(factory, instance, software::find_level(settings, levels_svtav1));
+	}
+}
+
+void libsvtav1::log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings)
+{
+	software::log(factory, instance, settings);
+}
+
+bool libsvtav1::has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt)
+{
+	return software::has_realtime_control(settings, rt, levels_svtav1);
+}
+
+void libsvtav1::apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level)
+{
+	auto context = instance->get_avcodeccontext();
+	av_opt_set(context->priv_data, "preset", levels_svtav1.at(level).preset, AV_OPT_SEARCH_CHILDREN);
+}
+
+static auto inst_libx264   = libx264();
+static auto inst_libx265   = libx265();
+static auto inst_libsvtav1 = libsvtav1();
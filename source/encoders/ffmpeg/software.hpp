@@ -0,0 +1,104 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "encoders/encoder-ffmpeg.hpp"
+#include "encoders/ffmpeg/handler.hpp"
+
+#include "warning-disable.hpp"
+#include <string>
+#include <vector>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+#include "warning-enable.hpp"
+
+/* Software encoders (x264, x265, SVT-AV1) share a single set of options, and
+ *  only differ in the list of levels offered to the realtime controller.
+ *
+ * Each level is a preset, optionally with a reduced look ahead and number of
+ *  reference frames. Levels are picked so that the number of B-Frames, and
+ *  with it the reordering delay, stays the same across the entire list. This
+ *  keeps DTS monotonic when the encoder is swapped at a key frame.
+ */
+
+namespace streamfx::encoder::ffmpeg {
+	namespace software {
+		struct level {
+			const char* preset;
+			int32_t     lookahead;  // -1 to keep the preset default.
+			int32_t     references; // -1 to keep the preset default.
+		};
+
+		std::string level_name(const level& level);
+
+		std::size_t find_level(obs_data_t* settings, const std::vector<level>& levels);
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings, const std::vector<level>& levels, std::size_t initial);
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props, const std::vector<level>& levels);
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings);
+		bool has_realtime_control(obs_data_t* settings, realtime_controller::settings& rt, const std::vector<level>& levels);
+	} // namespace software
+
+	class libx264 : public handler {
+		public:
+		libx264();
+		virtual ~libx264();
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-Software";
+		};
+
+		bool has_roi(ffmpeg_factory* factory) override;
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+
+		bool has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt) override;
+		void apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level) override;
+	};
+
+	class libx265 : public handler {
+		public:
+		libx265();
+		virtual ~libx265();
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-Software";
+		};
+
+		bool has_roi(ffmpeg_factory* factory) override;
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+
+		bool has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt) override;
+		void apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level) override;
+	};
+
+	class libsvtav1 : public handler {
+		public:
+		libsvtav1();
+		virtual ~libsvtav1();
+
+		std::string help(ffmpeg_factory* factory) override
+		{
+			return "https://github.com/Xaymar/obs-StreamFX/wiki/Encoder-FFmpeg-Software";
+		};
+
+		void defaults(ffmpeg_factory* factory, obs_data_t* settings) override;
+		void properties(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_properties_t* props) override;
+		void update(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+		void log(ffmpeg_factory* factory, ffmpeg_instance* instance, obs_data_t* settings) override;
+
+		bool has_realtime_control(ffmpeg_factory* factory, obs_data_t* settings, realtime_controller::settings& rt) override;
+		void apply_realtime_level(ffmpeg_factory* factory, ffmpeg_instance* instance, std::size_t level) override;
+	};
+} // namespace streamfx::encoder::ffmpeg
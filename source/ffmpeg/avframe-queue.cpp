@@ -18,7 +18,7 @@ std::shared_ptr<AVFrame> avframe_queue::create_frame()
 	frame->height                  = this->_resolution.second;
 	frame->format                  = this->_format;
 
-	int res = av_frame_get_buffer(frame.get(), 32);
+	int res = tools::get_frame_buffer(frame.get(), 32);
 	if (res < 0) {
 		throw std::runtime_error(tools::get_error_description(res));
 	}
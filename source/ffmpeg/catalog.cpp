@@ -0,0 +1,99 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "catalog.hpp"
+#include "tools.hpp"
+#include "plugin.hpp"
+
+streamfx::ffmpeg::catalog::entry::~entry() {}
+
+streamfx::ffmpeg::catalog::entry::entry(const AVCodec* codec) : _options(), _units(), _hardware(false)
+{
+	// A pointer to the class pointer is what FFmpeg expects from a "fake" object.
+	if (codec->priv_class) {
+		const void* obj = &codec->priv_class;
+		for (const AVOption* opt = nullptr; (opt = av_opt_next(obj, opt)) != nullptr;) {
+			_options.emplace(opt->name, opt);
+
+			// Skip anything that can't be offered in a list.
+			if (!opt->unit || (opt->type != AV_OPT_TYPE_CONST) || (opt->name == std::string_view(opt->unit))) {
+				continue;
+			}
+			if (opt->flags & AV_OPT_FLAG_DEPRECATED) {
+				continue;
+			}
+			_units[opt->unit].push_back(opt);
+		}
+	}
+
+	_hardware = tools::can_hardware_encode(codec);
+}
+
+bool streamfx::ffmpeg::catalog::entry::has_option(std::string_view name) const
+{
+	return _options.find(name) != _options.end();
+}
+
+const AVOption* streamfx::ffmpeg::catalog::entry::get_option(std::string_view name) const
+{
+	if (auto kv = _options.find(name); kv != _options.end()) {
+		return kv->second;
+	}
+	return nullptr;
+}
+
+void streamfx::ffmpeg::catalog::entry::list(std::string_view unit, std::function<void(const AVOption*)> inserter) const
+{
+	if (auto kv = _units.find(unit); kv != _units.end()) {
+		for (auto opt : kv->second) {
+			inserter(opt);
+		}
+	}
+}
+
+bool streamfx::ffmpeg::catalog::entry::is_hardware() const
+{
+	return _hardware;
+}
+
+streamfx::ffmpeg::catalog::~catalog() {}
+
+streamfx::ffmpeg::catalog::catalog() : _lock(), _entries() {}
+
+std::shared_ptr<const streamfx::ffmpeg::catalog::entry> streamfx::ffmpeg::catalog::get(const AVCodec* codec)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	if (auto kv = _entries.find(codec); kv != _entries.end()) {
+		return kv->second;
+	}
+
+	auto entry = std::make_shared<const streamfx::ffmpeg::catalog::entry>(codec);
+	_entries.emplace(codec, entry);
+	return entry;
+}
+
+std::shared_ptr<streamfx::ffmpeg::catalog> streamfx::ffmpeg::catalog::instance()
+{
+	static std::weak_ptr<streamfx::ffmpeg::catalog> winst;
+	static std::mutex                               mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::ffmpeg::catalog>(new streamfx::ffmpeg::catalog());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::ffmpeg::catalog> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = streamfx::ffmpeg::catalog::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
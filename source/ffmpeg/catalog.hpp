@@ -0,0 +1,71 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+#include "warning-enable.hpp"
+}
+
+/* catalog holds what the encoder properties need to know about a codec: its
+ *  options, the named constants of each option unit, and whether it can take
+ *  hardware frames.
+ *
+ * An entry is gathered on first use straight from the codec's private class,
+ *  so no throwaway context has to be allocated, and is kept for the lifetime
+ *  of the plugin. The options point into FFmpeg's static tables, which stay
+ *  valid for as long as FFmpeg is loaded.
+ */
+
+namespace streamfx::ffmpeg {
+	class catalog {
+		public:
+		class entry {
+			std::map<std::string, const AVOption*, std::less<>>              _options;
+			std::map<std::string, std::vector<const AVOption*>, std::less<>> _units;
+			bool                                                             _hardware;
+
+			public:
+			~entry();
+			entry(const AVCodec* codec);
+
+			bool has_option(std::string_view name) const;
+
+			const AVOption* get_option(std::string_view name) const;
+
+			/** Call inserter for every constant of an option unit that isn't deprecated, in the order FFmpeg lists them.
+			 */
+			void list(std::string_view unit, std::function<void(const AVOption*)> inserter) const;
+
+			bool is_hardware() const;
+		};
+
+		private:
+		std::mutex                                             _lock;
+		std::map<const AVCodec*, std::shared_ptr<const entry>> _entries;
+
+		public:
+		~catalog();
+		catalog();
+
+		std::shared_ptr<const entry> get(const AVCodec* codec);
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::ffmpeg::catalog> instance();
+	};
+} // namespace streamfx::ffmpeg
@@ -0,0 +1,256 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "format-negotiator.hpp"
+#include "plugin.hpp"
+#include "tools.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <array>
+#include <chrono>
+#include <limits>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+#include "warning-enable.hpp"
+}
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<ffmpeg::format_negotiator> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace streamfx::ffmpeg;
+
+// Size of the frame used for measurements, small enough to fit a few hundred conversions into a second.
+static constexpr int      benchmark_width      = 640;
+static constexpr int      benchmark_height     = 360;
+static constexpr uint32_t benchmark_iterations = 5;
+
+// Formats libOBS can output, and which we may ask it for instead of the configured one.
+static constexpr AVPixelFormat obs_formats[] = {
+	AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_P010, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_RGBA, AV_PIX_FMT_BGRA,
+};
+
+// Formats encoders commonly want, used to warm up the cost table.
+static constexpr AVPixelFormat common_targets[] = {
+	AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_P010, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV444P10,
+};
+
+format_negotiator::~format_negotiator() = default;
+
+format_negotiator::format_negotiator() : _costs(), _costs_lock(), _flags(SWS_SINC | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND | SWS_BITEXACT) {}
+
+double format_negotiator::cost(AVPixelFormat from, AVPixelFormat to)
+{
+	auto key = std::make_pair(from, to);
+	{
+		std::unique_lock<decltype(_costs_lock)> lock(_costs_lock);
+		if (auto kv = _costs.find(key); kv != _costs.end()) {
+			return kv->second;
+		}
+	}
+
+	// Two threads may measure the same pair at once, in which case the first result is kept.
+	double value = measure(from, to);
+
+	std::unique_lock<decltype(_costs_lock)> lock(_costs_lock);
+	return _costs.emplace(key, value).first->second;
+}
+
+format_negotiator::result format_negotiator::negotiate(const AVPixelFormat* targets, AVPixelFormat source, bool allow_source_change)
+{
+	result best{source, source, 0., 0};
+	if (!targets) { // If there are no supported formats, just pass in the current one.
+		return best;
+	}
+
+	// Anything that loses more than the least lossy choice is unacceptable.
+	int  best_loss = 0;
+	auto fallback  = avcodec_find_best_pix_fmt_of_list(targets, source, 0, &best_loss);
+
+	auto sources = get_sources(source, allow_source_change);
+	best.target  = fallback;
+	best.cost    = std::numeric_limits<double>::infinity();
+	best.loss    = best_loss;
+	for (const AVPixelFormat* target = targets; *target != AV_PIX_FMT_NONE; target++) {
+		int loss = av_get_pix_fmt_loss(*target, source, 0);
+		if ((loss & ~best_loss) != 0) {
+			continue;
+		}
+
+		for (auto candidate : sources) {
+			// libOBS converts anything other than its own output format on the CPU with its video scaler.
+			double value = cost(candidate, *target);
+			if (candidate != source) {
+				value += cost(source, candidate);
+			}
+
+			// Strictly cheaper only, so that ties keep the codec's order of preference.
+			if (value < best.cost) {
+				best = {candidate, *target, value, loss};
+			}
+		}
+	}
+
+	if (best.cost == std::numeric_limits<double>::infinity()) {
+		// Nothing could be measured, fall back to what FFmpeg would pick.
+		best = {source, fallback, best.cost, best_loss};
+	}
+
+	D_LOG_DEBUG("Negotiated '%s' -> '%s' for source '%s' at %.3fns per pixel.", tools::get_pixel_format_name(best.source), tools::get_pixel_format_name(best.target), tools::get_pixel_format_name(source), best.cost);
+	return best;
+}
+
+format_negotiator::result format_negotiator::negotiate(AVPixelFormat target, AVPixelFormat source, bool allow_source_change)
+{
+	const AVPixelFormat targets[] = {target, AV_PIX_FMT_NONE};
+	return negotiate(targets, source, allow_source_change);
+}
+
+int format_negotiator::flags()
+{
+	return _flags;
+}
+
+void format_negotiator::warm_up()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (auto from : obs_formats) {
+		for (auto to : common_targets) {
+			cost(from, to);
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	std::unique_lock<decltype(_costs_lock)> lock(_costs_lock);
+	D_LOG_INFO("Measured %zu conversions in %.3fms.", _costs.size(), std::chrono::duration<double, std::milli>(end - start).count());
+	for (const auto& kv : _costs) {
+		D_LOG_DEBUG("  '%s' -> '%s': %.3fns per pixel", tools::get_pixel_format_name(kv.first.first), tools::get_pixel_format_name(kv.first.second), kv.second);
+	}
+}
+
+double format_negotiator::measure(AVPixelFormat from, AVPixelFormat to)
+{
+	std::array<uint8_t*, 4> source_data{};
+	std::array<int, 4>      source_stride{};
+	std::array<uint8_t*, 4> target_data{};
+	std::array<int, 4>      target_stride{};
+	SwsContext*             context = nullptr;
+	double                  value   = std::numeric_limits<double>::infinity();
+
+	int source_size = av_image_alloc(source_data.data(), source_stride.data(), benchmark_width, benchmark_height, from, 32);
+	if (source_size < 0) {
+		return value;
+	}
+	if (av_image_alloc(target_data.data(), target_stride.data(), benchmark_width, benchmark_height, to, 32) < 0) {
+		av_freep(&source_data[0]);
+		return value;
+	}
+
+	// Fill the source with something that isn't all zeroes, to keep things honest.
+	for (int idx = 0; idx < source_size; idx++) {
+		source_data[0][idx] = static_cast<uint8_t>((idx * 7) & 0xFF);
+	}
+
+	if (from != to) {
+		context = sws_getContext(benchmark_width, benchmark_height, from, benchmark_width, benchmark_height, to, _flags, nullptr, nullptr, nullptr);
+	}
+
+	if ((from == to) || context) {
+		auto best = std::chrono::nanoseconds::max();
+		for (uint32_t iteration = 0; iteration <= benchmark_iterations; iteration++) {
+			auto start = std::chrono::high_resolution_clock::now();
+			if (context) {
+				sws_scale(context, source_data.data(), source_stride.data(), 0, benchmark_height, target_data.data(), target_stride.data());
+			} else {
+				av_image_copy(target_data.data(), target_stride.data(), const_cast<const uint8_t**>(source_data.data()), source_stride.data(), from, benchmark_width, benchmark_height);
+			}
+			auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+
+			// The first iteration warms up caches and allocations, so it is ignored.
+			if ((iteration > 0) && (duration < best)) {
+				best = duration;
+			}
+		}
+		value = static_cast<double>(best.count()) / static_cast<double>(benchmark_width * benchmark_height);
+	}
+
+	if (context) {
+		sws_freeContext(context);
+	}
+	av_freep(&target_data[0]);
+	av_freep(&source_data[0]);
+	return value;
+}
+
+std::vector<AVPixelFormat> format_negotiator::get_sources(AVPixelFormat source, bool allow_source_change)
+{
+	std::vector<AVPixelFormat> sources;
+	sources.push_back(source);
+	if (!allow_source_change) {
+		return sources;
+	}
+
+	// Only formats that carry exactly the same information, anything else would change the output.
+	for (auto candidate : obs_formats) {
+		if (candidate == source) {
+			continue;
+		}
+		if (tools::avpixelformat_to_obs_videoformat(candidate) == VIDEO_FORMAT_NONE) {
+			continue;
+		}
+		if ((av_get_pix_fmt_loss(candidate, source, 0) == 0) && (av_get_pix_fmt_loss(source, candidate, 0) == 0)) {
+			sources.push_back(candidate);
+		}
+	}
+	return sources;
+}
+
+std::shared_ptr<format_negotiator> format_negotiator::instance()
+{
+	static std::weak_ptr<format_negotiator> winst;
+	static std::mutex                       mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<format_negotiator>(new format_negotiator());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<format_negotiator> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initalizer
+		loader_instance = format_negotiator::instance();
+
+		// Measure the common conversions without blocking the load.
+		streamfx::threadpool()->push([](std::shared_ptr<void>) {
+			if (auto instance = format_negotiator::instance(); instance) {
+				instance->warm_up();
+			}
+		});
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::NORMAL);
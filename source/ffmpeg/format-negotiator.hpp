@@ -0,0 +1,87 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+/* format_negotiator picks the pixel format pair (what libOBS hands us, what
+ *  the codec receives) that is cheapest to convert between, among all pairs
+ *  that are no more lossy than the least lossy choice. libOBS may be asked
+ *  for an equivalent format (like I420 instead of NV12), in which case its
+ *  own conversion on the CPU is included in the cost.
+ *
+ * The cost of each conversion is measured once with a small libswscale
+ *  benchmark (or a plain copy if no conversion is needed) and kept for the
+ *  lifetime of the plugin. The common pairs are measured in the background
+ *  right after loading, anything else is measured on first use. Measuring
+ *  happens outside of the lock, so lookups never wait for a benchmark.
+ */
+
+namespace streamfx::ffmpeg {
+	class format_negotiator {
+		std::map<std::pair<AVPixelFormat, AVPixelFormat>, double> _costs;
+		std::mutex                                                _costs_lock;
+		int                                                       _flags;
+
+		public:
+		struct result {
+			AVPixelFormat source;
+			AVPixelFormat target;
+			double        cost; // Nanoseconds per pixel.
+			int           loss; // FF_LOSS_* flags.
+		};
+
+		public:
+		~format_negotiator();
+		format_negotiator();
+
+		/** Cost of converting a frame from one format into another.
+		 *
+		 * @return Nanoseconds per pixel, or infinity if the conversion is not possible.
+		 */
+		double cost(AVPixelFormat from, AVPixelFormat to);
+
+		/** Find the cheapest acceptable conversion.
+		 *
+		 * @param targets Formats the codec accepts in order of preference, terminated by AV_PIX_FMT_NONE.
+		 * @param source Format libOBS is configured to output.
+		 * @param allow_source_change Whether libOBS may be asked for an equivalent source format.
+		 */
+		result negotiate(const AVPixelFormat* targets, AVPixelFormat source, bool allow_source_change = true);
+
+		/** Find the cheapest equivalent source format for a fixed target.
+		 */
+		result negotiate(AVPixelFormat target, AVPixelFormat source, bool allow_source_change = true);
+
+		/** libswscale flags used for conversions, and therefore for measurements.
+		 */
+		int flags();
+
+		/** Measure common conversions ahead of time.
+		 */
+		void warm_up();
+
+		private:
+		double measure(AVPixelFormat from, AVPixelFormat to);
+
+		std::vector<AVPixelFormat> get_sources(AVPixelFormat source, bool allow_source_change);
+
+		public: // Singleton
+		static std::shared_ptr<format_negotiator> instance();
+	};
+} // namespace streamfx::ffmpeg
@@ -0,0 +1,428 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gpu-converter.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<ffmpeg::gpu_converter> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace streamfx::ffmpeg;
+
+// Scale to turn a 10-bit value stored in the upper bits of a 16-bit unorm back into the 10-bit range.
+static constexpr float msb10_to_unorm = 65535.f / (1023.f * 64.f);
+// Scale to store a 10-bit value in the upper bits of a 16-bit unorm (P010).
+static constexpr float unorm_to_msb10 = (1023.f * 64.f) / 65535.f;
+// Scale to store a 10-bit value in the lower bits of a 16-bit unorm (YUV4xxP10).
+static constexpr float unorm_to_lsb10 = 1023.f / 65535.f;
+
+namespace {
+	// Affine transform in column-vector form: out = m * [in, 1].
+	typedef std::array<std::array<double, 4>, 4> affine_t;
+
+	affine_t affine_identity()
+	{
+		return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+	}
+
+	affine_t affine_multiply(const affine_t& a, const affine_t& b)
+	{
+		affine_t r{};
+		for (std::size_t row = 0; row < 4; row++) {
+			for (std::size_t col = 0; col < 4; col++) {
+				for (std::size_t idx = 0; idx < 4; idx++) {
+					r[row][col] += a[row][idx] * b[idx][col];
+				}
+			}
+		}
+		return r;
+	}
+
+	void get_coefficients(AVColorSpace colorspace, double& kr, double& kb)
+	{
+		switch (colorspace) {
+		case AVCOL_SPC_BT470BG:
+		case AVCOL_SPC_SMPTE170M:
+		case AVCOL_SPC_SMPTE240M:
+			kr = 0.299;
+			kb = 0.114;
+			break;
+		case AVCOL_SPC_BT2020_NCL:
+		case AVCOL_SPC_BT2020_CL:
+		case AVCOL_SPC_ICTCP:
+			kr = 0.2627;
+			kb = 0.0593;
+			break;
+		default:
+			kr = 0.2126;
+			kb = 0.0722;
+			break;
+		}
+	}
+
+	// Encodes normalized YCbCr (Y in [0, 1], CbCr in [-.5, .5]) into normalized code values.
+	affine_t range_encode(AVColorRange range, uint8_t bits)
+	{
+		double max   = static_cast<double>((1 << bits) - 1);
+		double scale = static_cast<double>(1 << (bits - 8));
+
+		affine_t m = affine_identity();
+		if (range == AVCOL_RANGE_JPEG) {
+			m[1][3] = static_cast<double>(1 << (bits - 1)) / max;
+			m[2][3] = m[1][3];
+		} else {
+			m[0][0] = (219. * scale) / max;
+			m[1][1] = (224. * scale) / max;
+			m[2][2] = (224. * scale) / max;
+			m[0][3] = (16. * scale) / max;
+			m[1][3] = (128. * scale) / max;
+			m[2][3] = (128. * scale) / max;
+		}
+		return m;
+	}
+
+	// Inverse of range_encode.
+	affine_t range_decode(AVColorRange range, uint8_t bits)
+	{
+		affine_t enc = range_encode(range, bits);
+		affine_t m   = affine_identity();
+		for (std::size_t idx = 0; idx < 3; idx++) {
+			m[idx][idx] = 1. / enc[idx][idx];
+			m[idx][3]   = -enc[idx][3] / enc[idx][idx];
+		}
+		return m;
+	}
+
+	affine_t rgb_to_ycbcr(AVColorSpace colorspace)
+	{
+		double kr, kb;
+		get_coefficients(colorspace, kr, kb);
+		double kg = 1. - kr - kb;
+
+		affine_t m = affine_identity();
+		m[0]       = {kr, kg, kb, 0};
+		m[1]       = {-kr / (2. * (1. - kb)), -kg / (2. * (1. - kb)), .5, 0};
+		m[2]       = {.5, -kg / (2. * (1. - kr)), -kb / (2. * (1. - kr)), 0};
+		return m;
+	}
+
+	affine_t ycbcr_to_rgb(AVColorSpace colorspace)
+	{
+		double kr, kb;
+		get_coefficients(colorspace, kr, kb);
+		double kg = 1. - kr - kb;
+
+		affine_t m = affine_identity();
+		m[0]       = {1., 0., 2. * (1. - kr), 0};
+		m[1]       = {1., -(2. * kb * (1. - kb)) / kg, -(2. * kr * (1. - kr)) / kg, 0};
+		m[2]       = {1., 2. * (1. - kb), 0., 0};
+		return m;
+	}
+
+	struct format_info {
+		uint8_t  bits;
+		float    output_scale;
+		uint32_t chroma_shift_x;
+		uint32_t chroma_shift_y;
+		bool     interleaved;
+	};
+
+	bool get_format_info(AVPixelFormat format, format_info& info)
+	{
+		switch (format) {
+		case AV_PIX_FMT_NV12:
+			info = {8, 1.f, 1, 1, true};
+			return true;
+		case AV_PIX_FMT_P010:
+			info = {10, unorm_to_msb10, 1, 1, true};
+			return true;
+		case AV_PIX_FMT_YUV420P:
+			info = {8, 1.f, 1, 1, false};
+			return true;
+		case AV_PIX_FMT_YUV422P:
+			info = {8, 1.f, 1, 0, false};
+			return true;
+		case AV_PIX_FMT_YUV444P:
+			info = {8, 1.f, 0, 0, false};
+			return true;
+		case AV_PIX_FMT_YUV420P10:
+			info = {10, unorm_to_lsb10, 1, 1, false};
+			return true;
+		case AV_PIX_FMT_YUV422P10:
+			info = {10, unorm_to_lsb10, 1, 0, false};
+			return true;
+		case AV_PIX_FMT_YUV444P10:
+			info = {10, unorm_to_lsb10, 0, 0, false};
+			return true;
+		default:
+			return false;
+		}
+	}
+} // namespace
+
+gpu_converter::~gpu_converter()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_slots.clear();
+	_targets.clear();
+}
+
+gpu_converter::gpu_converter(uint32_t width, uint32_t height, AVPixelFormat format, AVColorSpace colorspace, AVColorRange range, std::size_t depth)
+	: _width(width), _height(height), _format(format), _colorspace(colorspace), _range(range),
+
+	  _source_format(VIDEO_FORMAT_NV12), _source_colorspace(colorspace), _source_range(range),
+
+	  _planes(), _targets(), _slots(), _slot_write(0), _slot_used(0),
+
+	  _matrix(), _input_scale(), _input_packed(false), _output_scale(1.f),
+
+	  _effect(), _gfx_util(::streamfx::gfx::util::get())
+{
+	format_info info;
+	if (!get_format_info(format, info)) {
+		throw std::invalid_argument("Pixel format is not supported by GPU conversion.");
+	}
+	if ((width == 0) || (height == 0)) {
+		throw std::invalid_argument("Width and height must be at least 1.");
+	}
+	if (depth < 2) {
+		throw std::invalid_argument("Depth must be at least 2.");
+	}
+
+	{ // Describe the planes of the target format.
+		uint32_t        chroma_width  = (width + ((1 << info.chroma_shift_x) - 1)) >> info.chroma_shift_x;
+		uint32_t        chroma_height = (height + ((1 << info.chroma_shift_y) - 1)) >> info.chroma_shift_y;
+		bool            is_16bit      = info.bits > 8;
+		gs_color_format single        = is_16bit ? GS_R16 : GS_R8;
+		gs_color_format dual          = is_16bit ? GS_RG16 : GS_R8G8;
+
+		_planes.push_back({width, height, single, "Luma", is_16bit ? 2u : 1u});
+		if (info.interleaved) {
+			_planes.push_back({chroma_width, chroma_height, dual, "Chroma", is_16bit ? 4u : 2u});
+		} else {
+			_planes.push_back({chroma_width, chroma_height, single, "ChromaU", is_16bit ? 2u : 1u});
+			_planes.push_back({chroma_width, chroma_height, single, "ChromaV", is_16bit ? 2u : 1u});
+		}
+		_output_scale = info.output_scale;
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+
+	{ // Load the conversion effect.
+		auto file = streamfx::data_file_path("effects/yuv-convert.effect");
+		try {
+			_effect = streamfx::obs::gs::effect::create(file);
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+			throw;
+		}
+	}
+
+	// Create one render target per plane, and one staging surface per plane per slot.
+	for (auto& plane : _planes) {
+		_targets.push_back(std::make_shared<streamfx::obs::gs::rendertarget>(plane.format, GS_ZS_NONE));
+	}
+	_slots.resize(depth);
+	for (auto& slot : _slots) {
+		for (auto& plane : _planes) {
+			gs_stagesurf_t* stage = gs_stagesurface_create(plane.width, plane.height, plane.format);
+			if (!stage) {
+				throw std::runtime_error("Failed to create staging surface.");
+			}
+			slot.stages.emplace_back(stage, [](gs_stagesurf_t* v) { gs_stagesurface_destroy(v); });
+		}
+		slot.pts = 0;
+	}
+
+	update_matrix();
+}
+
+void gpu_converter::set_source(video_format format, AVColorSpace colorspace, AVColorRange range)
+{
+	switch (format) {
+	case VIDEO_FORMAT_NV12:
+	case VIDEO_FORMAT_P010:
+	case VIDEO_FORMAT_RGBA:
+	case VIDEO_FORMAT_BGRA:
+	case VIDEO_FORMAT_BGRX:
+		break;
+	default:
+		throw std::invalid_argument("Source format is not supported by GPU conversion.");
+	}
+
+	_source_format     = format;
+	_source_colorspace = colorspace;
+	_source_range      = range;
+	update_matrix();
+}
+
+void gpu_converter::update_matrix()
+{
+	format_info info;
+	get_format_info(_format, info);
+
+	// Input: Decode the source into normalized RGB, unless it already is RGB.
+	affine_t to_rgb = affine_identity();
+	_input_packed   = (_source_format == VIDEO_FORMAT_RGBA) || (_source_format == VIDEO_FORMAT_BGRA) || (_source_format == VIDEO_FORMAT_BGRX);
+	if (!_input_packed) {
+		uint8_t source_bits = (_source_format == VIDEO_FORMAT_P010) ? 10 : 8;
+		to_rgb              = affine_multiply(ycbcr_to_rgb(_source_colorspace), range_decode(_source_range, source_bits));
+		if (_source_format == VIDEO_FORMAT_P010) {
+			vec2_set(&_input_scale, msb10_to_unorm, msb10_to_unorm);
+		} else {
+			vec2_set(&_input_scale, 1.f, 1.f);
+		}
+	} else {
+		vec2_set(&_input_scale, 1.f, 1.f);
+	}
+
+	// Output: Encode normalized RGB into the target matrix and range.
+	affine_t to_yuv = affine_multiply(range_encode(_range, info.bits), rgb_to_ycbcr(_colorspace));
+
+	// OBS uses row vectors (mul(v, M)), so store the transposed combined transform.
+	affine_t m = affine_multiply(to_yuv, to_rgb);
+	vec4_set(&_matrix.x, static_cast<float>(m[0][0]), static_cast<float>(m[1][0]), static_cast<float>(m[2][0]), 0.f);
+	vec4_set(&_matrix.y, static_cast<float>(m[0][1]), static_cast<float>(m[1][1]), static_cast<float>(m[2][1]), 0.f);
+	vec4_set(&_matrix.z, static_cast<float>(m[0][2]), static_cast<float>(m[1][2]), static_cast<float>(m[2][2]), 0.f);
+	vec4_set(&_matrix.t, static_cast<float>(m[0][3]), static_cast<float>(m[1][3]), static_cast<float>(m[2][3]), 1.f);
+}
+
+bool gpu_converter::push(gs_texture_t* const* textures, int64_t pts)
+{
+	if (is_full()) {
+		return false;
+	}
+	if (!textures || !textures[0] || (!_input_packed && !textures[1])) {
+		throw std::invalid_argument("Missing input textures.");
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_convert, "GPU Conversion"};
+#endif
+
+	auto& slot = _slots[_slot_write];
+
+	gs_blend_state_push();
+	gs_reset_blend_state();
+	gs_enable_blending(false);
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	gs_enable_color(true, true, true, true);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_stencil_write(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	_effect.get_parameter("InputA").set_texture(textures[0]);
+	_effect.get_parameter("InputB").set_texture(_input_packed ? textures[0] : textures[1]);
+	_effect.get_parameter("InputIsPacked").set_bool(_input_packed);
+	_effect.get_parameter("InputScale").set_float2(_input_scale);
+	_effect.get_parameter("ConvertMatrix").set_matrix(_matrix);
+	_effect.get_parameter("OutputScale").set_float(_output_scale);
+
+	for (std::size_t idx = 0; idx < _planes.size(); idx++) {
+		auto& plane = _planes[idx];
+
+		{
+			auto op = _targets[idx]->render(plane.width, plane.height);
+			gs_ortho(0, 1, 0, 1, 0, 1);
+			while (gs_effect_loop(_effect.get_object(), plane.technique.c_str())) {
+				_gfx_util->draw_fullscreen_triangle();
+			}
+		}
+
+		// Queue the copy into the staging surface, this does not block.
+		gs_stage_texture(slot.stages[idx].get(), _targets[idx]->get_object());
+	}
+
+	gs_blend_state_pop();
+
+	slot.pts    = pts;
+	_slot_write = (_slot_write + 1) % _slots.size();
+	_slot_used++;
+	return true;
+}
+
+bool gpu_converter::pop(AVFrame* frame)
+{
+	if (_slot_used == 0) {
+		return false;
+	}
+
+	std::size_t read = (_slot_write + _slots.size() - _slot_used) % _slots.size();
+	auto&       slot = _slots[read];
+
+	// The slot is released no matter what, a frame that can't be read back is lost but must not block the ring.
+	_slot_used--;
+
+	auto gctx = streamfx::obs::gs::context();
+	for (std::size_t idx = 0; idx < _planes.size(); idx++) {
+		auto&    plane    = _planes[idx];
+		uint8_t* data     = nullptr;
+		uint32_t linesize = 0;
+
+		if (!gs_stagesurface_map(slot.stages[idx].get(), &data, &linesize)) {
+			D_LOG_ERROR("Failed to map staging surface for plane %zu, dropping frame %" PRId64 ".", idx, slot.pts);
+			return false;
+		}
+
+		std::size_t row_size = std::min<std::size_t>(plane.width * plane.bytes_per_pixel, static_cast<std::size_t>(frame->linesize[idx]));
+		if (linesize == static_cast<uint32_t>(frame->linesize[idx])) {
+			std::memcpy(frame->data[idx], data, static_cast<std::size_t>(linesize) * plane.height);
+		} else {
+			uint8_t* to   = frame->data[idx];
+			uint8_t* from = data;
+			for (uint32_t y = 0; y < plane.height; y++) {
+				std::memcpy(to, from, row_size);
+				to += frame->linesize[idx];
+				from += linesize;
+			}
+		}
+
+		gs_stagesurface_unmap(slot.stages[idx].get());
+	}
+
+	frame->pts = slot.pts;
+	return true;
+}
+
+std::size_t gpu_converter::size()
+{
+	return _slot_used;
+}
+
+std::size_t gpu_converter::depth()
+{
+	return _slots.size();
+}
+
+bool gpu_converter::is_full()
+{
+	return _slot_used >= _slots.size();
+}
+
+bool gpu_converter::is_supported(AVPixelFormat format)
+{
+	format_info info;
+	return get_format_info(format, info);
+}
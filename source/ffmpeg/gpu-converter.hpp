@@ -0,0 +1,120 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+
+#include "warning-disable.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+extern "C" {
+#include "warning-disable.hpp"
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include "warning-enable.hpp"
+}
+
+/* gpu_converter converts textures straight into the exact pixel format an
+ *  encoder wants, and reads the result back into an AVFrame.
+ *
+ * The conversion (matrix, range, chroma subsampling and bit packing) happens in
+ *  a single shader pass per output plane. Each converted plane is then copied
+ *  into a staging surface, of which there are 'depth' sets in a ring. Mapping
+ *  is delayed until the ring is full, so that the GPU has had 'depth - 1'
+ *  frames of time to finish the copy and mapping does not stall the pipeline.
+ */
+
+namespace streamfx::ffmpeg {
+	class gpu_converter {
+		struct plane_info {
+			uint32_t        width;
+			uint32_t        height;
+			gs_color_format format;
+			std::string     technique;
+			std::size_t     bytes_per_pixel;
+		};
+
+		struct slot_info {
+			std::vector<std::shared_ptr<gs_stagesurf_t>> stages;
+			int64_t                                      pts;
+		};
+
+		uint32_t      _width;
+		uint32_t      _height;
+		AVPixelFormat _format;
+		AVColorSpace  _colorspace;
+		AVColorRange  _range;
+
+		video_format _source_format;
+		AVColorSpace _source_colorspace;
+		AVColorRange _source_range;
+
+		std::vector<plane_info>                                       _planes;
+		std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _targets;
+		std::vector<slot_info>                                        _slots;
+		std::size_t                                                   _slot_write;
+		std::size_t                                                   _slot_used;
+
+		matrix4 _matrix;
+		vec2    _input_scale;
+		bool    _input_packed;
+		float   _output_scale;
+
+		streamfx::obs::gs::effect            _effect;
+		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+
+		public:
+		~gpu_converter();
+
+		/** Create a new converter for the given target.
+		 *
+		 * @param width Width of the target frame.
+		 * @param height Height of the target frame.
+		 * @param format Pixel format of the target frame, see is_supported().
+		 * @param colorspace Color space (matrix) of the target frame.
+		 * @param range Color range of the target frame.
+		 * @param depth Number of frames in flight between conversion and read back.
+		 */
+		gpu_converter(uint32_t width, uint32_t height, AVPixelFormat format, AVColorSpace colorspace, AVColorRange range, std::size_t depth = 3);
+
+		/** Describe the textures that will be given to push().
+		 *
+		 * NV12 and P010 expect a luma and a chroma texture, RGBA and BGRA expect a
+		 *  single texture.
+		 */
+		void set_source(video_format format, AVColorSpace colorspace, AVColorRange range);
+
+		/** Convert and stage a frame. Must be called with the graphics context entered.
+		 *
+		 * @return false if the ring is full and pop() must be called first.
+		 */
+		bool push(gs_texture_t* const* textures, int64_t pts);
+
+		/** Map the oldest staged frame and copy it into frame.
+		 *
+		 * The oldest frame is released even if it can't be mapped, in which case it is lost.
+		 *
+		 * @return false if there is nothing to pop, or the frame was lost.
+		 */
+		bool pop(AVFrame* frame);
+
+		std::size_t size();
+
+		std::size_t depth();
+
+		bool is_full();
+
+		public:
+		static bool is_supported(AVPixelFormat format);
+
+		private:
+		void update_matrix();
+	};
+} // namespace streamfx::ffmpeg
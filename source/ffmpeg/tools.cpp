@@ -5,8 +5,10 @@
 
 #include "tools.hpp"
 #include "plugin.hpp"
+#include "util/util-hugepage.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <list>
 #include <sstream>
 #include "warning-enable.hpp"
@@ -15,6 +17,7 @@ extern "C" {
 #include "warning-disable.hpp"
 #include <libavcodec/avcodec.h>
 #include <libavutil/error.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libavutil/pixdesc.h>
 #include "warning-enable.hpp"
@@ -327,6 +330,62 @@ void tools::context_setup_from_obs(const video_output_info* voi, AVCodecContext*
 	}
 }
 
+int tools::get_frame_buffer(AVFrame* frame, int align)
+{
+	auto format = static_cast<AVPixelFormat>(frame->format);
+	auto desc   = av_pix_fmt_desc_get(format);
+	if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) || (frame->width <= 0) || (frame->height <= 0) || (align <= 0)) {
+		return AVERROR(EINVAL);
+	}
+
+	// Same layout as libavutil would use: every line aligned, the height padded for codecs that work on
+	// whole macroblocks or superblocks, and padding after every plane for SIMD reads.
+	int width         = FFALIGN(frame->width, align);
+	int padded_height = FFALIGN(frame->height, 32);
+	int plane_padding = std::max(16 + 16, align);
+	if (int res = av_image_fill_linesizes(frame->linesize, format, width); res < 0) {
+		return res;
+	}
+	for (std::size_t idx = 0; idx < 4; idx++) {
+		frame->linesize[idx] = FFALIGN(frame->linesize[idx], align);
+	}
+	int size = av_image_fill_pointers(frame->data, format, padded_height, nullptr, frame->linesize);
+	if (size < 0) {
+		return size;
+	}
+	size += 4 * plane_padding;
+
+	::streamfx::util::hugepage::block* block = nullptr;
+	try {
+		block = new ::streamfx::util::hugepage::block(::streamfx::util::hugepage::allocate(static_cast<std::size_t>(size)));
+	} catch (...) {
+		return AVERROR(ENOMEM);
+	}
+
+	frame->buf[0] = av_buffer_create(
+		static_cast<uint8_t*>(block->data), size,
+		[](void* opaque, uint8_t*) {
+			auto block = static_cast<::streamfx::util::hugepage::block*>(opaque);
+			::streamfx::util::hugepage::free(*block);
+			delete block;
+		},
+		block, 0);
+	if (!frame->buf[0]) {
+		::streamfx::util::hugepage::free(*block);
+		delete block;
+		return AVERROR(ENOMEM);
+	}
+
+	av_image_fill_pointers(frame->data, format, padded_height, frame->buf[0]->data, frame->linesize);
+	for (std::size_t idx = 1; idx < 4; idx++) {
+		if (frame->data[idx]) {
+			frame->data[idx] += idx * static_cast<std::size_t>(plane_padding);
+		}
+	}
+	frame->extended_data = frame->data;
+	return 0;
+}
+
 const char* tools::get_std_compliance_name(int compliance)
 {
 	switch (compliance) {
@@ -13,6 +13,7 @@
 extern "C" {
 #include "warning-disable.hpp"
 #include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
 #include <libavutil/opt.h>
 #include <libavutil/pixfmt.h>
 #include "warning-enable.hpp"
@@ -41,6 +42,12 @@ namespace streamfx::ffmpeg::tools {
 
 	void context_setup_from_obs(const video_output_info* voi, AVCodecContext* context);
 
+	/** Like av_frame_get_buffer, but for video only and backed by huge pages where possible.
+	 *
+	 * Width, height and format must already be set on the frame.
+	 */
+	int get_frame_buffer(AVFrame* frame, int align);
+
 	const char* get_std_compliance_name(int compliance);
 
 	const char* get_thread_type_name(int thread_type);
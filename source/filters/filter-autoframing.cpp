@@ -7,6 +7,17 @@
 #include "obs/gs/gs-helper.hpp"
 #include "util/util-logging.hpp"
 
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <tuple>
+#include "warning-enable.hpp"
+
+#include "warning-disable.hpp"
+#include <graphics/matrix4.h>
+#include <graphics/vec3.h>
+#include "warning-enable.hpp"
+
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
 #define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
@@ -63,6 +74,8 @@
 #define ST_I18N_FRAMING_MODE_GROUP ST_I18N_TRACKING_MODE ".Group"
 #define ST_KEY_TRACKING_FREQUENCY "Tracking.Frequency"
 #define ST_I18N_TRACKING_FREQUENCY ST_I18N_TRACKING ".Frequency"
+#define ST_KEY_TRACKING_REGIONOFINTEREST "Tracking.RegionOfInterest"
+#define ST_I18N_TRACKING_REGIONOFINTEREST ST_I18N_TRACKING ".RegionOfInterest"
 
 #define ST_I18N_MOTION ST_I18N ".Motion"
 #define ST_KEY_MOTION_PREDICTION "Motion.Prediction"
@@ -86,8 +99,12 @@
 
 #define ST_KALMAN_EEC 1.0f
 
+// Longest side of the copy of the input that is given to providers.
+#define ST_DETECTION_LIMIT 1280
+
 using streamfx::filter::autoframing::autoframing_factory;
 using streamfx::filter::autoframing::autoframing_instance;
+using streamfx::filter::autoframing::detection_cache;
 using streamfx::filter::autoframing::tracking_provider;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Filter-Auto-Framing";
@@ -130,10 +147,128 @@ std::string streamfx::filter::autoframing::string(tracking_provider provider)
 	return cstring(provider);
 }
 
+// Nested pass-through sources followed before giving up.
+static constexpr std::size_t origin_depth_limit = 8;
+
+bool streamfx::filter::autoframing::detection_cache::key::operator<(const key& rhs) const
+{
+	return std::tie(origin, frame, size, provider, mode) < std::tie(rhs.origin, rhs.frame, rhs.size, rhs.provider, rhs.mode);
+}
+
+streamfx::filter::autoframing::detection_cache::~detection_cache() {}
+
+streamfx::filter::autoframing::detection_cache::detection_cache() : _lock(), _frame(0), _entries() {}
+
+std::shared_ptr<const streamfx::filter::autoframing::detection_cache::elements_t> streamfx::filter::autoframing::detection_cache::get(const key& key, std::function<bool(elements_t&)> detect)
+{
+	std::shared_ptr<std::promise<std::shared_ptr<const elements_t>>> promise;
+	std::shared_future<std::shared_ptr<const elements_t>>            result;
+
+	{
+		std::unique_lock<decltype(_lock)> lock(_lock);
+
+		// Requests for an older frame come from a source that fell behind, which must not throw away the results for
+		//  the current frame. Nobody else will ask for that frame anymore, so just detect without caching.
+		if (key.frame < _frame) {
+			lock.unlock();
+			auto elements = std::make_shared<elements_t>();
+			return detect(*elements) ? std::shared_ptr<const elements_t>(elements) : nullptr;
+		}
+
+		// Results are only valid for the frame they were made on.
+		if (key.frame != _frame) {
+			_frame = key.frame;
+			_entries.clear();
+		}
+
+		if (auto kv = _entries.find(key); kv != _entries.end()) {
+			// Detection capturing its input rendered something that asked for the very same key. Waiting for ourselves
+			//  would never return, so fail this request instead.
+			if ((kv->second.detector == std::this_thread::get_id()) && (kv->second.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+				D_LOG_ERROR("Detection re-entered itself for the same frame, skipping.", nullptr);
+				return nullptr;
+			}
+			result = kv->second.result;
+		} else {
+			promise = std::make_shared<std::promise<std::shared_ptr<const elements_t>>>();
+			result  = promise->get_future().share();
+			_entries.emplace(key, entry{result, std::this_thread::get_id()});
+		}
+	}
+
+	if (promise) {
+		// Failures are shared too, so that a failing provider runs once per frame instead of once per instance.
+		auto elements = std::make_shared<elements_t>();
+		try {
+			promise->set_value(detect(*elements) ? std::shared_ptr<const elements_t>(elements) : nullptr);
+		} catch (...) {
+			promise->set_value(nullptr);
+			throw;
+		}
+	}
+
+	return result.get();
+}
+
+obs_source_t* streamfx::filter::autoframing::detection_cache::find_origin(obs_source_t* filter)
+{
+	obs_source_t* parent = obs_filter_get_parent(filter);
+	obs_source_t* target = obs_filter_get_target(filter);
+
+	// Filters before us change what we see, so there is nothing to share.
+	if (target != parent) {
+		return filter;
+	}
+
+	obs_source_t* origin = parent;
+	for (std::size_t depth = 0; depth < origin_depth_limit; depth++) {
+		// Scenes, transitions and the like compose several sources into one.
+		if (obs_source_get_type(origin) != OBS_SOURCE_TYPE_INPUT) {
+			break;
+		}
+
+		std::vector<obs_source_t*> children;
+		obs_source_enum_active_sources(
+			origin, [](obs_source_t*, obs_source_t* child, void* param) { reinterpret_cast<std::vector<obs_source_t*>*>(param)->push_back(child); }, &children);
+		if (children.size() != 1) {
+			break;
+		}
+
+		// The child must look exactly the same as what is shown. Its filters are part of what is shown, but
+		//  something filtering its unfiltered output would see something different, so stop there.
+		obs_source_t* child = children.front();
+		if ((obs_source_get_width(child) != obs_source_get_width(origin)) || (obs_source_get_height(child) != obs_source_get_height(origin))) {
+			break;
+		}
+		if (obs_source_filter_count(child) > 0) {
+			break;
+		}
+
+		origin = child;
+	}
+	return origin;
+}
+
+std::shared_ptr<streamfx::filter::autoframing::detection_cache> streamfx::filter::autoframing::detection_cache::instance()
+{
+	static std::weak_ptr<detection_cache> winst;
+	static std::mutex                     mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<detection_cache>(new detection_cache());
+		winst    = instance;
+	}
+	return instance;
+}
+
 autoframing_instance::~autoframing_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	::streamfx::util::roi::registry::instance()->withdraw(this);
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
@@ -160,13 +295,13 @@ autoframing_instance::~autoframing_instance()
 autoframing_instance::autoframing_instance(obs_data_t* data, obs_source_t* self)
 	: source_instance(data, self),
 
-	  _dirty(true), _size(1, 1), _out_size(1, 1),
+	  _dirty(true), _size(1, 1), _out_size(1, 1), _detect_size(1, 1),
 
-	  _gfx_debug(), _standard_effect(), _input(), _vb(),
+	  _gfx_debug(), _standard_effect(), _input(), _detect(), _full(),
 
-	  _provider(tracking_provider::INVALID), _provider_ui(tracking_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(),
+	  _provider(tracking_provider::INVALID), _provider_ui(tracking_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _cache(detection_cache::instance()),
 
-	  _track_mode(tracking_mode::SOLO), _track_frequency(1),
+	  _track_mode(tracking_mode::SOLO), _track_frequency(1), _track_roi(false),
 
 	  _motion_smoothing(0.0), _motion_smoothing_kalman_pnc(1.), _motion_smoothing_kalman_mnc(1.), _motion_prediction(0.0),
 
@@ -186,20 +321,16 @@ autoframing_instance::autoframing_instance(obs_data_t* data, obs_source_t* self)
 		// Get debug renderer.
 		_gfx_debug = ::streamfx::gfx::util::get();
 
-		// Create the render target for the input buffering.
+		// Create the render targets for the input buffering.
 		_input = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
 		_input->render(1, 1); // Preallocate the RT on the driver and GPU.
+		_detect = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		_detect->render(1, 1);
+		_full = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		_full->render(1, 1);
 
 		// Load the required effect.
 		_standard_effect = std::make_shared<::streamfx::obs::gs::effect>(::streamfx::data_file_path("effects/standard.effect"));
-
-		// Create the Vertex Buffer for rendering.
-		_vb = std::make_shared<::streamfx::obs::gs::vertex_buffer>(uint32_t{4}, uint8_t{1});
-		vec3_set(_vb->at(0).position, 0, 0, 0);
-		vec3_set(_vb->at(1).position, 1, 0, 0);
-		vec3_set(_vb->at(2).position, 0, 1, 0);
-		vec3_set(_vb->at(3).position, 1, 1, 0);
-		_vb->update(true);
 	}
 
 	if (data) {
@@ -241,6 +372,10 @@ void autoframing_instance::update(obs_data_t* data)
 		}
 	}
 	_track_frequency_counter = 0;
+	_track_roi               = obs_data_get_bool(data, ST_KEY_TRACKING_REGIONOFINTEREST);
+	if (!_track_roi) {
+		::streamfx::util::roi::registry::instance()->withdraw(this);
+	}
 
 	// Motion
 	_motion_prediction           = static_cast<float>(obs_data_get_double(data, ST_KEY_MOTION_PREDICTION)) / 100.f;
@@ -419,8 +554,16 @@ void autoframing_instance::video_tick(float_t seconds)
 		}
 	}
 
+	{ // Providers don't need full resolution to find faces, so give them a smaller copy.
+		float scale  = std::min(1.f, static_cast<float>(ST_DETECTION_LIMIT) / static_cast<float>(std::max<uint32_t>(std::max(width, height), 1)));
+		_detect_size = {std::max<uint32_t>(static_cast<uint32_t>(std::lroundf(static_cast<float>(width) * scale)), 1), std::max<uint32_t>(static_cast<uint32_t>(std::lroundf(static_cast<float>(height) * scale)), 1)};
+	}
+
 	// Update tracking.
 	tracking_tick(seconds);
+	if (_track_roi) {
+		publish_regions();
+	}
 
 	// Mark the effect as dirty.
 	_dirty = true;
@@ -432,7 +575,6 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 	auto target = obs_filter_get_target(_self);
 	auto width  = obs_source_get_base_width(target);
 	auto height = obs_source_get_base_height(target);
-	vec4 blank  = vec4{0, 0, 0, 0};
 
 	// Ensure we have the bare minimum of valid information.
 	target = target ? target : parent;
@@ -453,52 +595,40 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 #endif
 
 	if (_dirty) {
-		// Capture the input.
-		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-			auto op = _input->render(width, height);
-
-			// Set correct projection matrix.
-			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
-
-			// Clear the buffer
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
-
-			// Set GPU state
-			gs_blend_state_push();
-			gs_enable_color(true, true, true, true);
-			gs_enable_blending(false);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_set_cull_mode(GS_NEITHER);
-
-			// Render
-			bool srgb = gs_framebuffer_srgb_enabled();
-			gs_enable_framebuffer_srgb(gs_get_linear_srgb());
-			obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
-			gs_enable_framebuffer_srgb(srgb);
-
-			// Reset GPU state
-			gs_blend_state_pop();
-		} else {
-			obs_source_skip_video_filter(_self);
-			return;
-		}
+		// Set if detection captured the entire input into _full, so that the parent is never rendered twice.
+		bool detected = false;
 
-		// Lock & Process the captured input with the provider.
+		// Lock & Process a downscaled copy of the entire input with the provider.
 		if (_track_frequency_counter >= _track_frequency) {
 			_track_frequency_counter = 0;
 
-			std::unique_lock<std::mutex> ul(_provider_lock);
-			switch (_provider) {
-#ifdef ENABLE_FILTER_DENOISING_NVIDIA
-			case tracking_provider::NVIDIA_FACEDETECTION:
-				nvar_facedetection_process();
-				break;
-#endif
-			default:
+			// Other instances may have already processed this exact frame, in which case neither capture nor detection is necessary.
+			detection_cache::key key{detection_cache::find_origin(_self), obs_get_video_frame_time(), _detect_size, _provider, _track_mode};
+			auto                 elements = _cache->get(key, [this, width, height, &detected](detection_cache::elements_t& elements) { return detect(elements, width, height, detected); });
+			if (!elements) {
 				obs_source_skip_video_filter(_self);
 				return;
 			}
+
+			track(*elements);
+		}
+
+		// Capture only the framed region, straight at output size. Debug mode shows everything instead.
+		vec4 region{0, 0, static_cast<float>(width), static_cast<float>(height)};
+		auto size = std::pair<uint32_t, uint32_t>{width, height};
+		if (!_debug) {
+			region = vec4{_frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f, _frame_pos.x + _frame_size.x / 2.f, _frame_pos.y + _frame_size.y / 2.f};
+			size   = _out_size;
+		}
+		bool captured = true;
+		if (detected) {
+			resample(_full->get_texture(), _input, size.first, size.second, region);
+		} else {
+			captured = capture(_input, size.first, size.second, region);
+		}
+		if (!captured) {
+			obs_source_skip_video_filter(_self);
+			return;
 		}
 
 		_dirty = false;
@@ -509,12 +639,13 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Render"};
 #endif
 
-		if (_debug) { // Debug Mode
-			gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), _input->get_object());
-			while (gs_effect_loop(effect, "Draw")) {
-				gs_draw_sprite(nullptr, 0, _size.first, _size.second);
-			}
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), _input->get_object());
+		while (gs_effect_loop(effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, get_width(), get_height());
+		}
 
+		if (_debug) { // Debug Mode
+			_gfx_debug->begin_batch();
 			for (auto kv : _predicted_elements) {
 				// Tracked Area (Red)
 				_gfx_debug->draw_rectangle(kv.first->pos.x - kv.first->size.x / 2.f, kv.first->pos.y - kv.first->size.y / 2.f, kv.first->size.x, kv.first->size.y, true, 0x7E0000FF);
@@ -540,56 +671,257 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 
 			// Final Region (White)
 			_gfx_debug->draw_rectangle(_frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f, _frame_size.x, _frame_size.y, true, 0x7EFFFFFF);
-		} else {
-			float x0 = (_frame_pos.x - _frame_size.x / 2.f) / static_cast<float>(_size.first);
-			float x1 = (_frame_pos.x + _frame_size.x / 2.f) / static_cast<float>(_size.first);
-			float y0 = (_frame_pos.y - _frame_size.y / 2.f) / static_cast<float>(_size.second);
-			float y1 = (_frame_pos.y + _frame_size.y / 2.f) / static_cast<float>(_size.second);
+			_gfx_debug->end_batch();
+		}
+	}
+}
 
-			{
-				auto v = _vb->at(0);
-				vec3_set(v.position, 0., 0., 0.);
-				v.uv[0]->x = x0;
-				v.uv[0]->y = y0;
-			}
-			{
-				auto v = _vb->at(1);
-				vec3_set(v.position, static_cast<float>(_out_size.first), 0., 0.);
-				v.uv[0]->x = x1;
-				v.uv[0]->y = y0;
-			}
-			{
-				auto v = _vb->at(2);
-				vec3_set(v.position, 0., static_cast<float>(_out_size.second), 0.);
-				v.uv[0]->x = x0;
-				v.uv[0]->y = y1;
+bool autoframing_instance::capture(std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height, const vec4& region)
+{
+	if (!obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
+		return false;
+	}
+
+	auto op = target->render(width, height);
+
+	// Project only the requested region onto the target, so that nothing outside of it is ever drawn.
+	gs_ortho(region.x, region.z, region.y, region.w, 0, 1);
+
+	// Clear the buffer
+	vec4 blank = vec4{0, 0, 0, 0};
+	gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
+
+	// Set GPU state
+	gs_blend_state_push();
+	gs_enable_color(true, true, true, true);
+	gs_enable_blending(false);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	// Render
+	bool srgb = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(gs_get_linear_srgb());
+	obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), _size.first, _size.second);
+	gs_enable_framebuffer_srgb(srgb);
+
+	// Reset GPU state
+	gs_blend_state_pop();
+	return true;
+}
+
+void autoframing_instance::resample(std::shared_ptr<::streamfx::obs::gs::texture> source, std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height, const vec4& region)
+{
+	auto op = target->render(width, height);
+
+	// Same projection as capture(), but drawing an already captured copy of the entire input.
+	gs_ortho(region.x, region.z, region.y, region.w, 0, 1);
+
+	// Clear the buffer
+	vec4 blank = vec4{0, 0, 0, 0};
+	gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0, 0);
+
+	// Set GPU state
+	gs_blend_state_push();
+	gs_enable_color(true, true, true, true);
+	gs_enable_blending(false);
+	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_set_cull_mode(GS_NEITHER);
+
+	// Render, copying the values as they were stored.
+	bool         srgb   = gs_framebuffer_srgb_enabled();
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_enable_framebuffer_srgb(false);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), source->get_object());
+	while (gs_effect_loop(effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, _size.first, _size.second);
+	}
+	gs_enable_framebuffer_srgb(srgb);
+
+	// Reset GPU state
+	gs_blend_state_pop();
+}
+
+// Nested scenes and groups followed while looking for a source in the program output.
+static constexpr std::size_t placement_depth_limit = 8;
+
+struct placement_search {
+	obs_source_t*         needle;
+	matrix4               outer; // Maps the pixels of the scene being searched to the canvas.
+	std::size_t           depth;
+	std::vector<matrix4>* placements;
+};
+
+// Build a transform that maps normalized coordinates of an item's uncropped source to pixels of its scene.
+static void get_item_transform(obs_sceneitem_t* item, float width, float height, matrix4& transform)
+{
+	obs_sceneitem_crop crop;
+	obs_sceneitem_get_crop(item, &crop);
+	float cropped_width  = width - static_cast<float>(crop.left + crop.right);
+	float cropped_height = height - static_cast<float>(crop.top + crop.bottom);
+	if ((cropped_width <= 0.f) || (cropped_height <= 0.f)) {
+		cropped_width  = width;
+		cropped_height = height;
+	}
+
+	// The box transform covers only the cropped part of the source.
+	matrix4 box;
+	obs_sceneitem_get_box_transform(item, &box);
+	matrix4_identity(&transform);
+	matrix4_translate3f(&transform, &transform, -static_cast<float>(crop.left) / width, -static_cast<float>(crop.top) / height, 0.f);
+	matrix4_scale3f(&transform, &transform, width / cropped_width, height / cropped_height, 1.f);
+	matrix4_mul(&transform, &transform, &box);
+}
+
+// Collect a transform to the canvas for every visible occurrence of a source in a scene, including nested ones.
+static void find_placements(obs_scene_t* scene, placement_search& search)
+{
+	obs_scene_enum_items(
+		scene,
+		[](obs_scene_t*, obs_sceneitem_t* item, void* param) {
+			auto& search = *reinterpret_cast<placement_search*>(param);
+			if (!obs_sceneitem_visible(item)) {
+				return true;
 			}
-			{
-				auto v = _vb->at(3);
-				vec3_set(v.position, static_cast<float>(_out_size.first), static_cast<float>(_out_size.second), 0.);
-				v.uv[0]->x = x1;
-				v.uv[0]->y = y1;
+
+			obs_source_t* source = obs_sceneitem_get_source(item);
+			float         width  = static_cast<float>(obs_source_get_width(source));
+			float         height = static_cast<float>(obs_source_get_height(source));
+			if ((width <= 0.f) || (height <= 0.f)) {
+				return true;
 			}
 
-			gs_load_vertexbuffer(_vb->update(true));
-			if (!effect) {
-				if (_standard_effect->has_parameter("InputA", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
-					_standard_effect->get_parameter("InputA").set_texture(_input->get_texture());
-				}
+			matrix4 transform;
+			get_item_transform(item, width, height, transform);
+			matrix4_mul(&transform, &transform, &search.outer);
 
-				while (gs_effect_loop(_standard_effect->get_object(), "Texture")) {
-					gs_draw(GS_TRISTRIP, 0, 4);
+			if (source == search.needle) {
+				search.placements->push_back(transform);
+			} else if (search.depth < placement_depth_limit) {
+				obs_scene_t* inner = obs_scene_from_source(source);
+				if (!inner) {
+					inner = obs_group_from_source(source);
 				}
-			} else {
-				gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), _input->get_texture()->get_object());
-
-				while (gs_effect_loop(effect, "Draw")) {
-					gs_draw(GS_TRISTRIP, 0, 4);
+				if (inner) {
+					// The nested scene works in its own pixels, which the item transform expects normalized.
+					placement_search nested = search;
+					matrix4_identity(&nested.outer);
+					matrix4_scale3f(&nested.outer, &nested.outer, 1.f / width, 1.f / height, 1.f);
+					matrix4_mul(&nested.outer, &nested.outer, &transform);
+					nested.depth++;
+					find_placements(inner, nested);
 				}
 			}
-			gs_load_vertexbuffer(nullptr);
+			return true;
+		},
+		&search);
+}
+
+// Find where a source is shown in the program output, as transforms from its normalized coordinates to canvas pixels.
+static std::vector<matrix4> get_program_placements(obs_source_t* needle)
+{
+	std::vector<matrix4> placements;
+
+	obs_source_t* program = obs_get_output_source(0);
+	if (program && (obs_source_get_type(program) == OBS_SOURCE_TYPE_TRANSITION)) {
+		obs_source_t* active = obs_transition_get_active_source(program);
+		obs_source_release(program);
+		program = active;
+	}
+	if (!program) {
+		return placements;
+	}
+
+	if (obs_scene_t* scene = obs_scene_from_source(program); scene) {
+		placement_search search{needle, {}, 0, &placements};
+		matrix4_identity(&search.outer);
+		find_placements(scene, search);
+	} else if (program == needle) { // Shown directly, without a scene.
+		matrix4 transform;
+		matrix4_identity(&transform);
+		matrix4_scale3f(&transform, &transform, static_cast<float>(obs_source_get_width(needle)), static_cast<float>(obs_source_get_height(needle)), 1.f);
+		placements.push_back(transform);
+	}
+	obs_source_release(program);
+
+	return placements;
+}
+
+void streamfx::filter::autoframing::autoframing_instance::publish_regions()
+{
+	// Sources only know whether they are shown in the program output, which is the main video output. Anything
+	//  else (previews, projectors) must not steer encoders.
+	obs_source_t* parent = obs_filter_get_parent(_self);
+	if (!parent || !obs_source_active(parent)) {
+		::streamfx::util::roi::registry::instance()->withdraw(this);
+		return;
+	}
+
+	// Encoders see the whole canvas, so the regions have to go wherever the source is placed on it.
+	obs_video_info ovi;
+	if (!obs_get_video_info(&ovi) || (ovi.base_width == 0) || (ovi.base_height == 0)) {
+		::streamfx::util::roi::registry::instance()->withdraw(this);
+		return;
+	}
+	auto placements = get_program_placements(parent);
+	if (placements.empty()) {
+		::streamfx::util::roi::registry::instance()->withdraw(this);
+		return;
+	}
+
+	vec2 origin;
+	vec2 scale;
+	if (_debug) { // The entire input is shown.
+		vec2_set(&origin, 0., 0.);
+		vec2_set(&scale, static_cast<float>(_size.first), static_cast<float>(_size.second));
+	} else {
+		vec2_set(&origin, _frame_pos.x - _frame_size.x / 2.f, _frame_pos.y - _frame_size.y / 2.f);
+		vec2_copy(&scale, &_frame_size);
+	}
+	if ((scale.x <= 0.f) || (scale.y <= 0.f)) {
+		return;
+	}
+
+	std::vector<::streamfx::util::roi::region> regions;
+	regions.reserve(_predicted_elements.size() * placements.size());
+	for (auto kv : _predicted_elements) {
+		// Use the tracked element itself, the padding is for framing and would only dilute the hint.
+		float x = kv.second->filter_pos_x.get();
+		float y = kv.second->filter_pos_y.get();
+		float w = kv.first->size.x / 2.f;
+		float h = kv.first->size.y / 2.f;
+
+		vec3 corners[4];
+		vec3_set(&corners[0], (x - w - origin.x) / scale.x, (y - h - origin.y) / scale.y, 0.f);
+		vec3_set(&corners[1], (x + w - origin.x) / scale.x, (y - h - origin.y) / scale.y, 0.f);
+		vec3_set(&corners[2], (x - w - origin.x) / scale.x, (y + h - origin.y) / scale.y, 0.f);
+		vec3_set(&corners[3], (x + w - origin.x) / scale.x, (y + h - origin.y) / scale.y, 0.f);
+
+		for (const auto& placement : placements) {
+			// Rotated items don't map to a rectangle, so use the bounds of all four corners.
+			vec3 point;
+			vec3_transform(&point, &corners[0], &placement);
+			::streamfx::util::roi::region region{point.x, point.y, point.x, point.y};
+			for (std::size_t idx = 1; idx < 4; idx++) {
+				vec3_transform(&point, &corners[idx], &placement);
+				region.left   = std::min(region.left, point.x);
+				region.top    = std::min(region.top, point.y);
+				region.right  = std::max(region.right, point.x);
+				region.bottom = std::max(region.bottom, point.y);
+			}
+
+			region.left   = std::clamp(region.left / static_cast<float>(ovi.base_width), 0.f, 1.f);
+			region.top    = std::clamp(region.top / static_cast<float>(ovi.base_height), 0.f, 1.f);
+			region.right  = std::clamp(region.right / static_cast<float>(ovi.base_width), 0.f, 1.f);
+			region.bottom = std::clamp(region.bottom / static_cast<float>(ovi.base_height), 0.f, 1.f);
+			if ((region.right > region.left) && (region.bottom > region.top)) { // Anything off-canvas is gone.
+				regions.push_back(region);
+			}
 		}
 	}
+
+	::streamfx::util::roi::registry::instance()->publish(obs_get_video(), this, std::move(regions));
 }
 
 void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float seconds)
@@ -810,6 +1142,93 @@ void streamfx::filter::autoframing::autoframing_instance::tracking_tick(float se
 	_track_frequency_counter += seconds;
 }
 
+bool streamfx::filter::autoframing::autoframing_instance::detect(detection_cache::elements_t& elements, uint32_t width, uint32_t height, bool& captured)
+{
+	// Capture the entire input once, the framed region is later resampled from the same copy.
+	captured = capture(_full, width, height, vec4{0, 0, static_cast<float>(width), static_cast<float>(height)});
+	if (!captured) {
+		return false;
+	}
+	resample(_full->get_texture(), _detect, _detect_size.first, _detect_size.second, vec4{0, 0, static_cast<float>(width), static_cast<float>(height)});
+
+	std::unique_lock<std::mutex> ul(_provider_lock);
+	switch (_provider) {
+#ifdef ENABLE_FILTER_DENOISING_NVIDIA
+	case tracking_provider::NVIDIA_FACEDETECTION:
+		return nvar_facedetection_process(elements);
+#endif
+	default:
+		return false;
+	}
+}
+
+void streamfx::filter::autoframing::autoframing_instance::track(const detection_cache::elements_t& elements)
+{
+	// Frames may not move more than this distance.
+	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
+	max_dst *= 1.f / (1.f - _track_frequency); // Fine-tune this?
+
+	// Merge detected faces with the tracked elements.
+	for (const auto& element : elements) {
+		// Skip elements that have not enough confidence of being a face.
+		// TODO: Make the threshold configurable.
+		if (element.confidence < .5) {
+			continue;
+		}
+		const vec4& rect = element.rect;
+
+		// Calculate centered position.
+		vec2 pos;
+		pos.x = rect.x + (rect.z / 2.f);
+		pos.y = rect.y + (rect.w / 2.f);
+
+		// Try and find a match in the current list of tracked elements.
+		std::shared_ptr<track_el> match;
+		float                     match_dst = max_dst;
+		for (const auto& el : _tracked_elements) {
+			// Skip "fresh" elements.
+			if (el->age < 0.00001) {
+				continue;
+			}
+
+			// Check if the distance is within acceptable bounds.
+			float dst = vec2_dist(&pos, &el->pos);
+			if ((dst < match_dst) && (dst < max_dst)) {
+				match_dst = dst;
+				match     = el;
+			}
+		}
+
+		// Do we have a match?
+		if (!match) {
+			// No, so create a new one.
+			match = std::make_shared<track_el>();
+
+			// Insert it.
+			_tracked_elements.push_back(match);
+
+			// Update information.
+			vec2_copy(&match->pos, &pos);
+			vec2_set(&match->size, rect.z, rect.w);
+			vec2_set(&match->vel, 0., 0.);
+			match->age = 0.;
+		} else {
+			// Reset the age to 0.
+			match->age = 0.;
+
+			// Calculate the velocity between changes.
+			vec2 vel;
+			vec2_sub(&vel, &pos, &match->pos);
+
+			// Update information.
+			vec2_copy(&match->pos, &pos);
+			vec2_set(&match->size, rect.z, rect.w);
+			vec2_copy(&match->vel, &vel);
+			match->age = 0.;
+		}
+	}
+}
+
 struct switch_provider_data_t {
 	tracking_provider provider;
 };
@@ -905,82 +1324,29 @@ void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_unl
 	_nvidia_fx.reset();
 }
 
-void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_process()
+bool streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_process(detection_cache::elements_t& elements)
 {
 	if (!_nvidia_fx) {
-		return;
+		return false;
 	}
 
-	// Frames may not move more than this distance.
-	float max_dst = sqrtf(static_cast<float>(_size.first * _size.first) + static_cast<float>(_size.second * _size.second)) * 0.667f;
-	max_dst *= 1.f / (1.f - _track_frequency); // Fine-tune this?
-
 	// Process the current frame (if requested).
-	_nvidia_fx->process(_input->get_texture());
-
-	// If there are tracked faces, merge them with the tracked elements.
-	if (auto edx = _nvidia_fx->count(); edx > 0) {
-		for (size_t idx = 0; idx < edx; idx++) {
-			float confidence = 0.;
-			auto  rect       = _nvidia_fx->at(idx, confidence);
-
-			// Skip elements that have not enough confidence of being a face.
-			// TODO: Make the threshold configurable.
-			if (confidence < .5) {
-				continue;
-			}
-
-			// Calculate centered position.
-			vec2 pos;
-			pos.x = rect.x + (rect.z / 2.f);
-			pos.y = rect.y + (rect.w / 2.f);
-
-			// Try and find a match in the current list of tracked elements.
-			std::shared_ptr<track_el> match;
-			float                     match_dst = max_dst;
-			for (const auto& el : _tracked_elements) {
-				// Skip "fresh" elements.
-				if (el->age < 0.00001) {
-					continue;
-				}
-
-				// Check if the distance is within acceptable bounds.
-				float dst = vec2_dist(&pos, &el->pos);
-				if ((dst < match_dst) && (dst < max_dst)) {
-					match_dst = dst;
-					match     = el;
-				}
-			}
-
-			// Do we have a match?
-			if (!match) {
-				// No, so create a new one.
-				match = std::make_shared<track_el>();
-
-				// Insert it.
-				_tracked_elements.push_back(match);
-
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_set(&match->vel, 0., 0.);
-				match->age = 0.;
-			} else {
-				// Reset the age to 0.
-				match->age = 0.;
-
-				// Calculate the velocity between changes.
-				vec2 vel;
-				vec2_sub(&vel, &pos, &match->pos);
-
-				// Update information.
-				vec2_copy(&match->pos, &pos);
-				vec2_set(&match->size, rect.z, rect.w);
-				vec2_copy(&match->vel, &vel);
-				match->age = 0.;
-			}
-		}
+	_nvidia_fx->process(_detect->get_texture());
+
+	// Detection happened on a downscaled copy, scale results back up to input size.
+	float scale_x = static_cast<float>(_size.first) / static_cast<float>(_detect_size.first);
+	float scale_y = static_cast<float>(_size.second) / static_cast<float>(_detect_size.second);
+
+	for (size_t idx = 0, edx = _nvidia_fx->count(); idx < edx; idx++) {
+		detection_cache::element element;
+		element.rect = _nvidia_fx->at(idx, element.confidence);
+		element.rect.x *= scale_x;
+		element.rect.y *= scale_y;
+		element.rect.z *= scale_x;
+		element.rect.w *= scale_y;
+		elements.push_back(element);
 	}
+	return true;
 }
 
 void streamfx::filter::autoframing::autoframing_instance::nvar_facedetection_properties(obs_properties_t* props) {}
@@ -1062,6 +1428,7 @@ void autoframing_factory::get_defaults2(obs_data_t* data)
 	// Tracking
 	obs_data_set_default_int(data, ST_KEY_TRACKING_MODE, static_cast<int64_t>(tracking_mode::SOLO));
 	obs_data_set_default_string(data, ST_KEY_TRACKING_FREQUENCY, "20 Hz");
+	obs_data_set_default_bool(data, ST_KEY_TRACKING_REGIONOFINTEREST, false);
 
 	// Motion
 	obs_data_set_default_double(data, ST_KEY_MOTION_SMOOTHING, 33.333);
@@ -1117,6 +1484,10 @@ obs_properties_t* autoframing_factory::get_properties2(autoframing_instance* dat
 		{
 			auto p = obs_properties_add_text(grp, ST_KEY_TRACKING_FREQUENCY, D_TRANSLATE(ST_I18N_TRACKING_FREQUENCY), OBS_TEXT_DEFAULT);
 		}
+
+		{
+			auto p = obs_properties_add_bool(grp, ST_KEY_TRACKING_REGIONOFINTEREST, D_TRANSLATE(ST_I18N_TRACKING_REGIONOFINTEREST));
+		}
 	}
 
 	{
@@ -6,17 +6,22 @@
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
-#include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 #include "plugin.hpp"
+#include "util/util-roi.hpp"
 #include "util/util-threadpool.hpp"
 #include "util/utility.hpp"
 
 #include "warning-disable.hpp"
 #include <atomic>
+#include <functional>
+#include <future>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 #include "warning-enable.hpp"
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
@@ -40,6 +45,63 @@ namespace streamfx::filter::autoframing {
 
 	std::string string(tracking_provider provider);
 
+	/** Detection results shared by all instances that look at the same frame.
+	 *
+	 * Framing one camera several times over, for example through multiple
+	 *  mirrors of it, would otherwise run the provider on identical input once
+	 *  per instance. Only results for the current frame are kept.
+	 */
+	class detection_cache {
+		public:
+		struct key {
+			obs_source_t*                 origin; // Only used for identity, never dereferenced.
+			uint64_t                      frame;
+			std::pair<uint32_t, uint32_t> size;
+			tracking_provider             provider;
+			tracking_mode                 mode;
+
+			bool operator<(const key& rhs) const;
+		};
+
+		struct element {
+			vec4  rect; // Position and size in input coordinates.
+			float confidence;
+		};
+		typedef std::vector<element> elements_t;
+
+		private:
+		struct entry {
+			std::shared_future<std::shared_ptr<const elements_t>> result;
+			std::thread::id                                        detector;
+		};
+
+		std::mutex           _lock;
+		uint64_t             _frame;
+		std::map<key, entry> _entries;
+
+		public:
+		~detection_cache();
+		detection_cache();
+
+		/** Retrieve the results for a frame, running detect only if nobody else did yet.
+		 *
+		 * Detection runs outside of the lock. Requests for the same key made meanwhile wait for it, requests for
+		 *  other keys don't.
+		 *
+		 * @return nullptr if detection failed.
+		 */
+		std::shared_ptr<const elements_t> get(const key& key, std::function<bool(elements_t&)> detect);
+
+		/** Find the source whose output a filter sees as its input.
+		 *
+		 * Sources that only show a single other source unchanged at the same size are looked through.
+		 */
+		static obs_source_t* find_origin(obs_source_t* filter);
+
+		public: // Singleton
+		static std::shared_ptr<detection_cache> instance();
+	};
+
 	class autoframing_instance : public obs::source_instance {
 		struct track_el {
 			float age;
@@ -69,17 +131,20 @@ namespace streamfx::filter::autoframing {
 		bool                          _dirty;
 		std::pair<uint32_t, uint32_t> _size;
 		std::pair<uint32_t, uint32_t> _out_size;
+		std::pair<uint32_t, uint32_t> _detect_size;
 
-		std::shared_ptr<::streamfx::gfx::util>              _gfx_debug;
-		std::shared_ptr<::streamfx::obs::gs::effect>        _standard_effect;
-		std::shared_ptr<::streamfx::obs::gs::rendertarget>  _input;
-		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _vb;
+		std::shared_ptr<::streamfx::gfx::util>             _gfx_debug;
+		std::shared_ptr<::streamfx::obs::gs::effect>       _standard_effect;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _input;  // Framed region only, at output size.
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _detect; // Entire input, downscaled for the provider.
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _full;   // Entire input, only captured on detection frames.
 
 		tracking_provider                       _provider;
 		tracking_provider                       _provider_ui;
 		std::atomic<bool>                       _provider_ready;
 		std::mutex                              _provider_lock;
 		std::shared_ptr<util::threadpool::task> _provider_task;
+		std::shared_ptr<detection_cache>        _cache;
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::ar::facedetection> _nvidia_fx;
@@ -87,6 +152,7 @@ namespace streamfx::filter::autoframing {
 
 		tracking_mode _track_mode;
 		float         _track_frequency;
+		bool          _track_roi;
 
 		float _motion_smoothing;
 		float _motion_smoothing_kalman_pnc;
@@ -130,15 +196,24 @@ namespace streamfx::filter::autoframing {
 		virtual void video_render(gs_effect_t* effect) override;
 
 		private:
+		bool capture(std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height, const vec4& region);
+		void resample(std::shared_ptr<::streamfx::obs::gs::texture> source, std::shared_ptr<::streamfx::obs::gs::rendertarget> target, uint32_t width, uint32_t height, const vec4& region);
+
 		void tracking_tick(float seconds);
 
+		void publish_regions();
+
+		bool detect(detection_cache::elements_t& elements, uint32_t width, uint32_t height, bool& captured);
+
+		void track(const detection_cache::elements_t& elements);
+
 		void switch_provider(tracking_provider provider);
 		void task_switch_provider(util::threadpool::task_data_t data);
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		void nvar_facedetection_load();
 		void nvar_facedetection_unload();
-		void nvar_facedetection_process();
+		bool nvar_facedetection_process(detection_cache::elements_t& elements);
 		void nvar_facedetection_properties(obs_properties_t* props);
 		void nvar_facedetection_update(obs_data_t* data);
 #endif
@@ -4,12 +4,15 @@
 
 #include "filter-blur.hpp"
 #include "strings.hpp"
+#include "gfx/blur/gfx-blur-bokeh.hpp"
 #include "gfx/blur/gfx-blur-box-linear.hpp"
 #include "gfx/blur/gfx-blur-box.hpp"
 #include "gfx/blur/gfx-blur-dual-filtering.hpp"
 #include "gfx/blur/gfx-blur-gaussian-linear.hpp"
 #include "gfx/blur/gfx-blur-gaussian.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-ledger.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "util/util-logging.hpp"
 
@@ -111,7 +114,7 @@ struct local_blur_subtype_t {
 };
 
 static std::map<std::string, local_blur_type_t> list_of_types = {
-	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}},
+	{"box", {&::streamfx::gfx::blur::box_factory::get, S_BLUR_TYPE_BOX}}, {"box_linear", {&::streamfx::gfx::blur::box_linear_factory::get, S_BLUR_TYPE_BOX_LINEAR}}, {"gaussian", {&::streamfx::gfx::blur::gaussian_factory::get, S_BLUR_TYPE_GAUSSIAN}}, {"gaussian_linear", {&::streamfx::gfx::blur::gaussian_linear_factory::get, S_BLUR_TYPE_GAUSSIAN_LINEAR}}, {"dual_filtering", {&::streamfx::gfx::blur::dual_filtering_factory::get, S_BLUR_TYPE_DUALFILTERING}}, {"bokeh", {&::streamfx::gfx::blur::bokeh_factory::get, S_BLUR_TYPE_BOKEH}},
 };
 static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"area", {::streamfx::gfx::blur::type::Area, S_BLUR_SUBTYPE_AREA}},
@@ -120,7 +123,7 @@ static std::map<std::string, local_blur_subtype_t> list_of_subtypes = {
 	{"zoom", {::streamfx::gfx::blur::type::Zoom, S_BLUR_SUBTYPE_ZOOM}},
 };
 
-blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _output_rendered(false)
+blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::source_instance(settings, self), _gfx_util(::streamfx::gfx::util::get()), _source_rendered(false), _output_rendered(false), _output_cached(false)
 {
 	{
 		auto gctx = streamfx::obs::gs::context();
@@ -140,10 +143,24 @@ blur_instance::blur_instance(obs_data_t* settings, obs_source_t* self) : obs::so
 		}
 	}
 
+	// Intermediate targets are recreated on the next frame.
+	streamfx::obs::gs::ledger::instance()->set_evictor(self, [this]() {
+		auto gctx        = streamfx::obs::gs::context();
+		_source_rt       = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_output_rt       = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		_source_texture  = nullptr;
+		_output_texture  = nullptr;
+		_source_rendered = false;
+		_output_rendered = false;
+	});
+
 	update(settings);
 }
 
-blur_instance::~blur_instance() {}
+blur_instance::~blur_instance()
+{
+	streamfx::obs::gs::ledger::instance()->remove_owner(_self.get());
+}
 
 bool blur_instance::apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture)
 {
@@ -359,8 +376,11 @@ void blur_instance::video_tick(float)
 		}
 	}
 
-	_source_rendered = false;
-	_output_rendered = false;
+	// Keep the last output if the watchdog asked for it.
+	if (!_output_cached || !_output_texture) {
+		_source_rendered = false;
+		_output_rendered = false;
+	}
 }
 
 void blur_instance::video_render(gs_effect_t* effect)
@@ -381,6 +401,9 @@ void blur_instance::video_render(gs_effect_t* effect)
 	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Blur '%s'", obs_source_get_name(_self)};
 #endif
 
+	// Cache, blur and mask passes share their state, so most of it only needs to be set once.
+	streamfx::obs::gs::renderstate::session session;
+
 	if (!_source_rendered) {
 		// Source To Texture
 		{
@@ -389,24 +412,12 @@ void blur_instance::video_render(gs_effect_t* effect)
 #endif
 
 			if (obs_source_process_filter_begin(this->_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-				{
-					auto op = this->_source_rt->render(baseW, baseH);
-
-					gs_blend_state_push();
-					gs_reset_blend_state();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-					gs_set_cull_mode(GS_NEITHER);
-					gs_enable_color(true, true, true, true);
+				// The source rendered above this may have changed any state.
+				streamfx::obs::gs::renderstate::invalidate();
 
-					gs_enable_depth_test(false);
-					gs_depth_function(GS_ALWAYS);
-
-					gs_enable_stencil_test(false);
-					gs_enable_stencil_write(false);
-					gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-					gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+				{
+					auto op    = this->_source_rt->render(baseW, baseH);
+					auto state = streamfx::obs::gs::renderstate::overwrite().apply();
 
 					// Orthographic Camera and clear RenderTarget.
 					gs_ortho(0, static_cast<float>(baseW), 0, static_cast<float>(baseH), -1., 1.);
@@ -414,8 +425,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 					// Render
 					obs_source_process_filter_end(this->_self, defaultEffect, baseW, baseH);
-
-					gs_blend_state_pop();
+					streamfx::obs::gs::renderstate::invalidate();
 				}
 
 				_source_texture = this->_source_rt->get_texture();
@@ -448,19 +458,6 @@ void blur_instance::video_render(gs_effect_t* effect)
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mask"};
 #endif
 
-			gs_blend_state_push();
-			gs_reset_blend_state();
-			gs_enable_color(true, true, true, true);
-			gs_enable_blending(false);
-			gs_enable_depth_test(false);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
-			gs_set_cull_mode(GS_NEITHER);
-			gs_depth_function(GS_ALWAYS);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-			gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
-
 			std::string technique = "";
 			switch (this->_mask.type) {
 			case mask_type::Region:
@@ -507,12 +504,14 @@ void blur_instance::video_render(gs_effect_t* effect)
 #endif
 
 				this->_mask.source.texture = this->_mask.source.source_texture->render(source_width, source_height);
+				streamfx::obs::gs::renderstate::invalidate();
 			}
 
 			apply_mask_parameters(_effect_mask, _source_texture->get_object(), _output_texture->get_object());
 
 			try {
-				auto op = this->_output_rt->render(baseW, baseH);
+				auto op    = this->_output_rt->render(baseW, baseH);
+				auto state = streamfx::obs::gs::renderstate::overwrite().apply();
 				gs_ortho(0, 1, 0, 1, -1, 1);
 
 				// Render
@@ -520,11 +519,9 @@ void blur_instance::video_render(gs_effect_t* effect)
 					_gfx_util->draw_fullscreen_triangle();
 				}
 			} catch (const std::exception&) {
-				gs_blend_state_pop();
 				obs_source_skip_video_filter(this->_self);
 				return;
 			}
-			gs_blend_state_pop();
 
 			if (!(_output_texture = this->_output_rt->get_texture())) {
 				obs_source_skip_video_filter(this->_self);
@@ -568,6 +565,22 @@ void blur_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+bool blur_instance::degrade(::streamfx::obs::degradation level)
+{
+	switch (level) {
+	case ::streamfx::obs::degradation::None:
+		_output_cached = false;
+		return true;
+	case ::streamfx::obs::degradation::Cached:
+		_output_cached = true;
+		return true;
+	case ::streamfx::obs::degradation::Bypass:
+		return true;
+	default:
+		return false;
+	}
+}
+
 blur_factory::blur_factory()
 {
 	_info.id           = S_PREFIX "filter-blur";
@@ -759,6 +772,7 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN), "gaussian");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_GAUSSIAN_LINEAR), "gaussian_linear");
 		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_DUALFILTERING), "dual_filtering");
+		obs_property_list_add_string(p, D_TRANSLATE(S_BLUR_TYPE_BOKEH), "bokeh");
 
 		p = obs_properties_add_list(pr, ST_KEY_SUBTYPE, D_TRANSLATE(ST_I18N_SUBTYPE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
 		obs_property_set_modified_callback2(p, modified_properties, this);
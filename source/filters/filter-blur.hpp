@@ -41,6 +41,7 @@ namespace streamfx::filter::blur {
 		std::shared_ptr<streamfx::obs::gs::texture>      _output_texture;
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _output_rt;
 		bool                                             _output_rendered;
+		bool                                             _output_cached;
 
 		// Blur
 		std::shared_ptr<::streamfx::gfx::blur::base> _blur;
@@ -96,6 +97,8 @@ namespace streamfx::filter::blur {
 		virtual void video_tick(float_t time) override;
 		virtual void video_render(gs_effect_t* effect) override;
 
+		virtual bool degrade(::streamfx::obs::degradation level) override;
+
 		private:
 		bool apply_mask_parameters(streamfx::obs::gs::effect effect, gs_texture_t* original_texture, gs_texture_t* blurred_texture);
 	};
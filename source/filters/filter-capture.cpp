@@ -0,0 +1,392 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "filter-capture.hpp"
+#include "strings.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<filter::capture> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_I18N "Filter.Capture"
+#define ST_I18N_PATH ST_I18N ".Path"
+#define ST_KEY_PATH "Path"
+#define ST_I18N_DURATION ST_I18N ".Duration"
+#define ST_KEY_DURATION "Duration"
+#define ST_I18N_RECORD ST_I18N ".Record"
+#define ST_KEY_RECORD "Record"
+
+using namespace streamfx::filter::capture;
+
+// Frames waiting to be written before new ones are dropped, so that a slow disk can't eat all memory.
+static constexpr std::size_t queue_limit = 60;
+
+// Depth of the read back ring.
+static constexpr std::size_t slot_count = 2;
+
+capture_instance::capture_instance(obs_data_t* data, obs_source_t* self)
+	: obs::source_instance(data, self), _path(), _duration(5.f), _toggle(false), _session(), _task(), _remaining(0), _seconds(0), _slots(slot_count), _slot(0)
+{
+	{
+		auto gctx = obs::gs::context();
+		_rt       = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+
+	update(data);
+}
+
+capture_instance::~capture_instance()
+{
+	if (_session) {
+		stop();
+	}
+
+	auto gctx = obs::gs::context();
+	_slots.clear();
+	_rt.reset();
+}
+
+void capture_instance::load(obs_data_t* settings)
+{
+	update(settings);
+}
+
+void capture_instance::migrate(obs_data_t* data, uint64_t version) {}
+
+void capture_instance::update(obs_data_t* data)
+{
+	_path     = obs_data_get_string(data, ST_KEY_PATH);
+	_duration = static_cast<float>(obs_data_get_double(data, ST_KEY_DURATION));
+}
+
+void capture_instance::video_tick(float seconds)
+{
+	_seconds = seconds;
+
+	if (_toggle.exchange(false)) {
+		try {
+			if (_session) {
+				stop();
+			} else {
+				start();
+			}
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Failed to start recording to '%s': %s", _path.c_str(), ex.what());
+		}
+	} else if (_session) {
+		_remaining -= seconds;
+		if (_remaining <= 0.f) {
+			stop();
+		}
+	}
+}
+
+void capture_instance::video_render(gs_effect_t* effect)
+{
+	obs_source_t* parent         = obs_filter_get_parent(_self);
+	obs_source_t* target         = obs_filter_get_target(_self);
+	uint32_t      width          = obs_source_get_base_width(target);
+	uint32_t      height         = obs_source_get_base_height(target);
+	gs_effect_t*  default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+	// Not recording, so stay out of the way entirely.
+	if (!_session || !parent || !target || !width || !height) {
+		obs_source_skip_video_filter(_self);
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Benchmark Capture '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(parent)};
+#endif
+
+	// The slot we are about to reuse holds the oldest frame, which is ready by now.
+	_slot = (_slot + 1) % _slots.size();
+	read_back(_slots[_slot]);
+
+	{
+		auto op = _rt->render(width, height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1, 1);
+
+		vec4 clear_color = {0, 0, 0, 0};
+		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &clear_color, 0, 0);
+
+		if (obs_source_process_filter_begin(_self, GS_RGBA, OBS_NO_DIRECT_RENDERING)) {
+			gs_blend_state_push();
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+			gs_enable_depth_test(false);
+			gs_enable_stencil_test(false);
+			gs_enable_color(true, true, true, true);
+			gs_set_cull_mode(GS_NEITHER);
+
+			obs_source_process_filter_end(_self, default_effect, width, height);
+
+			gs_blend_state_pop();
+		} else {
+			obs_source_skip_video_filter(_self);
+			return;
+		}
+	}
+
+	auto texture = _rt->get_texture();
+	if (!texture) {
+		obs_source_skip_video_filter(_self);
+		return;
+	}
+
+	auto& slot = _slots[_slot];
+	if (!slot.stage || (slot.width != width) || (slot.height != height)) {
+		gs_stagesurf_t* stage = gs_stagesurface_create(width, height, GS_RGBA);
+		if (!stage) {
+			D_LOG_ERROR("Failed to create staging surface.", nullptr);
+			obs_source_skip_video_filter(_self);
+			return;
+		}
+		slot.stage  = std::shared_ptr<gs_stagesurf_t>(stage, [](gs_stagesurf_t* v) { gs_stagesurface_destroy(v); });
+		slot.width  = width;
+		slot.height = height;
+	}
+	gs_stage_texture(slot.stage.get(), texture->get_object());
+	slot.timestamp = obs_get_video_frame_time();
+	slot.seconds   = _seconds;
+	slot.pending   = true;
+
+	// Pass the input on unchanged.
+	gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), texture->get_object());
+	while (gs_effect_loop(default_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, width, height);
+	}
+}
+
+void capture_instance::toggle()
+{
+	_toggle = true;
+}
+
+void capture_instance::start()
+{
+	if (_path.empty()) {
+		throw std::runtime_error("No file selected.");
+	}
+
+	streamfx::util::capture::header header;
+	obs_source_t*                   target = obs_filter_get_target(_self);
+	header.width                           = target ? obs_source_get_base_width(target) : 0;
+	header.height                          = target ? obs_source_get_base_height(target) : 0;
+	header.fps_num                         = 0;
+	header.fps_den                         = 1;
+	if (obs_video_info ovi; obs_get_video_info(&ovi)) {
+		header.fps_num = ovi.fps_num;
+		header.fps_den = ovi.fps_den;
+	}
+	header.chain = save_chain();
+
+	auto s    = std::make_shared<session>();
+	s->writer = std::make_unique<streamfx::util::capture::writer>(std::filesystem::u8path(_path), header);
+	s->path   = _path;
+	s->queued = s->written = s->dropped = 0;
+
+	for (auto& slot : _slots) {
+		slot.pending = false;
+	}
+	_session   = s;
+	_task      = nullptr;
+	_remaining = _duration;
+
+	D_LOG_INFO("Recording '%s' to '%s' for %.1f seconds.", obs_source_get_name(obs_filter_get_parent(_self)), _path.c_str(), static_cast<double>(_duration));
+}
+
+void capture_instance::stop()
+{
+	{ // Collect the frames still in flight, oldest first.
+		auto gctx = obs::gs::context();
+		for (std::size_t idx = 1; idx <= _slots.size(); idx++) {
+			read_back(_slots[(_slot + idx) % _slots.size()]);
+		}
+	}
+
+	// Close the file once everything before has been written.
+	auto s = _session;
+	streamfx::threadpool()->push_after(_task, [s](streamfx::util::threadpool::task_data_t) {
+		s->writer.reset();
+		D_LOG_INFO("Recorded %zu frames to '%s', dropped %zu.", s->written.load(), s->path.c_str(), s->dropped.load());
+	});
+
+	_session.reset();
+	_task.reset();
+}
+
+std::string capture_instance::save_chain()
+{
+	struct enum_data {
+		obs_source_t*     self;
+		bool              after;
+		obs_data_array_t* filters;
+	} ed{_self.get(), false, obs_data_array_create()};
+
+	// Filters are enumerated in the order they are applied in.
+	obs_source_enum_filters(
+		obs_filter_get_parent(_self),
+		[](obs_source_t*, obs_source_t* child, void* param) {
+			auto ed = reinterpret_cast<enum_data*>(param);
+			if (child == ed->self) {
+				ed->after = true;
+			} else if (ed->after) {
+				obs_data_t* data = obs_save_source(child);
+				obs_data_array_push_back(ed->filters, data);
+				obs_data_release(data);
+			}
+		},
+		&ed);
+
+	auto root = std::shared_ptr<obs_data_t>(obs_data_create(), obs::obs_data_deleter);
+	obs_data_set_array(root.get(), "filters", ed.filters);
+	obs_data_array_release(ed.filters);
+
+	return obs_data_get_json(root.get());
+}
+
+void capture_instance::read_back(slot& slot)
+{
+	if (!slot.pending) {
+		return;
+	}
+	slot.pending = false;
+
+	if (_session->queued >= queue_limit) {
+		_session->dropped++;
+		return;
+	}
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (!gs_stagesurface_map(slot.stage.get(), &data, &linesize)) {
+		D_LOG_ERROR("Failed to map staging surface.", nullptr);
+		_session->dropped++;
+		return;
+	}
+
+	auto frame       = std::make_shared<streamfx::util::capture::frame>();
+	frame->timestamp = slot.timestamp;
+	frame->seconds   = slot.seconds;
+	frame->width     = slot.width;
+	frame->height    = slot.height;
+	frame->data.resize(static_cast<std::size_t>(slot.width) * slot.height * 4);
+
+	std::size_t row_size = static_cast<std::size_t>(slot.width) * 4;
+	for (uint32_t y = 0; y < slot.height; y++) {
+		std::memcpy(frame->data.data() + (row_size * y), data + (static_cast<std::size_t>(linesize) * y), row_size);
+	}
+	gs_stagesurface_unmap(slot.stage.get());
+
+	// Writes have to happen in order, so each one waits for the previous.
+	auto s = _session;
+	s->queued++;
+	_task = streamfx::threadpool()->push_after(
+		_task,
+		[s](streamfx::util::threadpool::task_data_t data) {
+			try {
+				s->writer->write(*std::static_pointer_cast<streamfx::util::capture::frame>(data));
+				s->written++;
+			} catch (const std::exception& ex) {
+				D_LOG_ERROR("Failed to write frame to '%s': %s", s->path.c_str(), ex.what());
+			}
+			s->queued--;
+		},
+		frame);
+}
+
+capture_factory::capture_factory()
+{
+	_info.id           = S_PREFIX "filter-capture";
+	_info.type         = OBS_SOURCE_TYPE_FILTER;
+	_info.output_flags = OBS_SOURCE_VIDEO;
+
+	support_size(false);
+	finish_setup();
+}
+
+capture_factory::~capture_factory() {}
+
+const char* capture_factory::get_name()
+{
+	return D_TRANSLATE(ST_I18N);
+}
+
+void capture_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_string(data, ST_KEY_PATH, "");
+	obs_data_set_default_double(data, ST_KEY_DURATION, 5.0);
+}
+
+obs_properties_t* capture_factory::get_properties2(capture_instance* data)
+{
+	obs_properties_t* pr = obs_properties_create();
+
+	{
+		obs_properties_add_path(pr, ST_KEY_PATH, D_TRANSLATE(ST_I18N_PATH), OBS_PATH_FILE_SAVE, "StreamFX Capture (*.sfxc)", nullptr);
+	}
+	{
+		auto p = obs_properties_add_float_slider(pr, ST_KEY_DURATION, D_TRANSLATE(ST_I18N_DURATION), 1.0, 60.0, 0.5);
+		obs_property_float_set_suffix(p, " s");
+	}
+	{
+		obs_properties_add_button2(pr, ST_KEY_RECORD, D_TRANSLATE(ST_I18N_RECORD), on_record, data);
+	}
+
+	return pr;
+}
+
+bool capture_factory::on_record(obs_properties_t* props, obs_property_t* property, void* data)
+{
+	if (data) {
+		reinterpret_cast<capture_instance*>(data)->toggle();
+	}
+	return false;
+}
+
+std::shared_ptr<capture_factory> capture_factory::instance()
+{
+	static std::weak_ptr<capture_factory> winst;
+	static std::mutex                     mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<capture_factory>(new capture_factory());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<capture_factory> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = capture_factory::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::NORMAL);
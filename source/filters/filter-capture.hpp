@@ -0,0 +1,99 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/obs-source-factory.hpp"
+#include "util/util-capture-file.hpp"
+#include "util/util-threadpool.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::filter::capture {
+	/** Records the input of a filter chain, together with the filters after it, for replay.
+	 */
+	class capture_instance : public obs::source_instance {
+		// Shared with the tasks writing to the file, which may outlive us.
+		struct session {
+			std::unique_ptr<streamfx::util::capture::writer> writer;
+			std::string                                      path;
+			std::atomic<std::size_t>                         queued;
+			std::atomic<std::size_t>                         written;
+			std::atomic<std::size_t>                         dropped;
+		};
+
+		// Frames are read back a frame later, so that the GPU is never waited on.
+		struct slot {
+			std::shared_ptr<gs_stagesurf_t> stage;
+			uint32_t                        width;
+			uint32_t                        height;
+			uint64_t                        timestamp;
+			float                           seconds;
+			bool                            pending;
+		};
+
+		// Settings
+		std::string _path;
+		float       _duration;
+
+		// Recording
+		std::atomic<bool>                                 _toggle;
+		std::shared_ptr<session>                          _session;
+		std::shared_ptr<streamfx::util::threadpool::task> _task; // Last write, the next one waits for it.
+		float                                             _remaining;
+		float                                             _seconds;
+
+		// Rendering
+		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
+		std::vector<slot>                                _slots;
+		std::size_t                                      _slot;
+
+		public:
+		capture_instance(obs_data_t*, obs_source_t*);
+		virtual ~capture_instance() override;
+
+		virtual void load(obs_data_t* settings) override;
+		virtual void migrate(obs_data_t* data, uint64_t version) override;
+		virtual void update(obs_data_t*) override;
+
+		virtual void video_tick(float) override;
+		virtual void video_render(gs_effect_t*) override;
+
+		/** Start or stop recording with the next frame.
+		 */
+		void toggle();
+
+		private:
+		void start();
+
+		void stop();
+
+		std::string save_chain();
+
+		void read_back(slot& slot);
+	};
+
+	class capture_factory : public obs::source_factory<filter::capture::capture_factory, filter::capture::capture_instance> {
+		public:
+		capture_factory();
+		virtual ~capture_factory() override;
+
+		virtual const char* get_name() override;
+
+		virtual void get_defaults2(obs_data_t* data) override;
+
+		virtual obs_properties_t* get_properties2(filter::capture::capture_instance* data) override;
+
+		static bool on_record(obs_properties_t* props, obs_property_t* property, void* data);
+
+		public: // Singleton
+		static std::shared_ptr<capture_factory> instance();
+	};
+} // namespace streamfx::filter::capture
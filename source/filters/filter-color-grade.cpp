@@ -6,6 +6,7 @@
 #include "strings.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
@@ -113,7 +114,7 @@ static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-Stre
 
 color_grade_instance::~color_grade_instance() {}
 
-color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effect(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _ccache_rt(), _ccache_texture(), _ccache_fresh(false), _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_rt(), _lut_texture(), _cache_rt(), _cache_texture(), _cache_fresh(false)
+color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self) : obs::source_instance(data, self), _effects(), _effect(), _gfx_util(::streamfx::gfx::util::get()), _lift(), _gamma(), _gain(), _offset(), _tint_detection(), _tint_luma(), _tint_exponent(), _tint_low(), _tint_mid(), _tint_hig(), _correction(), _lut_enabled(true), _lut_depth(), _ccache_rt(), _ccache_texture(), _ccache_fresh(false), _lut_initialized(false), _lut_dirty(true), _lut_producer(), _lut_consumer(), _lut_rt(), _lut_texture(), _cache_rt(), _cache_texture(), _cache_fresh(false)
 {
 	{
 		auto gctx = streamfx::obs::gs::context();
@@ -121,11 +122,12 @@ color_grade_instance::color_grade_instance(obs_data_t* data, obs_source_t* self)
 		// Load the color grading effect.
 		{
 			auto file = streamfx::data_file_path("effects/color-grade.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (std::exception& ex) {
-				D_LOG_ERROR("Error loading '%s': %s", file.u8string().c_str(), ex.what());
-				throw;
+			// The generic variant decides everything at runtime, and is used if a permutation fails.
+			_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(file);
+			_effect  = _effects->get();
+			if (!_effect) {
+				D_LOG_ERROR("Error loading '%s'.", file.u8string().c_str());
+				throw std::runtime_error("Failed to load color grading effect.");
 			}
 		}
 
@@ -174,6 +176,9 @@ void color_grade_instance::migrate(obs_data_t* data, uint64_t version) {}
 
 void color_grade_instance::update(obs_data_t* data)
 {
+	// Variants that failed to compile are tried again with the new settings.
+	_effects->retry();
+
 	_lift.x         = static_cast<float_t>(obs_data_get_double(data, ST_KEY_LIFT_(ST_RED)) / 100.0);
 	_lift.y         = static_cast<float_t>(obs_data_get_double(data, ST_KEY_LIFT_(ST_GREEN)) / 100.0);
 	_lift.z         = static_cast<float_t>(obs_data_get_double(data, ST_KEY_LIFT_(ST_BLUE)) / 100.0);
@@ -226,6 +231,15 @@ void color_grade_instance::update(obs_data_t* data)
 
 void color_grade_instance::prepare_effect()
 {
+	// Use the variant that only contains the tint detection and mode that are in use.
+	_effect = _effects->get({
+		{"PERMUTATION_TINT_DETECTION", std::to_string(static_cast<int32_t>(_tint_detection))},
+		{"PERMUTATION_TINT_MODE", std::to_string(static_cast<int32_t>(_tint_luma))},
+	});
+	if (!_effect) {
+		_effect = _effects->get();
+	}
+
 	if (auto p = _effect.get_parameter("pLift"); p) {
 		p.set_float4(_lift);
 	}
@@ -283,6 +297,7 @@ void color_grade_instance::rebuild_lut()
 
 	// Generate a fresh LUT texture.
 	auto lut_texture = _lut_producer->produce(_lut_depth);
+	streamfx::obs::gs::renderstate::invalidate();
 
 	// Modify the LUT with our color grade.
 	if (lut_texture) {
@@ -305,17 +320,12 @@ void color_grade_instance::rebuild_lut()
 
 			// Set up graphics context.
 			gs_ortho(0, 1, 0, 1, 0, 1);
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_enable_color(true, true, true, true);
-			gs_enable_stencil_test(false);
-			gs_enable_stencil_write(false);
+			auto state = streamfx::obs::gs::renderstate::overwrite().apply();
 
+			streamfx::obs::gs::effect_permutations::measure measure{*_effects, _effect};
 			while (gs_effect_loop(_effect.get_object(), "Draw")) {
 				_gfx_util->draw_fullscreen_triangle();
 			}
-
-			gs_blend_state_pop();
 		}
 
 		_lut_rt->get_texture(_lut_texture);
@@ -358,6 +368,9 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 	// TODO: Optimize this once (https://github.com/obsproject/obs-studio/pull/4199) is merged.
 	// - We can skip the original capture and reduce the overall impact of this.
 
+	// All passes share their state, so most of it only needs to be set once.
+	streamfx::obs::gs::renderstate::session session;
+
 	// 1. Capture the filter/source rendered above this.
 	if (!_ccache_fresh || !_ccache_texture) {
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
@@ -372,34 +385,17 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 			auto op = _ccache_rt->render(width, height);
 			gs_ortho(0, static_cast<float_t>(width), 0, static_cast<float_t>(height), 0, 1);
 
-			// Blank out the input cache.
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
-
-			// Begin rendering the actual input source.
+			// Begin rendering the actual input source, which may change any state.
 			obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING);
+			streamfx::obs::gs::renderstate::invalidate();
 
-			// Enable all colors for rendering.
-			gs_enable_color(true, true, true, true);
-
-			// Prevent blending with existing content, even if it is cleared.
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-			// Disable depth testing.
-			gs_enable_depth_test(false);
-
-			// Disable stencil testing.
-			gs_enable_stencil_test(false);
-
-			// Disable culling.
-			gs_set_cull_mode(GS_NEITHER);
+			// Prevent blending with existing content, the draw covers all of it.
+			auto state = streamfx::obs::gs::renderstate::overwrite().apply();
+			state.clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
 
 			// End rendering the actual input source.
 			obs_source_process_filter_end(_self, obs_get_base_effect(OBS_EFFECT_DEFAULT), width, height);
-
-			// Restore original blend mode.
-			gs_blend_state_pop();
+			streamfx::obs::gs::renderstate::invalidate();
 		}
 
 		// Try and retrieve the input cache as a texture for later use.
@@ -436,34 +432,15 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 					auto op = _cache_rt->render(width, height);
 					gs_ortho(0, 1., 0, 1., 0, 1);
 
-					// Blank out the input cache.
-					gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
-
-					// Enable all colors for rendering.
-					gs_enable_color(true, true, true, true);
-
-					// Prevent blending with existing content, even if it is cleared.
-					gs_blend_state_push();
-					gs_enable_blending(false);
-					gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-					// Disable depth testing.
-					gs_enable_depth_test(false);
-
-					// Disable stencil testing.
-					gs_enable_stencil_test(false);
-
-					// Disable culling.
-					gs_set_cull_mode(GS_NEITHER);
+					// Prevent blending with existing content, the draw covers all of it.
+					auto state = streamfx::obs::gs::renderstate::overwrite().apply();
+					state.clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
 
 					auto effect = _lut_consumer->prepare(_lut_depth, _lut_texture);
 					effect->get_parameter("image").set_texture(_ccache_texture);
 					while (gs_effect_loop(effect->get_object(), "Draw")) {
 						_gfx_util->draw_fullscreen_triangle();
 					}
-
-					// Restore original blend mode.
-					gs_blend_state_pop();
 				}
 
 				// Try and retrieve the render cache as a texture.
@@ -495,34 +472,16 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 
 			prepare_effect();
 
-			// Blank out the input cache.
-			gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
-
-			// Enable all colors for rendering.
-			gs_enable_color(true, true, true, true);
-
-			// Prevent blending with existing content, even if it is cleared.
-			gs_blend_state_push();
-			gs_enable_blending(false);
-			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-			// Disable depth testing.
-			gs_enable_depth_test(false);
-
-			// Disable stencil testing.
-			gs_enable_stencil_test(false);
-
-			// Disable culling.
-			gs_set_cull_mode(GS_NEITHER);
+			// Prevent blending with existing content, the draw covers all of it.
+			auto state = streamfx::obs::gs::renderstate::overwrite().apply();
+			state.clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &blank, 0., 0);
 
 			// Render the effect.
 			_effect.get_parameter("image").set_texture(_ccache_texture);
+			streamfx::obs::gs::effect_permutations::measure measure{*_effects, _effect};
 			while (gs_effect_loop(_effect.get_object(), "Draw")) {
 				_gfx_util->draw_fullscreen_triangle();
 			}
-
-			// Restore original blend mode.
-			gs_blend_state_pop();
 		}
 
 		// Try and retrieve the render cache as a texture.
@@ -121,7 +121,6 @@ sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* s
 
 		std::pair<const char*, streamfx::obs::gs::effect&> load_arr[] = {
 			{"effects/sdf/sdf-producer.effect", _sdf_producer_effect},
-			{"effects/sdf/sdf-consumer.effect", _sdf_consumer_effect},
 		};
 		for (auto& kv : load_arr) {
 			auto file = streamfx::data_file_path(kv.first);
@@ -132,6 +131,13 @@ sdf_effects_instance::sdf_effects_instance(obs_data_t* settings, obs_source_t* s
 				throw;
 			}
 		}
+
+		// The consumer has a permutation per combination of enabled effects, which draws all of them in one pass.
+		_sdf_consumer_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(streamfx::data_file_path("effects/sdf/sdf-consumer.effect"));
+		_sdf_consumer_effect  = _sdf_consumer_effects->get();
+		if (!_sdf_consumer_effect) {
+			throw std::runtime_error("Failed to load SDF consumer effect.");
+		}
 	}
 
 	update(settings);
@@ -148,6 +154,9 @@ void sdf_effects_instance::migrate(obs_data_t* data, uint64_t version) {}
 
 void sdf_effects_instance::update(obs_data_t* data)
 {
+	// A permutation that failed to compile may have been a one-off, so give it another chance.
+	_sdf_consumer_effects->retry();
+
 	{
 		_outer_shadow = obs_data_get_bool(data, ST_KEY_SHADOW_OUTER) && (obs_data_get_double(data, ST_KEY_SHADOW_OUTER_ALPHA) >= std::numeric_limits<double_t>::epsilon());
 		{
@@ -428,77 +437,139 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 			auto op = _output_rt->render(baseW, baseH);
 			gs_ortho(0, 1, 0, 1, 0, 1);
 
+			// Draw the source and all enabled effects in a single pass, if there is a permutation for them.
+			streamfx::obs::gs::effect composite;
+			if (_outer_shadow || _inner_shadow || _outer_glow || _inner_glow || _outline) {
+				streamfx::obs::gs::effect::defines_t defines{{"PERMUTATION_COMPOSITE", "1"}};
+				std::pair<bool, const char*> layers[] = {
+					{_outer_shadow, "PERMUTATION_SHADOW_OUTER"}, {_inner_shadow, "PERMUTATION_SHADOW_INNER"}, {_outer_glow, "PERMUTATION_GLOW_OUTER"}, {_inner_glow, "PERMUTATION_GLOW_INNER"}, {_outline, "PERMUTATION_OUTLINE"},
+				};
+				for (auto& kv : layers) {
+					if (kv.first) {
+						defines.emplace(kv.second, "1");
+					}
+				}
+				composite = _sdf_consumer_effects->get(defines);
+				if (composite && !composite.has_technique("Composite")) {
+					composite = streamfx::obs::gs::effect();
+				}
+			}
+
 			gs_enable_blending(false);
 			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-			auto param = gs_effect_get_param_by_name(default_effect, "image");
-			if (param) {
-				gs_effect_set_texture(param, _output_texture->get_object());
-			}
-			while (gs_effect_loop(default_effect, "Draw")) {
-				_gfx_util->draw_fullscreen_triangle();
-			}
+			if (composite) {
+				composite.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+				composite.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+				composite.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+				if (_outer_shadow) {
+					composite.get_parameter("pShadowOuterColor").set_float4(_outer_shadow_color);
+					composite.get_parameter("pShadowOuterMin").set_float(_outer_shadow_range_min);
+					composite.get_parameter("pShadowOuterMax").set_float(_outer_shadow_range_max);
+					composite.get_parameter("pShadowOuterOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
+				}
+				if (_inner_shadow) {
+					composite.get_parameter("pShadowInnerColor").set_float4(_inner_shadow_color);
+					composite.get_parameter("pShadowInnerMin").set_float(_inner_shadow_range_min);
+					composite.get_parameter("pShadowInnerMax").set_float(_inner_shadow_range_max);
+					composite.get_parameter("pShadowInnerOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
+				}
+				if (_outer_glow) {
+					composite.get_parameter("pGlowOuterColor").set_float4(_outer_glow_color);
+					composite.get_parameter("pGlowOuterWidth").set_float(_outer_glow_width);
+					composite.get_parameter("pGlowOuterSharpness").set_float(_outer_glow_sharpness);
+					composite.get_parameter("pGlowOuterSharpnessInverse").set_float(_outer_glow_sharpness_inv);
+				}
+				if (_inner_glow) {
+					composite.get_parameter("pGlowInnerColor").set_float4(_inner_glow_color);
+					composite.get_parameter("pGlowInnerWidth").set_float(_inner_glow_width);
+					composite.get_parameter("pGlowInnerSharpness").set_float(_inner_glow_sharpness);
+					composite.get_parameter("pGlowInnerSharpnessInverse").set_float(_inner_glow_sharpness_inv);
+				}
+				if (_outline) {
+					composite.get_parameter("pOutlineColor").set_float4(_outline_color);
+					composite.get_parameter("pOutlineWidth").set_float(_outline_width);
+					composite.get_parameter("pOutlineOffset").set_float(_outline_offset);
+					composite.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
+					composite.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
+				}
 
-			gs_enable_blending(true);
-			gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_ONE);
-			if (_outer_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_outer_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_outer_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_outer_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowOuter")) {
+				streamfx::obs::gs::effect_permutations::measure measure{*_sdf_consumer_effects, composite};
+				while (gs_effect_loop(composite.get_object(), "Composite")) {
 					_gfx_util->draw_fullscreen_triangle();
 				}
-			}
-			if (_inner_shadow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_inner_shadow_color);
-				_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_inner_shadow_range_min);
-				_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_inner_shadow_range_max);
-				_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowInner")) {
-					_gfx_util->draw_fullscreen_triangle();
+			} else {
+				streamfx::obs::gs::effect_permutations::measure measure{*_sdf_consumer_effects, _sdf_consumer_effect};
+
+				auto param = gs_effect_get_param_by_name(default_effect, "image");
+				if (param) {
+					gs_effect_set_texture(param, _output_texture->get_object());
 				}
-			}
-			if (_outer_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_outer_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_outer_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_outer_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_outer_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowOuter")) {
+				while (gs_effect_loop(default_effect, "Draw")) {
 					_gfx_util->draw_fullscreen_triangle();
 				}
-			}
-			if (_inner_glow) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_inner_glow_color);
-				_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_inner_glow_width);
-				_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_inner_glow_sharpness);
-				_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_inner_glow_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowInner")) {
-					_gfx_util->draw_fullscreen_triangle();
+
+				gs_enable_blending(true);
+				gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_ONE);
+				if (_outer_shadow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_outer_shadow_color);
+					_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_outer_shadow_range_min);
+					_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_outer_shadow_range_max);
+					_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_outer_shadow_offset_x / float_t(baseW), _outer_shadow_offset_y / float_t(baseH));
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowOuter")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
 				}
-			}
-			if (_outline) {
-				_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
-				_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
-				_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
-				_sdf_consumer_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
-				_sdf_consumer_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
-				_sdf_consumer_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
-				_sdf_consumer_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
-				_sdf_consumer_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
-				while (gs_effect_loop(_sdf_consumer_effect.get_object(), "Outline")) {
-					_gfx_util->draw_fullscreen_triangle();
+				if (_inner_shadow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pShadowColor").set_float4(_inner_shadow_color);
+					_sdf_consumer_effect.get_parameter("pShadowMin").set_float(_inner_shadow_range_min);
+					_sdf_consumer_effect.get_parameter("pShadowMax").set_float(_inner_shadow_range_max);
+					_sdf_consumer_effect.get_parameter("pShadowOffset").set_float2(_inner_shadow_offset_x / float_t(baseW), _inner_shadow_offset_y / float_t(baseH));
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "ShadowInner")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_outer_glow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_outer_glow_color);
+					_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_outer_glow_width);
+					_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_outer_glow_sharpness);
+					_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_outer_glow_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowOuter")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_inner_glow) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pGlowColor").set_float4(_inner_glow_color);
+					_sdf_consumer_effect.get_parameter("pGlowWidth").set_float(_inner_glow_width);
+					_sdf_consumer_effect.get_parameter("pGlowSharpness").set_float(_inner_glow_sharpness);
+					_sdf_consumer_effect.get_parameter("pGlowSharpnessInverse").set_float(_inner_glow_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "GlowInner")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
+				}
+				if (_outline) {
+					_sdf_consumer_effect.get_parameter("pSDFTexture").set_texture(_sdf_texture);
+					_sdf_consumer_effect.get_parameter("pSDFThreshold").set_float(_sdf_threshold);
+					_sdf_consumer_effect.get_parameter("pImageTexture").set_texture(_source_texture->get_object());
+					_sdf_consumer_effect.get_parameter("pOutlineColor").set_float4(_outline_color);
+					_sdf_consumer_effect.get_parameter("pOutlineWidth").set_float(_outline_width);
+					_sdf_consumer_effect.get_parameter("pOutlineOffset").set_float(_outline_offset);
+					_sdf_consumer_effect.get_parameter("pOutlineSharpness").set_float(_outline_sharpness);
+					_sdf_consumer_effect.get_parameter("pOutlineSharpnessInverse").set_float(_outline_sharpness_inv);
+					while (gs_effect_loop(_sdf_consumer_effect.get_object(), "Outline")) {
+						_gfx_util->draw_fullscreen_triangle();
+					}
 				}
 			}
 		} catch (...) {
@@ -14,9 +14,10 @@
 
 namespace streamfx::filter::sdf_effects {
 	class sdf_effects_instance : public obs::source_instance {
-		streamfx::obs::gs::effect            _sdf_producer_effect;
-		streamfx::obs::gs::effect            _sdf_consumer_effect;
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+		streamfx::obs::gs::effect                                _sdf_producer_effect;
+		std::shared_ptr<streamfx::obs::gs::effect_permutations> _sdf_consumer_effects;
+		streamfx::obs::gs::effect                                _sdf_consumer_effect;
+		std::shared_ptr<streamfx::gfx::util>                     _gfx_util;
 
 		// Input
 		std::shared_ptr<streamfx::obs::gs::rendertarget> _source_rt;
@@ -95,6 +95,12 @@ void shader_instance::video_render(gs_effect_t* effect)
 		streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Shader Filter '%s' on '%s'", obs_source_get_name(_self), obs_source_get_name(obs_filter_get_parent(_self))};
 #endif
 
+		// The previous output is reused as is, so the input isn't needed either.
+		if (_fx->is_cached()) {
+			_fx->render(effect);
+			return;
+		}
+
 		{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_source, "Cache"};
@@ -139,6 +145,14 @@ void shader_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+bool shader_instance::degrade(::streamfx::obs::degradation level)
+{
+	if (level == ::streamfx::obs::degradation::Bypass) {
+		return true;
+	}
+	return _fx && _fx->degrade(level);
+}
+
 void streamfx::filter::shader::shader_instance::show()
 {
 	_fx->set_visible(true);
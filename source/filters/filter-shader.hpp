@@ -30,6 +30,8 @@ namespace streamfx::filter::shader {
 		virtual void video_tick(float_t sec_since_last) override;
 		virtual void video_render(gs_effect_t* effect) override;
 
+		virtual bool degrade(::streamfx::obs::degradation level) override;
+
 		void show() override;
 		void hide() override;
 
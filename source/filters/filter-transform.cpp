@@ -10,6 +10,7 @@
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <cinttypes>
 #include <stdexcept>
 #include "warning-enable.hpp"
 
@@ -74,6 +75,17 @@
 #define ST_KEY_CORNERS_BOTTOMLEFT "Corners.BottomLeft."
 #define ST_I18N_CORNERS_BOTTOMRIGHT ST_I18N_CORNERS ".BottomRight"
 #define ST_KEY_CORNERS_BOTTOMRIGHT "Corners.BottomRight."
+#define ST_I18N_COPIES ST_I18N ".Copies"
+#define ST_I18N_COPIES_COUNT ST_I18N_COPIES ".Count"
+#define ST_KEY_COPIES_COUNT "Copies.Count"
+#define ST_I18N_COPIES_COLUMNS ST_I18N_COPIES ".Columns"
+#define ST_KEY_COPIES_COLUMNS "Copies.Columns"
+#define ST_I18N_COPIES_POSITION ST_I18N_COPIES ".Position"
+#define ST_KEY_COPIES_POSITION "Copies.Position."
+#define ST_I18N_COPIES_ROTATION ST_I18N_COPIES ".Rotation"
+#define ST_KEY_COPIES_ROTATION "Copies.Rotation."
+#define ST_I18N_COPIES_SCALE ST_I18N_COPIES ".Scale"
+#define ST_KEY_COPIES_SCALE "Copies.Scale."
 #define ST_I18N_MIPMAPPING ST_I18N ".Mipmapping"
 #define ST_KEY_MIPMAPPING "Mipmapping"
 
@@ -93,14 +105,14 @@ enum RotationOrder : int64_t {
 	ZYX = 5,
 };
 
-transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _camera_mode(), _camera_fov(), _params(), _corners(), _standard_effect(), _transform_effect(), _sampler(), _cache_rendered(), _mipmap_enabled(), _source_rendered(), _source_size(), _update_mesh(true)
+transform_instance::transform_instance(obs_data_t* data, obs_source_t* context) : obs::source_instance(data, context), _gfx_util(::streamfx::gfx::util::get()), _camera_mode(), _camera_fov(), _params(), _corners(), _copies(), _standard_effect(), _transform_effect(), _sampler(), _cache_rendered(), _mipmap_enabled(), _source_rendered(), _source_size(), _update_mesh(true)
 {
 	{
 		auto gctx = obs::gs::context();
 
 		_cache_rt      = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 		_source_rt     = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-		_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(4u), uint8_t(1u));
+		_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(6u), uint8_t(1u));
 		{
 			auto file = streamfx::data_file_path("effects/standard.effect");
 			try {
@@ -134,6 +146,15 @@ transform_instance::transform_instance(obs_data_t* data, obs_source_t* context)
 		vec2_set(&_corners.tr, 1, 0);
 		vec2_set(&_corners.bl, 0, 1);
 		vec2_set(&_corners.br, 1, 1);
+
+		_copies.count   = 1;
+		_copies.columns = 1;
+
+#ifdef ENABLE_PROFILING
+		_capture_timer = std::make_shared<streamfx::obs::gs::timer>();
+		_copies_timer  = std::make_shared<streamfx::obs::gs::timer>();
+		_cost          = {};
+#endif
 	}
 
 	update(data);
@@ -141,6 +162,14 @@ transform_instance::transform_instance(obs_data_t* data, obs_source_t* context)
 
 transform_instance::~transform_instance()
 {
+#ifdef ENABLE_PROFILING
+	report_cost();
+
+	auto gctx = streamfx::obs::gs::context();
+	_capture_timer.reset();
+	_copies_timer.reset();
+#endif
+
 	_vertex_buffer.reset();
 	_cache_rt.reset();
 	_cache_texture.reset();
@@ -232,6 +261,19 @@ void transform_instance::update(obs_data_t* settings)
 		}
 	}
 
+	{ // Copies
+		_copies.count      = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(settings, ST_KEY_COPIES_COUNT), 1, 64));
+		_copies.columns    = static_cast<uint32_t>(std::clamp<int64_t>(obs_data_get_int(settings, ST_KEY_COPIES_COLUMNS), 1, 64));
+		_copies.position.x = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_POSITION "X") / 100.0);
+		_copies.position.y = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_POSITION "Y") / 100.0);
+		_copies.position.z = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_POSITION "Z") / 100.0);
+		_copies.rotation.x = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_ROTATION "X") / 180.0 * S_PI);
+		_copies.rotation.y = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_ROTATION "Y") / 180.0 * S_PI);
+		_copies.rotation.z = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_ROTATION "Z") / 180.0 * S_PI);
+		_copies.scale.x    = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_SCALE "X") / 100.0);
+		_copies.scale.y    = static_cast<float>(obs_data_get_double(settings, ST_KEY_COPIES_SCALE "Y") / 100.0);
+	}
+
 	// Mip-mapping
 	_mipmap_enabled = obs_data_get_bool(settings, ST_KEY_MIPMAPPING);
 	_sampler.set_filter(_mipmap_enabled ? GS_FILTER_ANISOTROPIC : GS_FILTER_LINEAR);
@@ -271,82 +313,80 @@ void transform_instance::video_tick(float)
 			height = 1;
 		}
 
+		// Each copy is a separate quad in the same buffer, so that all of them are drawn at once.
+		if (_vertex_buffer->size() != (_copies.count * 6)) {
+			auto gctx      = obs::gs::context();
+			_vertex_buffer = std::make_shared<streamfx::obs::gs::vertex_buffer>(uint32_t(_copies.count * 6), uint8_t(1u));
+		}
+
 		if (_camera_mode != transform_mode::CORNER_PIN) {
 			// Calculate Aspect Ratio
 			float aspect_ratio_x = float(width) / float(height);
 			if (_camera_mode == transform_mode::ORTHOGRAPHIC)
 				aspect_ratio_x = 1.0;
 
-			// Mesh
-			matrix4 ident;
-			matrix4_identity(&ident);
-			switch (_params.rotation_order) {
-			case RotationOrder::XYZ: // XYZ
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				break;
-			case RotationOrder::XZY: // XZY
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				break;
-			case RotationOrder::YXZ: // YXZ
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				break;
-			case RotationOrder::YZX: // YZX
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				break;
-			case RotationOrder::ZXY: // ZXY
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				break;
-			case RotationOrder::ZYX: // ZYX
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, _params.rotation.z);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, _params.rotation.y);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, _params.rotation.x);
-				break;
-			}
-			matrix4_translate3f(&ident, &ident, _params.position.x, _params.position.y, _params.position.z);
-			//matrix4_scale3f(&ident, &ident, _source_size.first / 2.f, _source_size.second / 2.f, 1.f);
-
-			/// Calculate vertex position once only.
-			float p_x = aspect_ratio_x * _params.scale.x;
-			float p_y = 1.0f * _params.scale.y;
-
-			/// Generate mesh
-			{
-				auto vtx   = _vertex_buffer->at(0);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 0, 0, 0);
-				vec3_set(vtx.position, -p_x + _params.shear.x, -p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(1);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 0, 0, 0);
-				vec3_set(vtx.position, p_x + _params.shear.x, -p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(2);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 0, 1, 0, 0);
-				vec3_set(vtx.position, -p_x - _params.shear.x, p_y - _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
-			}
-			{
-				auto vtx   = _vertex_buffer->at(3);
-				*vtx.color = 0xFFFFFFFF;
-				vec4_set(vtx.uv[0], 1, 1, 0, 0);
-				vec3_set(vtx.position, p_x - _params.shear.x, p_y + _params.shear.y, 0);
-				vec3_transform(vtx.position, vtx.position, &ident);
+			for (uint32_t idx = 0; idx < _copies.count; idx++) {
+				auto params = copy_params(idx);
+
+				// Mesh
+				matrix4 ident;
+				matrix4_identity(&ident);
+				switch (params.rotation_order) {
+				case RotationOrder::XYZ: // XYZ
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					break;
+				case RotationOrder::XZY: // XZY
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					break;
+				case RotationOrder::YXZ: // YXZ
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					break;
+				case RotationOrder::YZX: // YZX
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					break;
+				case RotationOrder::ZXY: // ZXY
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					break;
+				case RotationOrder::ZYX: // ZYX
+					matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, params.rotation.z);
+					matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, params.rotation.y);
+					matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, params.rotation.x);
+					break;
+				}
+				matrix4_translate3f(&ident, &ident, params.position.x, params.position.y, params.position.z);
+
+				/// Calculate vertex position once only.
+				float p_x = aspect_ratio_x * params.scale.x;
+				float p_y = 1.0f * params.scale.y;
+
+				/// Generate the quad as two triangles.
+				vec3 corners[4];
+				vec3_set(&corners[0], -p_x + params.shear.x, -p_y - params.shear.y, 0);
+				vec3_set(&corners[1], p_x + params.shear.x, -p_y + params.shear.y, 0);
+				vec3_set(&corners[2], -p_x - params.shear.x, p_y - params.shear.y, 0);
+				vec3_set(&corners[3], p_x - params.shear.x, p_y + params.shear.y, 0);
+				for (auto& corner : corners) {
+					vec3_transform(&corner, &corner, &ident);
+				}
+
+				static constexpr uint32_t order[] = {0, 1, 2, 2, 1, 3};
+				for (uint32_t vdx = 0; vdx < 6; vdx++) {
+					auto corner = order[vdx];
+					auto vtx    = _vertex_buffer->at(idx * 6 + vdx);
+					*vtx.color  = 0xFFFFFFFF;
+					vec4_set(vtx.uv[0], static_cast<float>(corner & 1), static_cast<float>(corner >> 1), 0, 0);
+					vec3_copy(vtx.position, &corners[corner]);
+				}
 			}
 		} else if (_camera_mode == transform_mode::CORNER_PIN) {
 			// Corner Pin is rendered in Fragment.
@@ -401,6 +441,11 @@ void transform_instance::video_render(gs_effect_t* effect)
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
 #endif
 
+#ifdef ENABLE_PROFILING
+		// Only the first render of a frame captures, so only that one is measured up to the mipmaps.
+		_capture_timer->begin();
+#endif
+
 		auto op = _cache_rt->render(cache_width, cache_height);
 
 		gs_ortho(0, static_cast<float>(base_width), 0, static_cast<float>(base_height), -1, 1);
@@ -424,6 +469,9 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 			gs_blend_state_pop();
 		} else {
+#ifdef ENABLE_PROFILING
+			_capture_timer->end();
+#endif
 			obs_source_skip_video_filter(_self);
 			return;
 		}
@@ -432,6 +480,9 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 	_cache_rt->get_texture(_cache_texture);
 	if (!_cache_texture) {
+#ifdef ENABLE_PROFILING
+		_capture_timer->end();
+#endif
 		obs_source_skip_video_filter(_self);
 		return;
 	}
@@ -453,25 +504,39 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 		_mipmap_rendered = true;
 		if (!_mipmap_texture) {
+#ifdef ENABLE_PROFILING
+			_capture_timer->end();
+#endif
 			obs_source_skip_video_filter(_self);
 			return;
 		}
 	}
+#ifdef ENABLE_PROFILING
+	_capture_timer->end();
+#endif
 
 	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
-		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Transform"};
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Transform (%" PRIu32 " copies)", _copies.count};
 #endif
 
 		auto op = _source_rt->render(base_width, base_height);
+#ifdef ENABLE_PROFILING
+		_copies_timer->begin();
+#endif
 
 		vec4 clear_color = {0, 0, 0, 0};
 		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &clear_color, 0, 0);
 
 		gs_blend_state_push();
 		gs_reset_blend_state();
-		gs_enable_blending(false);
-		gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO);
+		if (_copies.count > 1) { // Copies may overlap each other.
+			gs_enable_blending(true);
+			gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		} else {
+			gs_enable_blending(false);
+			gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO);
+		}
 
 		gs_enable_depth_test(false);
 		gs_enable_stencil_test(false);
@@ -501,7 +566,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 				v.set_sampler(_sampler.get_object());
 			}
 			while (gs_effect_loop(_standard_effect.get_object(), "Draw")) {
-				gs_draw(GS_TRISTRIP, 0, _vertex_buffer->size());
+				gs_draw(GS_TRIS, 0, _vertex_buffer->size());
 			}
 			gs_load_vertexbuffer(nullptr);
 		} else {
@@ -511,24 +576,31 @@ void transform_instance::video_render(gs_effect_t* effect)
 				v.set_texture(_mipmap_enabled ? (_mipmap_texture ? _mipmap_texture->get_object() : _cache_texture->get_object()) : _cache_texture->get_object());
 				v.set_sampler(_sampler.get_object());
 			}
-			if (auto v = _transform_effect.get_parameter("CornerTL"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
-				v.set_float2(_corners.tl);
-			}
-			if (auto v = _transform_effect.get_parameter("CornerTR"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
-				v.set_float2(_corners.tr);
-			}
-			if (auto v = _transform_effect.get_parameter("CornerBL"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
-				v.set_float2(_corners.bl);
-			}
-			if (auto v = _transform_effect.get_parameter("CornerBR"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
-				v.set_float2(_corners.br);
-			}
-			while (gs_effect_loop(_transform_effect.get_object(), "CornerPin")) {
-				_gfx_util->draw_fullscreen_triangle();
+			// Corner Pin is resolved per pixel, so each copy needs its own pass.
+			for (uint32_t idx = 0; idx < _copies.count; idx++) {
+				auto corners = copy_corners(idx);
+				if (auto v = _transform_effect.get_parameter("CornerTL"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
+					v.set_float2(corners.tl);
+				}
+				if (auto v = _transform_effect.get_parameter("CornerTR"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
+					v.set_float2(corners.tr);
+				}
+				if (auto v = _transform_effect.get_parameter("CornerBL"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
+					v.set_float2(corners.bl);
+				}
+				if (auto v = _transform_effect.get_parameter("CornerBR"); v.get_type() == ::streamfx::obs::gs::effect_parameter::type::Float2) {
+					v.set_float2(corners.br);
+				}
+				while (gs_effect_loop(_transform_effect.get_object(), "CornerPin")) {
+					_gfx_util->draw_fullscreen_triangle();
+				}
 			}
 		}
 
 		gs_blend_state_pop();
+#ifdef ENABLE_PROFILING
+		_copies_timer->end();
+#endif
 	}
 	_source_rt->get_texture(_source_texture);
 	if (!_source_texture) {
@@ -536,6 +608,24 @@ void transform_instance::video_render(gs_effect_t* effect)
 		return;
 	}
 
+#ifdef ENABLE_PROFILING
+	{ // Measurements for the previous copy count would skew the comparison, so report and start over.
+		if (_cost.copies != _copies.count) {
+			report_cost();
+			_cost        = {};
+			_cost.copies = _copies.count;
+		}
+		for (std::chrono::nanoseconds duration; _capture_timer->get(duration);) {
+			_cost.capture += duration;
+			_cost.captures++;
+		}
+		for (std::chrono::nanoseconds duration; _copies_timer->get(duration);) {
+			_cost.draw += duration;
+			_cost.draws++;
+		}
+	}
+#endif
+
 	{
 #if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Render"};
@@ -548,6 +638,69 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 }
 
+#ifdef ENABLE_PROFILING
+void transform_instance::report_cost()
+{
+	if ((_cost.copies == 0) || (_cost.captures == 0) || (_cost.draws == 0))
+		return;
+
+	double capture  = std::chrono::duration<double, std::milli>(_cost.capture).count() / static_cast<double>(_cost.captures);
+	double draw     = std::chrono::duration<double, std::milli>(_cost.draw).count() / static_cast<double>(_cost.draws);
+	double per_copy = draw / static_cast<double>(_cost.copies);
+
+	// Separate filters each capture their input again, but only draw a single copy.
+	double separate = (capture + per_copy) * static_cast<double>(_cost.copies);
+
+	D_LOG_INFO("'%s' drew %" PRIu32 " copies: capture %.3f ms, copies %.3f ms (%.3f ms per copy), %.3f ms per frame. %" PRIu32 " separate filters would take about %.3f ms.", obs_source_get_name(_self), _cost.copies, capture, draw, per_copy, capture + draw, _cost.copies, separate);
+}
+#endif
+
+transform_instance::parameters transform_instance::copy_params(uint32_t idx)
+{
+	uint32_t columns = std::min(_copies.columns, _copies.count);
+	uint32_t rows    = (_copies.count + columns - 1) / columns;
+	float    column  = static_cast<float>(idx % columns) - static_cast<float>(columns - 1) / 2.f;
+	float    row     = static_cast<float>(idx / columns) - static_cast<float>(rows - 1) / 2.f;
+	float    copy    = static_cast<float>(idx);
+
+	// Columns and rows are centered, everything else grows from the first copy.
+	parameters params = _params;
+	params.position.x += _copies.position.x * column;
+	params.position.y += _copies.position.y * row;
+	params.position.z += _copies.position.z * copy;
+	params.rotation.x += _copies.rotation.x * copy;
+	params.rotation.y += _copies.rotation.y * copy;
+	params.rotation.z += _copies.rotation.z * copy;
+	params.scale.x += _copies.scale.x * copy;
+	params.scale.y += _copies.scale.y * copy;
+	return params;
+}
+
+transform_instance::corner_pin transform_instance::copy_corners(uint32_t idx)
+{
+	if (idx == 0) {
+		return _corners;
+	}
+
+	auto params = copy_params(idx);
+	auto angle  = params.rotation.z - _params.rotation.z;
+	vec2 scale  = {params.scale.x / std::max(_params.scale.x, 0.0001f), params.scale.y / std::max(_params.scale.y, 0.0001f)};
+	vec2 offset = {params.position.x - _params.position.x, params.position.y - _params.position.y};
+
+	// Scale and roll each copy around its own center, then move it into place.
+	vec2 center;
+	vec2_set(&center, (_corners.tl.x + _corners.tr.x + _corners.bl.x + _corners.br.x) / 4.f, (_corners.tl.y + _corners.tr.y + _corners.bl.y + _corners.br.y) / 4.f);
+
+	corner_pin corners = _corners;
+	for (vec2* corner : {&corners.tl, &corners.tr, &corners.bl, &corners.br}) {
+		float x   = (corner->x - center.x) * scale.x;
+		float y   = (corner->y - center.y) * scale.y;
+		corner->x = center.x + offset.x + x * cosf(angle) - y * sinf(angle);
+		corner->y = center.y + offset.y + x * sinf(angle) + y * cosf(angle);
+	}
+	return corners;
+}
+
 transform_factory::transform_factory()
 {
 	_info.id           = S_PREFIX "filter-transform";
@@ -589,6 +742,16 @@ void transform_factory::get_defaults2(obs_data_t* settings)
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMLEFT "Y", 100.);
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "X", 100.);
 	obs_data_set_default_double(settings, ST_KEY_CORNERS_BOTTOMRIGHT "Y", 100.);
+	obs_data_set_default_int(settings, ST_KEY_COPIES_COUNT, 1);
+	obs_data_set_default_int(settings, ST_KEY_COPIES_COLUMNS, 1);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_POSITION "X", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_POSITION "Y", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_POSITION "Z", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_ROTATION "X", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_ROTATION "Y", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_ROTATION "Z", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_SCALE "X", 0);
+	obs_data_set_default_double(settings, ST_KEY_COPIES_SCALE "Y", 0);
 	obs_data_set_default_bool(settings, ST_KEY_MIPMAPPING, false);
 }
 
@@ -772,6 +935,62 @@ obs_properties_t* transform_factory::get_properties2(transform_instance* data)
 		obs_properties_add_group(pr, ST_I18N_CORNERS, D_TRANSLATE(ST_I18N_CORNERS), OBS_GROUP_NORMAL, grp);
 	}
 
+	{ // Copies
+		auto grp = obs_properties_create();
+
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_COPIES_COUNT, D_TRANSLATE(ST_I18N_COPIES_COUNT), 1, 64, 1);
+		}
+		{
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_COPIES_COLUMNS, D_TRANSLATE(ST_I18N_COPIES_COLUMNS), 1, 64, 1);
+		}
+		{ // Position
+			auto grp2 = obs_properties_create();
+
+			std::pair<std::string, std::string> opts[] = {
+				{ST_KEY_COPIES_POSITION "X", "X"},
+				{ST_KEY_COPIES_POSITION "Y", "Y"},
+				{ST_KEY_COPIES_POSITION "Z", "Z"},
+			};
+			for (auto& opt : opts) {
+				auto p = obs_properties_add_float(grp2, opt.first.c_str(), opt.second.c_str(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max(), 0.01);
+			}
+
+			obs_properties_add_group(grp, ST_I18N_COPIES_POSITION, D_TRANSLATE(ST_I18N_COPIES_POSITION), OBS_GROUP_NORMAL, grp2);
+		}
+		{ // Rotation
+			auto grp2 = obs_properties_create();
+
+			std::pair<std::string, std::string> opts[] = {
+				{ST_KEY_COPIES_ROTATION "X", D_TRANSLATE(ST_I18N_ROTATION ".X")},
+				{ST_KEY_COPIES_ROTATION "Y", D_TRANSLATE(ST_I18N_ROTATION ".Y")},
+				{ST_KEY_COPIES_ROTATION "Z", D_TRANSLATE(ST_I18N_ROTATION ".Z")},
+			};
+			for (auto& opt : opts) {
+				auto p = obs_properties_add_float_slider(grp2, opt.first.c_str(), opt.second.c_str(), -180.0, 180.0, 0.01);
+				obs_property_float_set_suffix(p, "° Deg");
+			}
+
+			obs_properties_add_group(grp, ST_I18N_COPIES_ROTATION, D_TRANSLATE(ST_I18N_COPIES_ROTATION), OBS_GROUP_NORMAL, grp2);
+		}
+		{ // Scale
+			auto grp2 = obs_properties_create();
+
+			std::pair<std::string, std::string> opts[] = {
+				{ST_KEY_COPIES_SCALE "X", "X"},
+				{ST_KEY_COPIES_SCALE "Y", "Y"},
+			};
+			for (auto& opt : opts) {
+				auto p = obs_properties_add_float_slider(grp2, opt.first.c_str(), opt.second.c_str(), -100.0, 100.0, 0.01);
+				obs_property_float_set_suffix(p, "%");
+			}
+
+			obs_properties_add_group(grp, ST_I18N_COPIES_SCALE, D_TRANSLATE(ST_I18N_COPIES_SCALE), OBS_GROUP_NORMAL, grp2);
+		}
+
+		obs_properties_add_group(pr, ST_I18N_COPIES, D_TRANSLATE(ST_I18N_COPIES), OBS_GROUP_NORMAL, grp);
+	}
+
 	{
 		auto grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
@@ -11,7 +11,12 @@
 #include "obs/gs/gs-vertexbuffer.hpp"
 #include "obs/obs-source-factory.hpp"
 
+#ifdef ENABLE_PROFILING
+#include "obs/gs/gs-timer.hpp"
+#endif
+
 #include "warning-disable.hpp"
+#include <chrono>
 #include <vector>
 #include "warning-enable.hpp"
 
@@ -23,24 +28,36 @@ namespace streamfx::filter::transform {
 	};
 
 	class transform_instance : public obs::source_instance {
-		std::shared_ptr<streamfx::gfx::util> _gfx_util;
-
-		// Settings
-		transform_mode _camera_mode;
-		float          _camera_fov;
-		struct {
+		struct parameters {
 			vec3     position;
 			vec3     rotation;
 			uint32_t rotation_order;
 			vec3     scale;
 			vec3     shear;
-		} _params;
-		struct {
+		};
+		struct corner_pin {
 			vec2 tl;
 			vec2 tr;
 			vec2 bl;
 			vec2 br;
-		} _corners;
+		};
+
+		std::shared_ptr<streamfx::gfx::util> _gfx_util;
+
+		// Settings
+		transform_mode _camera_mode;
+		float          _camera_fov;
+		parameters     _params;
+		corner_pin     _corners;
+
+		// Copies, all drawn from the same capture. Each copy is offset from the previous one.
+		struct {
+			uint32_t count;
+			uint32_t columns;
+			vec3     position; // Between columns (X), rows (Y) and copies (Z).
+			vec3     rotation;
+			vec2     scale;
+		} _copies;
 
 		// Data
 		streamfx::obs::gs::effect  _standard_effect;
@@ -68,6 +85,19 @@ namespace streamfx::filter::transform {
 		bool                                              _update_mesh;
 		std::shared_ptr<streamfx::obs::gs::vertex_buffer> _vertex_buffer;
 
+#ifdef ENABLE_PROFILING
+		// Cost, so that N copies can be compared against N separate filters.
+		std::shared_ptr<streamfx::obs::gs::timer> _capture_timer;
+		std::shared_ptr<streamfx::obs::gs::timer> _copies_timer;
+		struct {
+			uint32_t                 copies;
+			std::chrono::nanoseconds capture;
+			uint64_t                 captures;
+			std::chrono::nanoseconds draw;
+			uint64_t                 draws;
+		} _cost;
+#endif
+
 		public:
 		transform_instance(obs_data_t*, obs_source_t*);
 		virtual ~transform_instance() override;
@@ -78,6 +108,14 @@ namespace streamfx::filter::transform {
 
 		virtual void video_tick(float) override;
 		virtual void video_render(gs_effect_t*) override;
+
+		private:
+		parameters copy_params(uint32_t idx);
+
+#ifdef ENABLE_PROFILING
+		void report_cost();
+#endif
+		corner_pin copy_corners(uint32_t idx);
 	};
 
 	class transform_factory : public obs::source_factory<filter::transform::transform_factory, filter::transform::transform_instance> {
@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "filter-virtual-greenscreen.hpp"
+#include "gfx/blur/gfx-blur-gaussian.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "plugin.hpp"
 #include "util/util-logging.hpp"
@@ -29,6 +30,8 @@
 #define ST_KEY_PROVIDER "Provider"
 #define ST_I18N_PROVIDER ST_I18N "." ST_KEY_PROVIDER
 #define ST_I18N_PROVIDER_NVIDIA_GREENSCREEN ST_I18N_PROVIDER ".NVIDIA.Greenscreen"
+#define ST_KEY_FEATHER "Feather"
+#define ST_I18N_FEATHER ST_I18N "." ST_KEY_FEATHER
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 #define ST_KEY_NVIDIA_GREENSCREEN "NVIDIA.Greenscreen"
@@ -77,7 +80,7 @@ std::string streamfx::filter::virtual_greenscreen::string(virtual_greenscreen_pr
 virtual_greenscreen_instance::virtual_greenscreen_instance(obs_data_t* data, obs_source_t* self)
 	: obs::source_instance(data, self),
 
-	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _dirty(true)
+	  _size(1, 1), _provider(virtual_greenscreen_provider::INVALID), _provider_ui(virtual_greenscreen_provider::INVALID), _provider_ready(false), _provider_lock(), _provider_task(), _effect(), _channel0_sampler(), _channel1_sampler(), _input(), _output_color(), _output_alpha(), _dirty(true), _feather(0.), _feathered(false), _feather_mask(), _feather_blur()
 {
 	D_LOG_DEBUG("Initializating... (Addr: 0x%" PRIuPTR ")", this);
 
@@ -90,6 +93,11 @@ virtual_greenscreen_instance::virtual_greenscreen_instance(obs_data_t* data, obs
 		_output_color = _input->get_texture();
 		_output_alpha = _input->get_texture();
 
+		// The mask is feathered as a single channel, which is a quarter of the memory and bandwidth of RGBA.
+		_feather_mask = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_R8, GS_ZS_NONE);
+		_feather_mask->render(1, 1); // Preallocate the RT on the driver and GPU.
+		_feather_blur = ::streamfx::gfx::blur::gaussian_factory::get().create(::streamfx::gfx::blur::type::Area);
+
 		// Load the required effect.
 		{
 			std::filesystem::path file = ::streamfx::data_file_path("effects/virtual-greenscreen.effect");
@@ -152,6 +160,8 @@ void virtual_greenscreen_instance::migrate(obs_data_t* data, uint64_t version) {
 
 void virtual_greenscreen_instance::update(obs_data_t* data)
 {
+	_feather = obs_data_get_double(data, ST_KEY_FEATHER);
+
 	// Check if the user changed which Denoising provider we use.
 	virtual_greenscreen_provider provider = static_cast<virtual_greenscreen_provider>(obs_data_get_int(data, ST_KEY_PROVIDER));
 	if (provider == virtual_greenscreen_provider::AUTOMATIC) {
@@ -315,6 +325,42 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 			return;
 		}
 
+		// Feather the mask, if the provider produced one.
+		_feathered = (_feather > 0.) && _feather_blur && (_output_alpha != _output_color);
+		if (_feathered) {
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_convert, "Feather"};
+#endif
+			{ // Move the alpha channel into a single channel mask.
+				auto op = _feather_mask->render(_size.first, _size.second);
+
+				gs_matrix_push();
+				gs_ortho(0., 1., 0., 1., 0., 1.);
+
+				gs_blend_state_push();
+				gs_enable_color(true, true, true, true);
+				gs_enable_blending(false);
+				gs_enable_depth_test(false);
+				gs_enable_stencil_test(false);
+				gs_set_cull_mode(GS_NEITHER);
+
+				if (_effect->has_parameter("InputB", ::streamfx::obs::gs::effect_parameter::type::Texture)) {
+					_effect->get_parameter("InputB").set_texture(_output_alpha);
+				}
+				while (gs_effect_loop(_effect->get_object(), "ExtractMask")) {
+					gs_draw_sprite(nullptr, 0, 1, 1);
+				}
+
+				gs_blend_state_pop();
+				gs_matrix_pop();
+			}
+
+			// The blur keeps single channel inputs single channel.
+			_feather_blur->set_input(_feather_mask->get_texture());
+			_feather_blur->set_size(_feather);
+			_output_alpha = _feather_blur->render();
+		}
+
 		_dirty = false;
 	}
 
@@ -334,7 +380,7 @@ void virtual_greenscreen_instance::video_render(gs_effect_t* effect)
 		if (_effect->has_parameter("ThresholdRange", ::streamfx::obs::gs::effect_parameter::type::Float)) {
 			_effect->get_parameter("ThresholdRange").set_float(.333333);
 		}
-		while (gs_effect_loop(_effect->get_object(), "DrawAlphaThreshold")) {
+		while (gs_effect_loop(_effect->get_object(), _feathered ? "DrawMaskThreshold" : "DrawAlphaThreshold")) {
 			gs_draw_sprite(nullptr, 0, _size.first, _size.second);
 		}
 	}
@@ -538,6 +584,7 @@ const char* virtual_greenscreen_factory::get_name()
 void virtual_greenscreen_factory::get_defaults2(obs_data_t* data)
 {
 	obs_data_set_default_int(data, ST_KEY_PROVIDER, static_cast<int64_t>(virtual_greenscreen_provider::AUTOMATIC));
+	obs_data_set_default_double(data, ST_KEY_FEATHER, 0.);
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 	obs_data_set_default_int(data, ST_KEY_NVIDIA_GREENSCREEN_MODE, static_cast<int64_t>(::streamfx::nvidia::vfx::greenscreen_mode::QUALITY));
@@ -571,6 +618,12 @@ obs_properties_t* virtual_greenscreen_factory::get_properties2(virtual_greenscre
 		data->properties(pr);
 	}
 
+	{
+		auto& blur = ::streamfx::gfx::blur::gaussian_factory::get();
+		auto  p    = obs_properties_add_float_slider(pr, ST_KEY_FEATHER, D_TRANSLATE(ST_I18N_FEATHER), 0., blur.get_max_size(::streamfx::gfx::blur::type::Area), 1.);
+		obs_property_float_set_suffix(p, " px");
+	}
+
 	{ // Advanced Settings
 		auto grp = obs_properties_create();
 		obs_properties_add_group(pr, S_ADVANCED, D_TRANSLATE(S_ADVANCED), OBS_GROUP_NORMAL, grp);
@@ -3,6 +3,7 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #pragma once
+#include "gfx/blur/gfx-blur-base.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
@@ -49,6 +50,11 @@ namespace streamfx::filter::virtual_greenscreen {
 		std::shared_ptr<::streamfx::obs::gs::texture>      _output_alpha;
 		bool                                               _dirty;
 
+		double_t                                           _feather;
+		bool                                               _feathered;
+		std::shared_ptr<::streamfx::obs::gs::rendertarget> _feather_mask;
+		std::shared_ptr<::streamfx::gfx::blur::base>       _feather_blur;
+
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::vfx::greenscreen> _nvidia_fx;
 #endif
@@ -8,6 +8,42 @@
 #include <stdexcept>
 #include "warning-enable.hpp"
 
+bool streamfx::gfx::blur::is_single_channel(gs_color_format format)
+{
+	switch (format) {
+	case GS_R8:
+	case GS_R16:
+	case GS_R16F:
+	case GS_R32F:
+		return true;
+	default:
+		return false;
+	}
+}
+
+gs_color_format streamfx::gfx::blur::get_output_format(gs_color_format input)
+{
+	return is_single_channel(input) ? input : GS_RGBA;
+}
+
+void streamfx::gfx::blur::ensure_format(std::shared_ptr<::streamfx::obs::gs::rendertarget>& rt, gs_color_format format)
+{
+	if (!rt || (rt->get_color_format() != format)) {
+		rt = std::make_shared<::streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	}
+}
+
+::streamfx::obs::gs::effect streamfx::gfx::blur::get_permutation(::streamfx::obs::gs::effect_permutations& effects, gs_color_format format)
+{
+	if (is_single_channel(format)) {
+		// Writing all four channels to a single channel target is still correct, just slower.
+		if (auto effect = effects.get({{"PERMUTATION_SINGLE_CHANNEL", "1"}}); effect) {
+			return effect;
+		}
+	}
+	return effects.get();
+}
+
 void streamfx::gfx::blur::base::set_step_scale_x(double_t v)
 {
 	this->set_step_scale(v, this->get_step_scale_y());
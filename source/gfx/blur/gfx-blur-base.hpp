@@ -4,6 +4,8 @@
 
 #pragma once
 #include "common.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
 #include "obs/gs/gs-texture.hpp"
 
 namespace streamfx::gfx {
@@ -16,6 +18,22 @@ namespace streamfx::gfx {
 			Zoom,
 		};
 
+		/** Single channel inputs, like masks, are blurred as one value per texel instead of four.
+		 */
+		bool is_single_channel(gs_color_format format);
+
+		/** Format a blur renders to for an input format: single channel stays single channel, everything else is RGBA.
+		 */
+		gs_color_format get_output_format(gs_color_format input);
+
+		/** Recreate a render target if it doesn't have the format, otherwise keep it.
+		 */
+		void ensure_format(std::shared_ptr<::streamfx::obs::gs::rendertarget>& rt, gs_color_format format);
+
+		/** Variant of a blur effect for a format, or the generic variant if there is none.
+		 */
+		::streamfx::obs::gs::effect get_permutation(::streamfx::obs::gs::effect_permutations& effects, gs_color_format format);
+
 		class base {
 			public:
 			virtual ~base() {}
@@ -0,0 +1,371 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gfx-blur-bokeh.hpp"
+#include "common.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#define ST_MAX_BLUR_SIZE 128 // Also change this in bokeh.effect if modified.
+
+#ifdef ENABLE_PROFILING
+// Run the reference every this many frames, and log every this many references.
+#define ST_REFERENCE_INTERVAL 60
+#define ST_REFERENCE_LOG_INTERVAL 10
+#endif
+
+streamfx::gfx::blur::bokeh_data::bokeh_data() : _gfx_util(::streamfx::gfx::util::get())
+{
+	auto gctx = streamfx::obs::gs::context();
+	{
+		auto file = streamfx::data_file_path("effects/blur/bokeh.effect");
+		try {
+			_effect = streamfx::obs::gs::effect::create(file);
+		} catch (const std::exception& ex) {
+			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		}
+	}
+}
+
+streamfx::gfx::blur::bokeh_data::~bokeh_data()
+{
+	auto gctx = streamfx::obs::gs::context();
+	_effect.reset();
+}
+
+std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::bokeh_data::get_gfx_util()
+{
+	return _gfx_util;
+}
+
+streamfx::obs::gs::effect streamfx::gfx::blur::bokeh_data::get_effect()
+{
+	return _effect;
+}
+
+streamfx::gfx::blur::bokeh_factory::bokeh_factory() {}
+
+streamfx::gfx::blur::bokeh_factory::~bokeh_factory() {}
+
+bool streamfx::gfx::blur::bokeh_factory::is_type_supported(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Area:
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::shared_ptr<::streamfx::gfx::blur::base> streamfx::gfx::blur::bokeh_factory::create(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Area:
+		return std::make_shared<::streamfx::gfx::blur::bokeh>();
+	default:
+		throw std::runtime_error("Invalid type.");
+	}
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_min_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.0);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_step_size(::streamfx::gfx::blur::type)
+{
+	return double_t(1.0);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_max_size(::streamfx::gfx::blur::type)
+{
+	return double_t(ST_MAX_BLUR_SIZE);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_min_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_step_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_max_angle(::streamfx::gfx::blur::type)
+{
+	return double_t(0);
+}
+
+bool streamfx::gfx::blur::bokeh_factory::is_step_scale_supported(::streamfx::gfx::blur::type type)
+{
+	switch (type) {
+	case ::streamfx::gfx::blur::type::Area:
+		return true;
+	default:
+		return false;
+	}
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_min_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_step_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_max_step_scale_x(::streamfx::gfx::blur::type)
+{
+	return double_t(1000.0);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_min_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_step_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(0.01);
+}
+
+double_t streamfx::gfx::blur::bokeh_factory::get_max_step_scale_y(::streamfx::gfx::blur::type)
+{
+	return double_t(1000.0);
+}
+
+std::shared_ptr<::streamfx::gfx::blur::bokeh_data> streamfx::gfx::blur::bokeh_factory::data()
+{
+	std::unique_lock<std::mutex>                       ulock(_data_lock);
+	std::shared_ptr<::streamfx::gfx::blur::bokeh_data> data = _data.lock();
+	if (!data) {
+		data  = std::make_shared<::streamfx::gfx::blur::bokeh_data>();
+		_data = data;
+	}
+	return data;
+}
+
+::streamfx::gfx::blur::bokeh_factory& streamfx::gfx::blur::bokeh_factory::get()
+{
+	static ::streamfx::gfx::blur::bokeh_factory instance;
+	return instance;
+}
+
+streamfx::gfx::blur::bokeh::bokeh() : _data(::streamfx::gfx::blur::bokeh_factory::get().data()), _size(1.), _step_scale({1., 1.})
+{
+	auto gctx              = streamfx::obs::gs::context();
+	_rendertarget          = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_rendertarget_vertical = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_rendertarget_diagonal = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+
+#ifdef ENABLE_PROFILING
+	_rendertarget_reference = std::make_shared<::streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	_timer                  = std::make_shared<::streamfx::obs::gs::timer>();
+	_timer_reference        = std::make_shared<::streamfx::obs::gs::timer>(1);
+	_timer_frames           = 0;
+	_timer_total            = std::chrono::nanoseconds(0);
+	_timer_count            = 0;
+	_timer_reference_total  = std::chrono::nanoseconds(0);
+	_timer_reference_count  = 0;
+#endif
+}
+
+streamfx::gfx::blur::bokeh::~bokeh()
+{
+#ifdef ENABLE_PROFILING
+	auto gctx = streamfx::obs::gs::context();
+	_timer.reset();
+	_timer_reference.reset();
+#endif
+}
+
+void streamfx::gfx::blur::bokeh::set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture)
+{
+	_input_texture = std::move(texture);
+}
+
+::streamfx::gfx::blur::type streamfx::gfx::blur::bokeh::get_type()
+{
+	return ::streamfx::gfx::blur::type::Area;
+}
+
+double_t streamfx::gfx::blur::bokeh::get_size()
+{
+	return _size;
+}
+
+void streamfx::gfx::blur::bokeh::set_size(double_t width)
+{
+	_size = width;
+	if (_size < 1.0) {
+		_size = 1.0;
+	}
+	if (_size > ST_MAX_BLUR_SIZE) {
+		_size = ST_MAX_BLUR_SIZE;
+	}
+}
+
+void streamfx::gfx::blur::bokeh::set_step_scale(double_t x, double_t y)
+{
+	_step_scale = {x, y};
+}
+
+void streamfx::gfx::blur::bokeh::get_step_scale(double_t& x, double_t& y)
+{
+	x = _step_scale.first;
+	y = _step_scale.second;
+}
+
+double_t streamfx::gfx::blur::bokeh::get_step_scale_x()
+{
+	return _step_scale.first;
+}
+
+double_t streamfx::gfx::blur::bokeh::get_step_scale_y()
+{
+	return _step_scale.second;
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::bokeh::render()
+{
+	auto gctx = streamfx::obs::gs::context();
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Bokeh Blur");
+#endif
+
+	float_t width  = float_t(_input_texture->get_width());
+	float_t height = float_t(_input_texture->get_height());
+	float_t size   = std::round(float_t(_size));
+
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
+
+#ifdef ENABLE_PROFILING
+	if (std::chrono::nanoseconds duration; _timer->get(duration)) {
+		_timer_total += duration;
+		_timer_count++;
+	}
+	_timer->begin();
+#endif
+
+	// Three Pass Blur
+	streamfx::obs::gs::effect effect = _data->get_effect();
+	if (effect) {
+		effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
+		effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
+		effect.get_parameter("pSize").set_float(size);
+		effect.get_parameter("pSizeInverseMul").set_float(float_t(1.0f / size));
+
+		// Pass 1
+		effect.get_parameter("pImage").set_texture(_input_texture);
+
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Vertical");
+#endif
+
+			auto op = _rendertarget_vertical->render(uint32_t(width), uint32_t(height));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "Vertical")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		// Pass 2
+		effect.get_parameter("pImage").set_texture(_input_texture);
+		effect.get_parameter("pImage2").set_texture(_rendertarget_vertical->get_texture());
+
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Diagonal");
+#endif
+
+			auto op = _rendertarget_diagonal->render(uint32_t(width), uint32_t(height));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "Diagonal")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+
+		// Pass 3
+		effect.get_parameter("pImage").set_texture(_rendertarget_vertical->get_texture());
+		effect.get_parameter("pImage2").set_texture(_rendertarget_diagonal->get_texture());
+
+		{
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+			auto gdm = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Combine");
+#endif
+
+			auto op = _rendertarget->render(uint32_t(width), uint32_t(height));
+			gs_ortho(0, 1., 0, 1., 0, 1.);
+			while (gs_effect_loop(effect.get_object(), "Combine")) {
+				_data->get_gfx_util()->draw_fullscreen_triangle();
+			}
+		}
+	}
+
+#ifdef ENABLE_PROFILING
+	_timer->end();
+
+	if (((++_timer_frames) % ST_REFERENCE_INTERVAL) == 0) {
+		render_reference();
+	}
+#endif
+
+	return _rendertarget->get_texture();
+}
+
+std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::bokeh::get()
+{
+	return _rendertarget->get_texture();
+}
+
+#ifdef ENABLE_PROFILING
+void streamfx::gfx::blur::bokeh::render_reference()
+{
+	streamfx::obs::gs::effect effect = _data->get_effect();
+	if (!effect || !_timer->is_supported()) {
+		return;
+	}
+
+	if (std::chrono::nanoseconds duration; _timer_reference->get(duration)) {
+		_timer_reference_total += duration;
+		_timer_reference_count++;
+
+		if ((_timer_reference_count >= ST_REFERENCE_LOG_INTERVAL) && (_timer_count > 0)) {
+			double_t hexagon = static_cast<double_t>(_timer_total.count()) / static_cast<double_t>(_timer_count) / 1000000.;
+			double_t disk    = static_cast<double_t>(_timer_reference_total.count()) / static_cast<double_t>(_timer_reference_count) / 1000000.;
+			DLOG_INFO("<gfx::blur::bokeh> %" PRIu32 "x%" PRIu32 " at size %.0f: Hexagon %.3fms, Disk %.3fms (%.1fx).", _input_texture->get_width(), _input_texture->get_height(), _size, hexagon, disk, disk / hexagon);
+
+			_timer_total           = std::chrono::nanoseconds(0);
+			_timer_count           = 0;
+			_timer_reference_total = std::chrono::nanoseconds(0);
+			_timer_reference_count = 0;
+		}
+	}
+
+	// Parameters are still set up from the actual blur.
+	effect.get_parameter("pImage").set_texture(_input_texture);
+
+	_timer_reference->begin();
+	{
+		auto op = _rendertarget_reference->render(_input_texture->get_width(), _input_texture->get_height());
+		gs_ortho(0, 1., 0, 1., 0, 1.);
+		while (gs_effect_loop(effect.get_object(), "Disk")) {
+			_data->get_gfx_util()->draw_fullscreen_triangle();
+		}
+	}
+	_timer_reference->end();
+}
+#endif
@@ -0,0 +1,139 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gfx-blur-base.hpp"
+#include "gfx/gfx-util.hpp"
+#include "obs/gs/gs-effect.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+
+#ifdef ENABLE_PROFILING
+#include "obs/gs/gs-timer.hpp"
+#endif
+
+#include "warning-disable.hpp"
+#include <mutex>
+#include "warning-enable.hpp"
+
+/* Hexagonal Bokeh Blur
+ *
+ * A hexagon is the union of three rhombi, and each rhombus is two one-sided
+ *  linear blurs along two of its edges. By sharing the vertical blur between
+ *  two of the rhombi, the whole hexagon takes three passes of O(r) samples
+ *  each, instead of O(r^2) samples for sampling a disk directly:
+ * 1. Vertical: Blur the input upwards.
+ * 2. Diagonal: Blur the input down-left, and add the vertical result.
+ * 3. Combine: Blur the vertical result down-left, and the diagonal result
+ *    down-right, then average them.
+ */
+
+namespace streamfx::gfx {
+	namespace blur {
+		class bokeh_data {
+			streamfx::obs::gs::effect            _effect;
+			std::shared_ptr<streamfx::gfx::util> _gfx_util;
+
+			public:
+			bokeh_data();
+			virtual ~bokeh_data();
+
+			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
+
+			streamfx::obs::gs::effect get_effect();
+		};
+
+		class bokeh_factory : public ::streamfx::gfx::blur::ifactory {
+			std::mutex                                       _data_lock;
+			std::weak_ptr<::streamfx::gfx::blur::bokeh_data> _data;
+
+			public:
+			bokeh_factory();
+			virtual ~bokeh_factory() override;
+
+			virtual bool is_type_supported(::streamfx::gfx::blur::type type) override;
+
+			virtual std::shared_ptr<::streamfx::gfx::blur::base> create(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_size(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_angle(::streamfx::gfx::blur::type type) override;
+
+			virtual bool is_step_scale_supported(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_step_scale_x(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_min_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_step_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			virtual double_t get_max_step_scale_y(::streamfx::gfx::blur::type type) override;
+
+			std::shared_ptr<::streamfx::gfx::blur::bokeh_data> data();
+
+			public: // Singleton
+			static ::streamfx::gfx::blur::bokeh_factory& get();
+		};
+
+		class bokeh : public ::streamfx::gfx::blur::base {
+			std::shared_ptr<::streamfx::gfx::blur::bokeh_data> _data;
+
+			double_t                                           _size;
+			std::pair<double_t, double_t>                      _step_scale;
+			std::shared_ptr<::streamfx::obs::gs::texture>      _input_texture;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget_vertical;
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget_diagonal;
+
+#ifdef ENABLE_PROFILING
+			// Timings against a brute force disk kernel.
+			std::shared_ptr<::streamfx::obs::gs::rendertarget> _rendertarget_reference;
+			std::shared_ptr<::streamfx::obs::gs::timer>        _timer;
+			std::shared_ptr<::streamfx::obs::gs::timer>        _timer_reference;
+			std::size_t                                        _timer_frames;
+			std::chrono::nanoseconds                           _timer_total;
+			std::size_t                                        _timer_count;
+			std::chrono::nanoseconds                           _timer_reference_total;
+			std::size_t                                        _timer_reference_count;
+#endif
+
+			public:
+			bokeh();
+			virtual ~bokeh() override;
+
+			virtual void set_input(std::shared_ptr<::streamfx::obs::gs::texture> texture) override;
+
+			virtual ::streamfx::gfx::blur::type get_type() override;
+
+			virtual double_t get_size() override;
+			virtual void     set_size(double_t width) override;
+
+			virtual void     set_step_scale(double_t x, double_t y) override;
+			virtual void     get_step_scale(double_t& x, double_t& y) override;
+			virtual double_t get_step_scale_x() override;
+			virtual double_t get_step_scale_y() override;
+
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> render() override;
+			virtual std::shared_ptr<::streamfx::obs::gs::texture> get() override;
+
+#ifdef ENABLE_PROFILING
+			private:
+			void render_reference();
+#endif
+		};
+	} // namespace blur
+} // namespace streamfx::gfx
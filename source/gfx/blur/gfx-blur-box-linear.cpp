@@ -6,6 +6,7 @@
 #include "gfx-blur-box-linear.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -21,10 +22,9 @@ streamfx::gfx::blur::box_linear_data::box_linear_data() : _gfx_util(::streamfx::
 	auto gctx = streamfx::obs::gs::context();
 	{
 		auto file = streamfx::data_file_path("effects/blur/box-linear.effect");
-		try {
-			_effect = streamfx::obs::gs::effect::create(file);
-		} catch (const std::exception& ex) {
-			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(file);
+		if (!_effects->get()) {
+			DLOG_ERROR("Error loading '%s'.", file.generic_u8string().c_str());
 		}
 	}
 }
@@ -32,7 +32,7 @@ streamfx::gfx::blur::box_linear_data::box_linear_data() : _gfx_util(::streamfx::
 streamfx::gfx::blur::box_linear_data::~box_linear_data()
 {
 	auto gctx = streamfx::obs::gs::context();
-	_effect.reset();
+	_effects.reset();
 }
 
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::box_linear_data::get_gfx_util()
@@ -40,9 +40,9 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::box_linear_data::get_g
 	return _gfx_util;
 }
 
-streamfx::obs::gs::effect streamfx::gfx::blur::box_linear_data::get_effect()
+streamfx::obs::gs::effect streamfx::gfx::blur::box_linear_data::get_effect(gs_color_format format)
 {
-	return _effect;
+	return ::streamfx::gfx::blur::get_permutation(*_effects, format);
 }
 
 streamfx::gfx::blur::box_linear_factory::box_linear_factory() {}
@@ -239,21 +239,13 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	// Two Pass Blur
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget2, format);
 	if (effect) {
 		// Pass 1
 		effect.get_parameter("pImage").set_texture(_input_texture);
@@ -291,8 +283,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear::r
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return _rendertarget->get_texture();
 }
 
@@ -329,21 +319,12 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear_di
 	float_t width  = float_t(_input_texture->get_width());
 	float_t height = float_t(_input_texture->get_height());
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	// One Pass Blur
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
 	if (effect) {
 		effect.get_parameter("pImage").set_texture(_input_texture);
 		effect.get_parameter("pImageTexel").set_float2(float_t(1. / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
@@ -360,7 +341,5 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::box_linear_di
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return _rendertarget->get_texture();
 }
@@ -17,8 +17,8 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class box_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
+			std::shared_ptr<streamfx::obs::gs::effect_permutations> _effects;
+			std::shared_ptr<streamfx::gfx::util>                    _gfx_util;
 
 			public:
 			box_data();
@@ -26,7 +26,7 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
-			streamfx::obs::gs::effect get_effect();
+			streamfx::obs::gs::effect get_effect(gs_color_format format);
 		};
 
 		class box_factory : public ::streamfx::gfx::blur::ifactory {
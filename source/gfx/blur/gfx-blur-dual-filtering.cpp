@@ -6,6 +6,7 @@
 #include "gfx-blur-dual-filtering.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -38,10 +39,9 @@ streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::st
 	auto gctx = streamfx::obs::gs::context();
 	{
 		auto file = streamfx::data_file_path("effects/blur/dual-filtering.effect");
-		try {
-			_effect = streamfx::obs::gs::effect::create(file);
-		} catch (const std::exception& ex) {
-			DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+		_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(file);
+		if (!_effects->get()) {
+			DLOG_ERROR("Error loading '%s'.", file.generic_u8string().c_str());
 		}
 	}
 }
@@ -49,7 +49,7 @@ streamfx::gfx::blur::dual_filtering_data::dual_filtering_data() : _gfx_util(::st
 streamfx::gfx::blur::dual_filtering_data::~dual_filtering_data()
 {
 	auto gctx = streamfx::obs::gs::context();
-	_effect.reset();
+	_effects.reset();
 }
 
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::dual_filtering_data::get_gfx_util()
@@ -57,9 +57,9 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::dual_filtering_data::g
 	return _gfx_util;
 }
 
-streamfx::obs::gs::effect streamfx::gfx::blur::dual_filtering_data::get_effect()
+streamfx::obs::gs::effect streamfx::gfx::blur::dual_filtering_data::get_effect(gs_color_format format)
 {
-	return _effect;
+	return ::streamfx::gfx::blur::get_permutation(*_effects, format);
 }
 
 streamfx::gfx::blur::dual_filtering_factory::dual_filtering_factory() {}
@@ -218,23 +218,16 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Dual-Filtering Blur");
 #endif
 
-	auto effect = _data->get_effect();
+	gs_color_format format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	auto            effect = _data->get_effect(format);
+	for (auto& rt : _rts) {
+		::streamfx::gfx::blur::ensure_format(rt, format);
+	}
 	if (!effect) {
 		return _input_texture;
 	}
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_color(true, true, true, true);
-	gs_enable_blending(false);
-	gs_enable_depth_test(false);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_set_cull_mode(GS_NEITHER);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	uint32_t width      = _input_texture->get_width();
 	uint32_t height     = _input_texture->get_height();
@@ -305,8 +298,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::dual_filterin
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return _rts[0]->get_texture();
 }
 
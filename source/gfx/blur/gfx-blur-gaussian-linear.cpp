@@ -6,6 +6,7 @@
 #include "gfx-blur-gaussian-linear.hpp"
 #include "common.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
@@ -29,10 +30,9 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::
 
 		{
 			auto file = streamfx::data_file_path("effects/blur/gaussian-linear.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+			_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(file);
+			if (!_effects->get()) {
+				DLOG_ERROR("Error loading '%s'.", file.generic_u8string().c_str());
 			}
 		}
 	}
@@ -70,12 +70,12 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data() : _gfx_util(::
 
 streamfx::gfx::blur::gaussian_linear_data::~gaussian_linear_data()
 {
-	_effect.reset();
+	_effects.reset();
 }
 
-streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_linear_data::get_effect()
+streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_linear_data::get_effect(gs_color_format format)
 {
-	return _effect;
+	return ::streamfx::gfx::blur::get_permutation(*_effects, format);
 }
 
 std::vector<float_t> const& streamfx::gfx::blur::gaussian_linear_data::get_kernel(std::size_t width)
@@ -285,7 +285,10 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Linear Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget2, format);
 	auto                      kernel = _data->get_kernel(size_t(_size));
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
@@ -296,18 +299,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
@@ -353,8 +345,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 		std::swap(_rendertarget, _rendertarget2);
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
 
@@ -390,8 +380,10 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Linear Directional Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
 	auto                      kernel = _data->get_kernel(size_t(_size));
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -401,18 +393,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(_angle)), float_t(1.f / height * sin(_angle)));
@@ -429,7 +410,5 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
@@ -18,9 +18,9 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class gaussian_linear_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
-			std::vector<std::vector<float_t>>    _kernels;
+			std::shared_ptr<streamfx::obs::gs::effect_permutations> _effects;
+			std::shared_ptr<streamfx::gfx::util>                    _gfx_util;
+			std::vector<std::vector<float_t>>                       _kernels;
 
 			public:
 			gaussian_linear_data();
@@ -28,7 +28,7 @@ namespace streamfx::gfx {
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
-			streamfx::obs::gs::effect get_effect();
+			streamfx::obs::gs::effect get_effect(gs_color_format format);
 
 			std::vector<float_t> const& get_kernel(std::size_t width);
 		};
@@ -7,6 +7,7 @@
 #include "common.hpp"
 #include "gfx/gfx-util.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-renderstate.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
@@ -32,10 +33,9 @@ streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx:
 
 		{
 			auto file = streamfx::data_file_path("effects/blur/gaussian.effect");
-			try {
-				_effect = streamfx::obs::gs::effect::create(file);
-			} catch (const std::exception& ex) {
-				DLOG_ERROR("Error loading '%s': %s", file.generic_u8string().c_str(), ex.what());
+			_effects = std::make_shared<streamfx::obs::gs::effect_permutations>(file);
+			if (!_effects->get()) {
+				DLOG_ERROR("Error loading '%s'.", file.generic_u8string().c_str());
 			}
 		}
 	}
@@ -95,12 +95,12 @@ streamfx::gfx::blur::gaussian_data::gaussian_data() : _gfx_util(::streamfx::gfx:
 streamfx::gfx::blur::gaussian_data::~gaussian_data()
 {
 	auto gctx = streamfx::obs::gs::context();
-	_effect.reset();
+	_effects.reset();
 }
 
-streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_data::get_effect()
+streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_data::get_effect(gs_color_format format)
 {
-	return _effect;
+	return ::streamfx::gfx::blur::get_permutation(*_effects, format);
 }
 
 std::shared_ptr<streamfx::gfx::util> streamfx::gfx::blur::gaussian_data::get_gfx_util()
@@ -314,7 +314,10 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget2, format);
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -325,18 +328,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pStepScale").set_float2(float_t(_step_scale.first), float_t(_step_scale.second));
 	effect.get_parameter("pSize").set_float(float_t(_size * ST_OVERSAMPLE_MULTIPLIER));
@@ -382,8 +374,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian::ren
 		std::swap(_rendertarget, _rendertarget2);
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
 
@@ -419,7 +409,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Directional Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -430,18 +422,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width * cos(m_angle)), float_t(1.f / height * sin(m_angle)));
@@ -457,8 +438,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_dire
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
 
@@ -475,7 +454,9 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Rotational Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -486,18 +467,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
@@ -516,8 +486,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_rota
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
 
@@ -556,8 +524,10 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 	auto gdmp = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_azure_radiance, "Gaussian Zoom Blur");
 #endif
 
-	streamfx::obs::gs::effect effect = _data->get_effect();
+	gs_color_format           format = ::streamfx::gfx::blur::get_output_format(_input_texture->get_color_format());
+	streamfx::obs::gs::effect effect = _data->get_effect(format);
 	auto                      kernel = _data->get_kernel(size_t(_size));
+	::streamfx::gfx::blur::ensure_format(_rendertarget, format);
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -567,18 +537,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 	float_t height = float_t(_input_texture->get_height());
 
 	// Setup
-	gs_set_cull_mode(GS_NEITHER);
-	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
-	gs_depth_function(GS_ALWAYS);
-	gs_blend_state_push();
-	gs_reset_blend_state();
-	gs_enable_blending(false);
-	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-	gs_enable_stencil_test(false);
-	gs_enable_stencil_write(false);
-	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
-	gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
+	auto state = ::streamfx::obs::gs::renderstate::overwrite().apply();
 
 	effect.get_parameter("pImage").set_texture(_input_texture);
 	effect.get_parameter("pImageTexel").set_float2(float_t(1.f / width), float_t(1.f / height));
@@ -596,8 +555,6 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_zoom
 		}
 	}
 
-	gs_blend_state_pop();
-
 	return this->get();
 }
 
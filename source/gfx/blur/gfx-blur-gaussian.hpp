@@ -18,15 +18,15 @@
 namespace streamfx::gfx {
 	namespace blur {
 		class gaussian_data {
-			streamfx::obs::gs::effect            _effect;
-			std::shared_ptr<streamfx::gfx::util> _gfx_util;
-			std::map<size_t, std::vector<float>> _kernels;
+			std::shared_ptr<streamfx::obs::gs::effect_permutations> _effects;
+			std::shared_ptr<streamfx::gfx::util>                    _gfx_util;
+			std::map<size_t, std::vector<float>>                    _kernels;
 
 			public:
 			gaussian_data();
 			virtual ~gaussian_data();
 
-			streamfx::obs::gs::effect get_effect();
+			streamfx::obs::gs::effect get_effect(gs_color_format format);
 
 			std::shared_ptr<streamfx::gfx::util> get_gfx_util();
 
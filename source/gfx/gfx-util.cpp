@@ -40,7 +40,7 @@ std::shared_ptr<streamfx::gfx::util> streamfx::gfx::util::get()
 	return instance.lock();
 }
 
-streamfx::gfx::util::util()
+streamfx::gfx::util::util() : _batch_depth(0)
 {
 	{
 		std::filesystem::path file = ::streamfx::data_file_path("effects/standard.effect");
@@ -60,10 +60,80 @@ streamfx::gfx::util::~util()
 	_line_vb.reset();
 	_arrow_vb.reset();
 	_quad_vb.reset();
+	_batch_points.vb.reset();
+	_batch_lines.vb.reset();
+	_batch_triangles.vb.reset();
+}
+
+void streamfx::gfx::util::begin_batch()
+{
+	_batch_depth++;
+}
+
+void streamfx::gfx::util::end_batch()
+{
+	if ((_batch_depth == 0) || (--_batch_depth > 0)) {
+		return;
+	}
+
+	obs::gs::context gctx{};
+	flush(_batch_triangles, GS_TRIS);
+	flush(_batch_lines, GS_LINES);
+	flush(_batch_points, GS_POINTS);
+}
+
+void streamfx::gfx::util::batch(batch_list& list, const vec3* positions, std::size_t count, uint32_t color)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		batch_vertex vtx;
+		vec3_copy(&vtx.position, &positions[idx]);
+		vtx.color = color;
+		list.vertices.push_back(vtx);
+	}
+}
+
+void streamfx::gfx::util::flush(batch_list& list, gs_draw_mode mode)
+{
+	if (list.vertices.empty() || !_effect) {
+		list.vertices.clear();
+		return;
+	}
+
+	// Grow in large steps, so that a busy overlay doesn't recreate the buffer every frame.
+	auto count = static_cast<uint32_t>(list.vertices.size());
+	if (!list.vb || (list.vb->capacity() < count)) {
+		uint32_t capacity = 256;
+		while (capacity < count) {
+			capacity *= 2;
+		}
+		list.vb = std::make_shared<obs::gs::vertex_buffer>(capacity, uint8_t{1});
+	}
+
+	list.vb->resize(count);
+	for (uint32_t idx = 0; idx < count; idx++) {
+		auto vtx = list.vb->at(idx);
+		vec3_copy(vtx.position, &list.vertices[idx].position);
+		*vtx.color = list.vertices[idx].color;
+	}
+	list.vertices.clear();
+
+	gs_load_indexbuffer(nullptr);
+	gs_load_vertexbuffer(list.vb->update(true));
+	while (gs_effect_loop(_effect->get_object(), "Color")) {
+		gs_draw(mode, 0, count);
+	}
+	gs_load_vertexbuffer(nullptr);
 }
 
 void streamfx::gfx::util::draw_point(float x, float y, uint32_t color)
 {
+	if (_batch_depth > 0) {
+		vec3 pos;
+		vec3_set(&pos, x, y, 0.);
+		batch(_batch_points, &pos, 1, color);
+		return;
+	}
+
 	obs::gs::context gctx{};
 
 	if (!_point_vb) {
@@ -86,6 +156,14 @@ void streamfx::gfx::util::draw_point(float x, float y, uint32_t color)
 
 void streamfx::gfx::util::draw_line(float x, float y, float x2, float y2, uint32_t color /*= 0xFFFFFFFF*/)
 {
+	if (_batch_depth > 0) {
+		vec3 pos[2];
+		vec3_set(&pos[0], x, y, 0.);
+		vec3_set(&pos[1], x2, y2, 0.);
+		batch(_batch_lines, pos, 2, color);
+		return;
+	}
+
 	obs::gs::context gctx{};
 
 	if (!_line_vb) {
@@ -113,12 +191,6 @@ void streamfx::gfx::util::draw_line(float x, float y, float x2, float y2, uint32
 
 void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float w /*= 0.*/, uint32_t color /*= 0xFFFFFFFF*/)
 {
-	obs::gs::context gctx{};
-
-	if (!_arrow_vb) {
-		_arrow_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
-	}
-
 	float dx  = x2 - x;
 	float dy  = y2 - y;
 	float ang = atan2(-dx, dy);
@@ -134,39 +206,33 @@ void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float
 	vec3 offset;
 	vec3_set(&offset, x, y, 0.);
 
-	{
-		auto vtx = _arrow_vb->at(0);
-		vec3_set(vtx.position, 0, 0, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+	// Shaft, then the head from its tip and back.
+	vec3 pos[5];
+	vec3_set(&pos[0], 0, 0, 0.);
+	vec3_set(&pos[1], 0, len, 0.);
+	vec3_set(&pos[2], -w, len - w, 0.);
+	vec3_set(&pos[3], w, len - w, 0.);
+	vec3_set(&pos[4], 0, len, 0.);
+	for (auto& v : pos) {
+		vec3_transform(&v, &v, &rotator);
+		vec3_add(&v, &v, &offset);
 	}
-	{
-		auto vtx = _arrow_vb->at(1);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
-	}
-	{
-		auto vtx = _arrow_vb->at(2);
-		vec3_set(vtx.position, -w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+
+	if (_batch_depth > 0) {
+		vec3 segments[8] = {pos[0], pos[1], pos[1], pos[2], pos[2], pos[3], pos[3], pos[4]};
+		batch(_batch_lines, segments, 8, color);
+		return;
 	}
-	{
-		auto vtx = _arrow_vb->at(3);
-		vec3_set(vtx.position, w, len - w, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
-		*vtx.color = color;
+
+	obs::gs::context gctx{};
+
+	if (!_arrow_vb) {
+		_arrow_vb = std::make_shared<obs::gs::vertex_buffer>(uint32_t{5}, uint8_t{1});
 	}
-	{
-		auto vtx = _arrow_vb->at(4);
-		vec3_set(vtx.position, 0, len, 0.);
-		vec3_transform(vtx.position, vtx.position, &rotator);
-		vec3_add(vtx.position, vtx.position, &offset);
+
+	for (uint32_t idx = 0; idx < 5; idx++) {
+		auto vtx = _arrow_vb->at(idx);
+		vec3_copy(vtx.position, &pos[idx]);
 		*vtx.color = color;
 	}
 
@@ -180,6 +246,22 @@ void streamfx::gfx::util::draw_arrow(float x, float y, float x2, float y2, float
 
 void streamfx::gfx::util::draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color /*= 0xFFFFFFFF*/)
 {
+	if (_batch_depth > 0) {
+		vec3 tl, tr, bl, br;
+		vec3_set(&tl, x, y, 0.);
+		vec3_set(&tr, x + w, y, 0.);
+		vec3_set(&bl, x, y + h, 0.);
+		vec3_set(&br, x + w, y + h, 0.);
+		if (frame) {
+			vec3 segments[8] = {tl, tr, tr, br, br, bl, bl, tl};
+			batch(_batch_lines, segments, 8, color);
+		} else {
+			vec3 triangles[6] = {tl, tr, bl, bl, tr, br};
+			batch(_batch_triangles, triangles, 6, color);
+		}
+		return;
+	}
+
 	obs::gs::context gctx{};
 
 	if (!_quad_vb) {
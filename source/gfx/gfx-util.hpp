@@ -8,6 +8,7 @@
 
 #include "warning-disable.hpp"
 #include <memory>
+#include <vector>
 #include "warning-enable.hpp"
 
 namespace streamfx::gfx {
@@ -19,6 +20,20 @@ namespace streamfx::gfx {
 		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _quad_vb;
 		std::shared_ptr<::streamfx::obs::gs::vertex_buffer> _fstri_vb;
 
+		// Batched debug drawing, one upload and draw per primitive type.
+		struct batch_vertex {
+			vec3     position;
+			uint32_t color;
+		};
+		struct batch_list {
+			std::vector<batch_vertex>                           vertices;
+			std::shared_ptr<::streamfx::obs::gs::vertex_buffer> vb;
+		};
+		uint32_t   _batch_depth;
+		batch_list _batch_points;
+		batch_list _batch_lines;
+		batch_list _batch_triangles;
+
 		public /* Singleton */:
 		static std::shared_ptr<streamfx::gfx::util> get();
 
@@ -28,6 +43,15 @@ namespace streamfx::gfx {
 		public:
 		~util();
 
+		/** Collect all following debug drawing until end_batch, instead of drawing it right away.
+		 *
+		 * Batches may be nested, only the outermost end_batch draws. Filled shapes are drawn
+		 *  first, then lines, then points, so order is only kept within each of those.
+		 */
+		void begin_batch();
+
+		void end_batch();
+
 		void draw_point(float x, float y, uint32_t color = 0xFFFFFFFF);
 
 		void draw_line(float x, float y, float x2, float y2, uint32_t color = 0xFFFFFFFF);
@@ -37,5 +61,10 @@ namespace streamfx::gfx {
 		void draw_rectangle(float x, float y, float w, float h, bool frame, uint32_t color = 0xFFFFFFFF);
 
 		void draw_fullscreen_triangle();
+
+		private:
+		void batch(batch_list& list, const vec3* positions, std::size_t count, uint32_t color);
+
+		void flush(batch_list& list, gs_draw_mode mode);
 	};
 } // namespace streamfx::gfx
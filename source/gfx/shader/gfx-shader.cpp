@@ -6,11 +6,13 @@
 
 #include "gfx-shader.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-ledger.hpp"
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 
 #include "warning-disable.hpp"
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include "warning-enable.hpp"
@@ -30,11 +32,33 @@
 #define ST_KEY_SHADER_SIZE_WIDTH ST_KEY_SHADER_SIZE ".Width"
 #define ST_I18N_SHADER_SIZE_HEIGHT ST_I18N_SHADER_SIZE ".Height"
 #define ST_KEY_SHADER_SIZE_HEIGHT ST_KEY_SHADER_SIZE ".Height"
+#define ST_I18N_SHADER_SIZE_DYNAMIC ST_I18N_SHADER_SIZE ".Dynamic"
+#define ST_KEY_SHADER_SIZE_DYNAMIC ST_KEY_SHADER_SIZE ".Dynamic"
+#define ST_I18N_SHADER_SIZE_DYNAMIC_BUDGET ST_I18N_SHADER_SIZE_DYNAMIC ".Budget"
+#define ST_KEY_SHADER_SIZE_DYNAMIC_BUDGET ST_KEY_SHADER_SIZE_DYNAMIC ".Budget"
+#define ST_I18N_SHADER_SIZE_DYNAMIC_MINIMUM ST_I18N_SHADER_SIZE_DYNAMIC ".Minimum"
+#define ST_KEY_SHADER_SIZE_DYNAMIC_MINIMUM ST_KEY_SHADER_SIZE_DYNAMIC ".Minimum"
+#define ST_I18N_SHADER_SIZE_DYNAMIC_MAXIMUM ST_I18N_SHADER_SIZE_DYNAMIC ".Maximum"
+#define ST_KEY_SHADER_SIZE_DYNAMIC_MAXIMUM ST_KEY_SHADER_SIZE_DYNAMIC ".Maximum"
+#define ST_I18N_SHADER_DECIMATION ST_I18N_SHADER ".Decimation"
+#define ST_KEY_SHADER_DECIMATION ST_KEY_SHADER ".Decimation"
+#define ST_I18N_SHADER_DECIMATION_MODE ST_I18N_SHADER_DECIMATION ".Mode"
+#define ST_I18N_SHADER_DECIMATION_MODE_(x) ST_I18N_SHADER_DECIMATION_MODE "." x
+#define ST_KEY_SHADER_DECIMATION_MODE ST_KEY_SHADER_DECIMATION ".Mode"
+#define ST_I18N_SHADER_DECIMATION_FRAMES ST_I18N_SHADER_DECIMATION ".Frames"
+#define ST_KEY_SHADER_DECIMATION_FRAMES ST_KEY_SHADER_DECIMATION ".Frames"
+#define ST_I18N_SHADER_DECIMATION_FRAMERATE ST_I18N_SHADER_DECIMATION ".Framerate"
+#define ST_KEY_SHADER_DECIMATION_FRAMERATE ST_KEY_SHADER_DECIMATION ".Framerate"
+#define ST_I18N_SHADER_DECIMATION_BLEND ST_I18N_SHADER_DECIMATION ".Blend"
+#define ST_KEY_SHADER_DECIMATION_BLEND ST_KEY_SHADER_DECIMATION ".Blend"
 #define ST_I18N_SHADER_SEED ST_I18N_SHADER ".Seed"
 #define ST_KEY_SHADER_SEED ST_KEY_SHADER ".Seed"
 #define ST_I18N_PARAMETERS ST_I18N ".Parameters"
 #define ST_KEY_PARAMETERS "Shader.Parameters"
 
+// Dynamic resolution changes in steps of this size, so that the render target isn't recreated every frame.
+#define ST_DYNAMIC_STEP 0.05
+
 streamfx::gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
 	: _self(self), _gfx_util(::streamfx::gfx::util::get()), _mode(mode), _base_width(1), _base_height(1), _active(true),
 
@@ -42,18 +66,35 @@ streamfx::gfx::shader::shader::shader(obs_source_t* self, shader_mode mode)
 
 	  _width_type(size_type::Percent), _width_value(1.0), _height_type(size_type::Percent), _height_value(1.0),
 
+	  _dynamic(false), _dynamic_budget(0), _dynamic_minimum(1.0), _dynamic_maximum(1.0), _dynamic_scale(1.0), _dynamic_settle(0), _dynamic_timer(),
+
+	  _decimation(decimation_mode::None), _decimation_frames(1), _decimation_rate(0.), _decimation_blend(false), _decimation_count(0), _decimation_elapsed(0.), _decimation_skip(false), _decimation_effect(),
+
+	  _degraded_scale(1.0), _degraded_cached(false),
+
 	  _have_current_params(false), _time(0), _time_loop(0), _loops(0), _random(), _random_seed(0),
 
-	  _rt_up_to_date(false), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE))
+	  _rt_up_to_date(false), _rt(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE)), _rt_previous()
 {
 	// Initialize random values.
 	_random.seed(static_cast<unsigned long long>(_random_seed));
 	for (size_t idx = 0; idx < 16; idx++) {
 		_random_values[idx] = static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
+
+	// The cached output is simply rendered again on the next frame.
+	streamfx::obs::gs::ledger::instance()->set_evictor(_self, [this]() {
+		auto gctx      = streamfx::obs::gs::context();
+		_rt            = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+		_rt_previous.reset();
+		_rt_up_to_date = false;
+	});
 }
 
-streamfx::gfx::shader::shader::~shader() = default;
+streamfx::gfx::shader::shader::~shader()
+{
+	streamfx::obs::gs::ledger::instance()->remove_owner(_self);
+}
 
 bool streamfx::gfx::shader::shader::is_shader_different(const std::filesystem::path& file)
 {
@@ -176,9 +217,34 @@ void streamfx::gfx::shader::shader::defaults(obs_data_t* data)
 	obs_data_set_default_string(data, ST_KEY_SHADER_TECHNIQUE, "");
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_WIDTH, "100.0 %");
 	obs_data_set_default_string(data, ST_KEY_SHADER_SIZE_HEIGHT, "100.0 %");
+	obs_data_set_default_bool(data, ST_KEY_SHADER_SIZE_DYNAMIC, false);
+	obs_data_set_default_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_BUDGET, 4.0);
+	obs_data_set_default_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_MINIMUM, 50.0);
+	obs_data_set_default_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_MAXIMUM, 100.0);
+	obs_data_set_default_int(data, ST_KEY_SHADER_DECIMATION_MODE, static_cast<long long>(decimation_mode::None));
+	obs_data_set_default_int(data, ST_KEY_SHADER_DECIMATION_FRAMES, 2);
+	obs_data_set_default_double(data, ST_KEY_SHADER_DECIMATION_FRAMERATE, 30.0);
+	obs_data_set_default_bool(data, ST_KEY_SHADER_DECIMATION_BLEND, false);
 	obs_data_set_default_int(data, ST_KEY_SHADER_SEED, static_cast<long long>(time(NULL)));
 }
 
+static bool modified_decimation(obs_properties_t* props, obs_property_t*, obs_data_t* settings) noexcept
+{
+	try {
+		auto mode = static_cast<streamfx::gfx::shader::decimation_mode>(obs_data_get_int(settings, ST_KEY_SHADER_DECIMATION_MODE));
+		obs_property_set_visible(obs_properties_get(props, ST_KEY_SHADER_DECIMATION_FRAMES), mode == streamfx::gfx::shader::decimation_mode::Frames);
+		obs_property_set_visible(obs_properties_get(props, ST_KEY_SHADER_DECIMATION_FRAMERATE), mode == streamfx::gfx::shader::decimation_mode::Framerate);
+		obs_property_set_visible(obs_properties_get(props, ST_KEY_SHADER_DECIMATION_BLEND), mode != streamfx::gfx::shader::decimation_mode::None);
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+		return false;
+	} catch (...) {
+		DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+		return false;
+	}
+}
+
 void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
 {
 	_have_current_params = false;
@@ -215,6 +281,45 @@ void streamfx::gfx::shader::shader::properties(obs_properties_t* pr)
 			{
 				auto p = obs_properties_add_text(grp2, ST_KEY_SHADER_SIZE_HEIGHT, D_TRANSLATE(ST_I18N_SHADER_SIZE_HEIGHT), OBS_TEXT_DEFAULT);
 			}
+			{
+				auto p = obs_properties_add_bool(grp2, ST_KEY_SHADER_SIZE_DYNAMIC, D_TRANSLATE(ST_I18N_SHADER_SIZE_DYNAMIC));
+			}
+			{
+				auto p = obs_properties_add_float_slider(grp2, ST_KEY_SHADER_SIZE_DYNAMIC_BUDGET, D_TRANSLATE(ST_I18N_SHADER_SIZE_DYNAMIC_BUDGET), 0.1, 100.0, 0.1);
+				obs_property_float_set_suffix(p, " ms");
+			}
+			{
+				auto p = obs_properties_add_float_slider(grp2, ST_KEY_SHADER_SIZE_DYNAMIC_MINIMUM, D_TRANSLATE(ST_I18N_SHADER_SIZE_DYNAMIC_MINIMUM), 10.0, 100.0, 5.0);
+				obs_property_float_set_suffix(p, " %");
+			}
+			{
+				auto p = obs_properties_add_float_slider(grp2, ST_KEY_SHADER_SIZE_DYNAMIC_MAXIMUM, D_TRANSLATE(ST_I18N_SHADER_SIZE_DYNAMIC_MAXIMUM), 10.0, 100.0, 5.0);
+				obs_property_float_set_suffix(p, " %");
+			}
+		}
+
+		if (_mode != shader_mode::Transition) {
+			auto grp2 = obs_properties_create();
+			obs_properties_add_group(grp, ST_KEY_SHADER_DECIMATION, D_TRANSLATE(ST_I18N_SHADER_DECIMATION), OBS_GROUP_NORMAL, grp2);
+
+			{
+				auto p = obs_properties_add_list(grp2, ST_KEY_SHADER_DECIMATION_MODE, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_MODE), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+				obs_property_set_modified_callback(p, modified_decimation);
+				obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_MODE_("None")), static_cast<long long>(decimation_mode::None));
+				obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_MODE_("Frames")), static_cast<long long>(decimation_mode::Frames));
+				obs_property_list_add_int(p, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_MODE_("Framerate")), static_cast<long long>(decimation_mode::Framerate));
+			}
+			{
+				auto p = obs_properties_add_int_slider(grp2, ST_KEY_SHADER_DECIMATION_FRAMES, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_FRAMES), 2, 60, 1);
+				obs_property_int_set_suffix(p, " frames");
+			}
+			{
+				auto p = obs_properties_add_float_slider(grp2, ST_KEY_SHADER_DECIMATION_FRAMERATE, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_FRAMERATE), 1.0, 120.0, 0.01);
+				obs_property_float_set_suffix(p, " FPS");
+			}
+			{
+				auto p = obs_properties_add_bool(grp2, ST_KEY_SHADER_DECIMATION_BLEND, D_TRANSLATE(ST_I18N_SHADER_DECIMATION_BLEND));
+			}
 		}
 
 		{
@@ -339,6 +444,31 @@ void streamfx::gfx::shader::shader::update(obs_data_t* data)
 		_height_value = std::clamp(sz_y.second, 0.01, 8192.0);
 	}
 
+	{
+		_dynamic         = obs_data_get_bool(data, ST_KEY_SHADER_SIZE_DYNAMIC);
+		_dynamic_budget  = std::chrono::nanoseconds(static_cast<int64_t>(obs_data_get_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_BUDGET) * 1000000.0));
+		_dynamic_minimum = std::clamp(obs_data_get_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_MINIMUM) / 100.0, 0.1, 1.0);
+		_dynamic_maximum = std::clamp(obs_data_get_double(data, ST_KEY_SHADER_SIZE_DYNAMIC_MAXIMUM) / 100.0, _dynamic_minimum, 1.0);
+		_dynamic_scale   = _dynamic ? std::clamp(_dynamic_scale, _dynamic_minimum, _dynamic_maximum) : 1.0;
+	}
+
+	if (_mode != shader_mode::Transition) {
+		_decimation        = static_cast<decimation_mode>(obs_data_get_int(data, ST_KEY_SHADER_DECIMATION_MODE));
+		_decimation_frames = static_cast<uint32_t>(std::clamp<long long>(obs_data_get_int(data, ST_KEY_SHADER_DECIMATION_FRAMES), 1, 60));
+		_decimation_rate   = std::clamp(obs_data_get_double(data, ST_KEY_SHADER_DECIMATION_FRAMERATE), 1.0, 120.0);
+		_decimation_blend  = (_decimation != decimation_mode::None) && obs_data_get_bool(data, ST_KEY_SHADER_DECIMATION_BLEND);
+
+		if (_decimation_blend && !_decimation_effect) {
+			try {
+				auto gctx          = streamfx::obs::gs::context();
+				_decimation_effect = streamfx::obs::gs::effect(streamfx::data_file_path("effects/standard.effect"));
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Failed to load effect for blending decimated frames: %s", ex.what());
+				_decimation_blend = false;
+			}
+		}
+	}
+
 	if (int32_t seed = static_cast<int32_t>(obs_data_get_int(data, ST_KEY_SHADER_SEED)); _random_seed != seed) {
 		_random_seed = seed;
 		_random.seed(static_cast<unsigned long long>(_random_seed));
@@ -389,6 +519,22 @@ uint32_t streamfx::gfx::shader::shader::height()
 	}
 }
 
+uint32_t streamfx::gfx::shader::shader::render_width()
+{
+	double_t scale = (_dynamic ? _dynamic_scale : 1.0) * _degraded_scale;
+	if (scale == 1.0)
+		return width();
+	return std::max(static_cast<uint32_t>(std::lround(width() * scale)), 1u);
+}
+
+uint32_t streamfx::gfx::shader::shader::render_height()
+{
+	double_t scale = (_dynamic ? _dynamic_scale : 1.0) * _degraded_scale;
+	if (scale == 1.0)
+		return height();
+	return std::max(static_cast<uint32_t>(std::lround(height() * scale)), 1u);
+}
+
 uint32_t streamfx::gfx::shader::shader::base_width()
 {
 	return _base_width;
@@ -425,8 +571,31 @@ bool streamfx::gfx::shader::shader::tick(float_t time)
 		_random_values[8 + idx] = static_cast<float_t>(static_cast<double_t>(_random()) / static_cast<double_t>(_random.max()));
 	}
 
-	// Flag Render Target as outdated.
-	_rt_up_to_date = false;
+	// Decide whether this frame is rendered or decimated. Time keeps advancing either way, so rendered frames are always current.
+	bool due = true;
+	switch (_decimation) {
+	case decimation_mode::Frames:
+		_decimation_count++;
+		due = (_decimation_count >= _decimation_frames);
+		break;
+	case decimation_mode::Framerate:
+		_decimation_elapsed += static_cast<double_t>(time);
+		due = (_decimation_elapsed >= (1.0 / _decimation_rate));
+		break;
+	default:
+		break;
+	}
+	_decimation_skip = !due && _rt_up_to_date;
+	if (!_decimation_skip) {
+		_decimation_count = 0;
+		// Keep the remainder so that the average rate is met, but don't try to catch up on long stalls.
+		_decimation_elapsed = std::fmod(_decimation_elapsed, 1.0 / _decimation_rate);
+	}
+
+	// Flag Render Target as outdated, unless the watchdog wants us to keep it or the frame is decimated.
+	if (!_degraded_cached && !_decimation_skip) {
+		_rt_up_to_date = false;
+	}
 
 	return false;
 }
@@ -436,6 +605,10 @@ void streamfx::gfx::shader::shader::prepare_render()
 	if (!_shader)
 		return;
 
+	if (!_rt_up_to_date) {
+		update_dynamic_scale();
+	}
+
 	// Assign user parameters
 	for (auto kv : _shader_params) {
 		kv.second->assign();
@@ -451,7 +624,7 @@ void streamfx::gfx::shader::shader::prepare_render()
 	// float4 ViewSize: (Width), (Height), (1.0 / Width), (1.0 / Height)
 	if (auto el = _shader.get_parameter("ViewSize"); el != nullptr) {
 		if (el.get_type() == streamfx::obs::gs::effect_parameter::type::Float4) {
-			el.set_float4(static_cast<float_t>(width()), static_cast<float_t>(height()), 1.0f / static_cast<float_t>(width()), 1.0f / static_cast<float_t>(height()));
+			el.set_float4(static_cast<float_t>(render_width()), static_cast<float_t>(render_height()), 1.0f / static_cast<float_t>(render_width()), 1.0f / static_cast<float_t>(render_height()));
 		}
 	}
 
@@ -485,7 +658,15 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_cache, "Render Cache"};
 #endif
 
-		auto op = _rt->render(width(), height());
+		if (_decimation_blend) {
+			// Keep the last output around, to fade from it to the new one.
+			if (!_rt_previous) {
+				_rt_previous = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA_UNORM, GS_ZS_NONE);
+			}
+			std::swap(_rt, _rt_previous);
+		}
+
+		auto op = _rt->render(render_width(), render_height());
 
 		vec4 zero = {0, 0, 0, 0};
 		gs_clear(GS_CLEAR_COLOR, &zero, 0, 0);
@@ -503,9 +684,15 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 		bool old_srgb = gs_framebuffer_srgb_enabled();
 		gs_enable_framebuffer_srgb(false);
 
+		if (_dynamic && _dynamic_timer) {
+			_dynamic_timer->begin();
+		}
 		while (gs_effect_loop(_shader.get_object(), _shader_tech.c_str())) {
 			_gfx_util->draw_fullscreen_triangle();
 		}
+		if (_dynamic && _dynamic_timer) {
+			_dynamic_timer->end();
+		}
 
 		// Restore sRGB Status
 		gs_enable_framebuffer_srgb(old_srgb);
@@ -521,6 +708,24 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_render, "Draw Cache"};
 #endif
 
+		if (_decimation_blend && _decimation_effect && _rt_previous && _rt_previous->get_object()) {
+			// Fade from the previous to the latest output over the decimation interval, which delays the output by one interval.
+			float_t factor = 1.0f;
+			if (_decimation == decimation_mode::Frames) {
+				factor = static_cast<float_t>(_decimation_count) / static_cast<float_t>(_decimation_frames);
+			} else if (_decimation == decimation_mode::Framerate) {
+				factor = static_cast<float_t>(_decimation_elapsed * _decimation_rate);
+			}
+
+			_decimation_effect.get_parameter("InputA").set_texture(_rt_previous->get_texture());
+			_decimation_effect.get_parameter("InputB").set_texture(tex);
+			_decimation_effect.get_parameter("Factor").set_float(std::clamp(factor, 0.0f, 1.0f));
+			while (gs_effect_loop(_decimation_effect.get_object(), "Mix")) {
+				gs_draw_sprite(nullptr, 0, width(), height());
+			}
+			return;
+		}
+
 		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
 		while (gs_effect_loop(effect, "Draw")) {
 			gs_draw_sprite(nullptr, 0, width(), height());
@@ -528,6 +733,30 @@ void streamfx::gfx::shader::shader::render(gs_effect* effect)
 	}
 }
 
+bool streamfx::gfx::shader::shader::degrade(::streamfx::obs::degradation level)
+{
+	switch (level) {
+	case ::streamfx::obs::degradation::None:
+		_degraded_scale  = 1.0;
+		_degraded_cached = false;
+		return true;
+	case ::streamfx::obs::degradation::Resolution:
+		_degraded_scale  = 0.5;
+		_degraded_cached = false;
+		return true;
+	case ::streamfx::obs::degradation::Cached:
+		_degraded_cached = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool streamfx::gfx::shader::shader::is_cached()
+{
+	return (_degraded_cached || _decimation_skip) && _rt_up_to_date;
+}
+
 void streamfx::gfx::shader::shader::set_size(uint32_t w, uint32_t h)
 {
 	_base_width  = w;
@@ -620,6 +849,41 @@ void streamfx::gfx::shader::shader::set_active(bool active)
 	}
 }
 
+void streamfx::gfx::shader::shader::update_dynamic_scale()
+{
+	if (!_dynamic) {
+		_dynamic_timer.reset();
+		return;
+	}
+
+	if (!_dynamic_timer) {
+		_dynamic_timer  = std::make_shared<streamfx::obs::gs::timer>();
+		_dynamic_settle = 0;
+	}
+
+	std::chrono::nanoseconds duration;
+	if (!_dynamic_timer->get(duration) || (duration.count() <= 0)) {
+		return;
+	}
+
+	// Measurements still in flight were taken at the previous scale.
+	if (_dynamic_settle > 0) {
+		_dynamic_settle--;
+		return;
+	}
+
+	// GPU time is roughly proportional to the number of pixels, which is the square of the scale.
+	double_t target = _dynamic_scale * std::sqrt(static_cast<double_t>(_dynamic_budget.count()) / static_cast<double_t>(duration.count()));
+
+	// Only go half way to avoid oscillating, and snap to steps.
+	double_t scale = _dynamic_scale + (target - _dynamic_scale) * 0.5;
+	scale          = std::clamp(std::round(scale / ST_DYNAMIC_STEP) * ST_DYNAMIC_STEP, _dynamic_minimum, _dynamic_maximum);
+	if (std::abs(scale - _dynamic_scale) > (ST_DYNAMIC_STEP / 2.)) {
+		_dynamic_scale  = scale;
+		_dynamic_settle = 2;
+	}
+}
+
 obs_source_t* streamfx::gfx::shader::shader::get()
 {
 	return _self;
@@ -10,8 +10,11 @@
 #include "gfx/shader/gfx-shader-param.hpp"
 #include "obs/gs/gs-effect.hpp"
 #include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-timer.hpp"
+#include "obs/obs-watchdog.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
 #include <filesystem>
 #include <list>
 #include <map>
@@ -25,6 +28,12 @@ namespace streamfx::gfx {
 			Percent,
 		};
 
+		enum class decimation_mode {
+			None,
+			Frames,
+			Framerate,
+		};
+
 		enum class shader_mode {
 			Source,
 			Filter,
@@ -60,6 +69,29 @@ namespace streamfx::gfx {
 			size_type _height_type;
 			double_t  _height_value;
 
+			// Dynamic Resolution
+			bool                                      _dynamic;
+			std::chrono::nanoseconds                  _dynamic_budget;
+			double_t                                  _dynamic_minimum;
+			double_t                                  _dynamic_maximum;
+			double_t                                  _dynamic_scale;
+			std::size_t                               _dynamic_settle;
+			std::shared_ptr<streamfx::obs::gs::timer> _dynamic_timer;
+
+			// Decimation
+			decimation_mode           _decimation;
+			uint32_t                  _decimation_frames;
+			double_t                  _decimation_rate;
+			bool                      _decimation_blend;
+			uint32_t                  _decimation_count;
+			double_t                  _decimation_elapsed;
+			bool                      _decimation_skip;
+			streamfx::obs::gs::effect _decimation_effect;
+
+			// Watchdog
+			double_t _degraded_scale;
+			bool     _degraded_cached;
+
 			// Cache
 			bool            _have_current_params;
 			float_t         _time;
@@ -72,6 +104,7 @@ namespace streamfx::gfx {
 			// Rendering
 			bool                                             _rt_up_to_date;
 			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
+			std::shared_ptr<streamfx::obs::gs::rendertarget> _rt_previous; // Faded from when decimating.
 
 			public:
 			shader(obs_source_t* self, shader_mode mode);
@@ -103,16 +136,33 @@ namespace streamfx::gfx {
 
 			uint32_t base_height();
 
+			/** Size the shader is actually rendered at, which may be lower than width() and height() with dynamic resolution.
+			 */
+			uint32_t render_width();
+
+			uint32_t render_height();
+
 			bool tick(float_t time);
 
 			void prepare_render();
 
 			void render(gs_effect* effect);
 
+			/** Degrade rendering on request of the watchdog. Supports reduced resolution and cached output.
+			 */
+			bool degrade(::streamfx::obs::degradation level);
+
+			/** Whether the last output is reused, either on request of the watchdog or because the frame was decimated, so that inputs don't need to be rendered.
+			 */
+			bool is_cached();
+
 			obs_source_t* get();
 
 			std::filesystem::path get_shader_file();
 
+			private:
+			void update_dynamic_scale();
+
 			public:
 			void set_size(uint32_t w, uint32_t h);
 
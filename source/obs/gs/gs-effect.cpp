@@ -4,19 +4,44 @@
 // AUTOGENERATED COPYRIGHT HEADER END
 
 #include "gs-effect.hpp"
+#include "configuration.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-lifecycle.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
 #include "util/util-platform.hpp"
 
 #include "warning-disable.hpp"
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 #include "warning-enable.hpp"
 
+#include "warning-disable.hpp"
+#if defined(D_PLATFORM_WINDOWS)
+#include <d3d11.h>
+#endif
+#include "warning-enable.hpp"
+
 #define MAX_EFFECT_SIZE 32 * 1024 * 1024 // 32 MiB, big enough for everything.
 
-static std::string load_file_as_code(const std::filesystem::path& shader_file, bool is_top_level = true)
+#define ST_CFG_HALFPRECISION "Graphics.HalfPrecision"
+#define ST_CFG_PERMUTATIONS "Graphics.Permutations"
+
+// Pixels rendered by the precision check, and how far apart the results may be (one 8-bit step).
+static constexpr uint32_t precision_test_width     = 256;
+static constexpr float    precision_test_tolerance = 1.f / 255.f;
+
+// Decided once while loading, before any effect is compiled.
+static std::atomic<bool> half_precision{false};
+static std::atomic<bool> permutations_enabled{true};
+
+static std::string load_file_as_code(const std::filesystem::path& shader_file, const streamfx::obs::gs::effect::defines_t& defines = {}, bool is_top_level = true)
 {
 	std::stringstream           shader_stream;
 	const std::filesystem::path shader_path = std::filesystem::absolute(shader_file.native());
@@ -46,6 +71,14 @@ static std::string load_file_as_code(const std::filesystem::path& shader_file, b
 			shader_stream << "#define GS_DEVICE_OPENGL" << std::endl;
 			break;
 		}
+		if (streamfx::obs::gs::effect::is_half_precision()) {
+			shader_stream << "#define GS_PRECISION_HALF" << std::endl;
+		}
+
+		// Defines selecting a permutation.
+		for (const auto& kv : defines) {
+			shader_stream << "#define " << kv.first << " " << kv.second << std::endl;
+		}
 	}
 
 	// Pre-process the shader.
@@ -76,7 +109,7 @@ static std::string load_file_as_code(const std::filesystem::path& shader_file, b
 				include_path = shader_root / include_str;
 			}
 
-			line = load_file_as_code(include_path, false);
+			line = load_file_as_code(include_path, {}, false);
 		}
 
 		shader_stream << line << std::endl;
@@ -96,17 +129,95 @@ streamfx::obs::gs::effect::effect(std::string_view code, std::string_view name)
 		throw error_buffer ? std::runtime_error(error_buffer) : std::runtime_error("Unknown error during effect compile.");
 	}
 
-	reset(effect, [](gs_effect_t* ptr) { gs_effect_destroy(ptr); });
+	reset(effect, [lifecycle = streamfx::obs::gs::lifecycle::instance()](gs_effect_t* ptr) { lifecycle->destroy(ptr, [](void* object) { gs_effect_destroy(static_cast<gs_effect_t*>(object)); }); });
 }
 
 streamfx::obs::gs::effect::effect(std::filesystem::path file) : effect(load_file_as_code(file), streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string()) {}
 
+streamfx::obs::gs::effect::effect(std::filesystem::path file, const defines_t& defines) : effect(load_file_as_code(file, defines), streamfx::util::platform::utf8_to_native(std::filesystem::absolute(file)).generic_u8string() + "?" + effect_permutations::key(defines)) {}
+
 streamfx::obs::gs::effect::~effect()
 {
-	auto gctx = streamfx::obs::gs::context();
 	reset();
 }
 
+bool streamfx::obs::gs::effect::is_half_precision()
+{
+	return half_precision.load();
+}
+
+static bool is_half_precision_supported()
+{
+#if defined(D_PLATFORM_WINDOWS)
+	if (gs_get_device_type() == GS_DEVICE_DIRECT3D_11) {
+		D3D11_FEATURE_DATA_SHADER_MIN_PRECISION_SUPPORT info = {};
+		if (auto device = reinterpret_cast<ID3D11Device*>(gs_get_device_obj()); device && SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_SHADER_MIN_PRECISION_SUPPORT, &info, sizeof(info)))) {
+			return (info.PixelShaderMinPrecision & D3D11_SHADER_MIN_PRECISION_16_BIT) != 0;
+		}
+	}
+#endif
+	// libOBS translates effects to GLSL without precision qualifiers, and desktop OpenGL ignores them anyway.
+	return false;
+}
+
+static std::vector<float> render_precision_test(const streamfx::obs::gs::effect::defines_t& defines)
+{
+	auto effect = streamfx::obs::gs::effect(streamfx::data_file_path("effects/precision-test.effect"), defines);
+	auto rt     = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA32F, GS_ZS_NONE);
+	{
+		auto op = rt->render(precision_test_width, 1);
+		gs_ortho(0, 1, 0, 1, 0, 1);
+
+		gs_blend_state_push();
+		gs_enable_color(true, true, true, true);
+		gs_enable_blending(false);
+		gs_enable_depth_test(false);
+		gs_enable_stencil_test(false);
+		gs_set_cull_mode(GS_NEITHER);
+		while (gs_effect_loop(effect.get_object(), "Draw")) {
+			gs_draw_sprite(nullptr, 0, 1, 1);
+		}
+		gs_blend_state_pop();
+	}
+
+	std::shared_ptr<gs_stagesurf_t> stage{gs_stagesurface_create(precision_test_width, 1, GS_RGBA32F), [](gs_stagesurf_t* v) { gs_stagesurface_destroy(v); }};
+	if (!stage) {
+		throw std::runtime_error("Failed to create staging surface.");
+	}
+	gs_stage_texture(stage.get(), rt->get_texture()->get_object());
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (!gs_stagesurface_map(stage.get(), &data, &linesize)) {
+		throw std::runtime_error("Failed to map staging surface.");
+	}
+	std::vector<float> result(reinterpret_cast<float*>(data), reinterpret_cast<float*>(data) + precision_test_width * 4);
+	gs_stagesurface_unmap(stage.get());
+	return result;
+}
+
+static bool verify_half_precision()
+{
+	// Drivers may implement 16-bit minimum precision with less accuracy than needed, so compare against float.
+	try {
+		auto reference = render_precision_test({});
+		auto reduced   = render_precision_test({{"GS_PRECISION_HALF", ""}});
+
+		float error = 0.f;
+		for (std::size_t idx = 0; idx < reference.size(); idx++) {
+			error = std::max(error, std::fabs(reference[idx] - reduced[idx]));
+		}
+		if (error > precision_test_tolerance) {
+			DLOG_WARNING("16-bit shader precision is off by up to %f, which is more than the allowed %f.", error, precision_test_tolerance);
+			return false;
+		}
+		return true;
+	} catch (const std::exception& ex) {
+		DLOG_WARNING("Failed to check 16-bit shader precision: %s", ex.what());
+		return false;
+	}
+}
+
 std::size_t streamfx::obs::gs::effect::count_techniques()
 {
 	return static_cast<size_t>(get()->techniques.num);
@@ -180,3 +291,144 @@ bool streamfx::obs::gs::effect::has_parameter(std::string_view name, effect_para
 		return eprm.get_type() == type;
 	return false;
 }
+
+streamfx::obs::gs::effect_permutations::~effect_permutations()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	if (_variants.size() > 1) {
+		DLOG_DEBUG("Used %zu permutations of '%s'.", _variants.size(), _file.generic_u8string().c_str());
+	}
+	for (auto& kv : _variants) {
+		if (kv.second.samples == 0) {
+			continue;
+		}
+		double average = std::chrono::duration<double, std::milli>(kv.second.total).count() / static_cast<double>(kv.second.samples);
+		DLOG_INFO("Permutation '%s' of '%s' took %.3f ms on average over %" PRIu64 " draws.", kv.first.empty() ? "generic" : kv.first.c_str(), _file.generic_u8string().c_str(), average, kv.second.samples);
+	}
+
+	// Timers own GPU queries.
+	auto gctx = streamfx::obs::gs::context();
+	_variants.clear();
+}
+
+streamfx::obs::gs::effect_permutations::effect_permutations(std::filesystem::path file) : _file(file), _lock(), _variants() {}
+
+streamfx::obs::gs::effect streamfx::obs::gs::effect_permutations::get(const effect::defines_t& defines)
+{
+	if (!permutations_enabled.load() && !defines.empty()) {
+		return get();
+	}
+
+	std::lock_guard<std::mutex> lock(_lock);
+
+	auto name = key(defines);
+	if (auto iter = _variants.find(name); iter != _variants.end()) {
+		return iter->second.effect;
+	}
+
+	streamfx::obs::gs::effect variant;
+	try {
+		variant = streamfx::obs::gs::effect::create(_file, defines);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Failed to compile permutation '%s' of '%s': %s", name.c_str(), _file.generic_u8string().c_str(), ex.what());
+	}
+	_variants.emplace(name, effect_permutations::variant{variant, nullptr, std::chrono::nanoseconds(0), 0});
+	return variant;
+}
+
+streamfx::obs::gs::effect_permutations::measure::~measure()
+{
+	if (!_variant) {
+		return;
+	}
+
+	_variant->timer->end();
+	for (std::chrono::nanoseconds duration; _variant->timer->get(duration);) {
+		_variant->total += duration;
+		_variant->samples++;
+	}
+}
+
+streamfx::obs::gs::effect_permutations::measure::measure(effect_permutations& permutations, const streamfx::obs::gs::effect& effect) : _variant(nullptr)
+{
+	if (!effect) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(permutations._lock);
+		for (auto& kv : permutations._variants) {
+			if (kv.second.effect.get() == effect.get()) {
+				_variant = &kv.second;
+				break;
+			}
+		}
+	}
+	if (!_variant) {
+		return;
+	}
+
+	if (!_variant->timer) {
+		_variant->timer = std::make_shared<streamfx::obs::gs::timer>();
+	}
+	_variant->timer->begin();
+}
+
+void streamfx::obs::gs::effect_permutations::retry()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	for (auto iter = _variants.begin(); iter != _variants.end();) {
+		if (!iter->second.effect) {
+			iter = _variants.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+std::size_t streamfx::obs::gs::effect_permutations::count()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return _variants.size();
+}
+
+std::string streamfx::obs::gs::effect_permutations::key(const effect::defines_t& defines)
+{
+	// std::map is ordered, so equal sets always produce the same key.
+	std::string result;
+	for (const auto& kv : defines) {
+		if (!result.empty()) {
+			result += ";";
+		}
+		result += kv.first + "=" + kv.second;
+	}
+	return result;
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		bool enabled = true;
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto data = config->get();
+			obs_data_set_default_bool(data.get(), ST_CFG_HALFPRECISION, true);
+			enabled = obs_data_get_bool(data.get(), ST_CFG_HALFPRECISION);
+		}
+
+		auto gctx = streamfx::obs::gs::context();
+		half_precision.store(enabled && is_half_precision_supported() && verify_half_precision());
+		DLOG_INFO("Effects use %s precision for 'real' types.", half_precision.load() ? "16-bit" : "full");
+
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto data = config->get();
+			obs_data_set_default_bool(data.get(), ST_CFG_PERMUTATIONS, true);
+			permutations_enabled.store(obs_data_get_bool(data.get(), ST_CFG_PERMUTATIONS));
+		}
+		if (!permutations_enabled.load()) {
+			DLOG_INFO("Effect permutations are disabled, only generic variants are used.", nullptr);
+		}
+	},
+	[]() { // Finalizer
+		half_precision.store(false);
+		permutations_enabled.store(true);
+	},
+	streamfx::loader_priority::HIGH);
@@ -7,18 +7,27 @@
 #include "common.hpp"
 #include "gs-effect-parameter.hpp"
 #include "gs-effect-technique.hpp"
+#include "gs-timer.hpp"
 
 #include "warning-disable.hpp"
+#include <chrono>
 #include <filesystem>
 #include <list>
+#include <map>
+#include <mutex>
+#include <string>
 #include "warning-enable.hpp"
 
 namespace streamfx::obs::gs {
 	class effect : public std::shared_ptr<gs_effect_t> {
+		public:
+		typedef std::map<std::string, std::string> defines_t;
+
 		public:
 		effect() = default;
 		effect(std::string_view code, std::string_view name);
 		effect(std::filesystem::path file);
+		effect(std::filesystem::path file, const defines_t& defines);
 		~effect();
 
 		std::size_t                         count_techniques();
@@ -32,6 +41,14 @@ namespace streamfx::obs::gs {
 		bool                                has_parameter(std::string_view name);
 		bool                                has_parameter(std::string_view name, effect_parameter::type type);
 
+		/** Whether effects are compiled with reduced precision for 'real' types, see precision.effect.
+		 *
+		 * Requires a Direct3D 11 device that supports 16-bit minimum precision in pixel shaders, and whose
+		 *  results stay within one 8-bit step of full precision in precision-test.effect. Can be turned
+		 *  off with the 'Graphics.HalfPrecision' configuration key.
+		 */
+		static bool is_half_precision();
+
 		public /* Legacy Support */:
 		inline gs_effect_t* get_object()
 		{
@@ -52,5 +69,64 @@ namespace streamfx::obs::gs {
 		{
 			return streamfx::obs::gs::effect(file);
 		};
+
+		static streamfx::obs::gs::effect create(const std::filesystem::path& file, const defines_t& defines)
+		{
+			return streamfx::obs::gs::effect(file, defines);
+		};
+	};
+
+	/** Variants of the same effect file, each compiled with a different set of defines.
+	 *
+	 * Effects that branch on uniforms which rarely change can check for a define
+	 *  instead, so that each variant only contains the code that is actually used.
+	 *  Variants are compiled the first time they are requested, and kept until
+	 *  the permutations object is destroyed.
+	 *
+	 * Draws wrapped in a measure are timed on the GPU per variant, and the averages
+	 *  are logged when the permutations object is destroyed. Turning off the
+	 *  'Graphics.Permutations' configuration key makes get() always return the
+	 *  generic variant, so the same scene can be compared against it.
+	 */
+	class effect_permutations {
+		struct variant {
+			streamfx::obs::gs::effect                 effect;
+			std::shared_ptr<streamfx::obs::gs::timer> timer;
+			std::chrono::nanoseconds                  total;
+			uint64_t                                  samples;
+		};
+
+		std::filesystem::path          _file;
+		std::mutex                     _lock;
+		std::map<std::string, variant> _variants;
+
+		public:
+		~effect_permutations();
+		effect_permutations(std::filesystem::path file);
+
+		/** Get the variant for a set of defines, compiling it if necessary.
+		 *
+		 * Must be called with the graphics context entered. If the variant fails to
+		 *  compile, the error is logged once and an empty effect is returned until retry().
+		 */
+		streamfx::obs::gs::effect get(const effect::defines_t& defines = {});
+
+		/** Forget all variants that failed to compile, so that they are compiled again on next use.
+		 */
+		void retry();
+
+		/** Measures the GPU time of everything drawn while it exists, and adds it to a variant.
+		 */
+		class measure {
+			variant* _variant;
+
+			public:
+			~measure();
+			measure(effect_permutations& permutations, const streamfx::obs::gs::effect& effect);
+		};
+
+		std::size_t count();
+
+		static std::string key(const effect::defines_t& defines);
 	};
 } // namespace streamfx::obs::gs
@@ -5,12 +5,13 @@
 #include "gs-indexbuffer.hpp"
 #include "gs-limits.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-lifecycle.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
 #include "warning-enable.hpp"
 
-streamfx::obs::gs::index_buffer::index_buffer(uint32_t maximumVertices)
+streamfx::obs::gs::index_buffer::index_buffer(uint32_t maximumVertices) : _lifecycle(streamfx::obs::gs::lifecycle::instance())
 {
 	this->reserve(maximumVertices);
 	auto gctx     = streamfx::obs::gs::context();
@@ -31,8 +32,7 @@ streamfx::obs::gs::index_buffer::index_buffer(std::vector<uint32_t>& other) : in
 
 streamfx::obs::gs::index_buffer::~index_buffer()
 {
-	auto gctx = streamfx::obs::gs::context();
-	gs_indexbuffer_destroy(_index_buffer);
+	_lifecycle->destroy(_index_buffer, [](void* ptr) { gs_indexbuffer_destroy(static_cast<gs_indexbuffer_t*>(ptr)); });
 }
 
 gs_indexbuffer_t* streamfx::obs::gs::index_buffer::get()
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gs-lifecycle.hpp"
 
 #include "warning-disable.hpp"
 #include <vector>
@@ -23,6 +24,7 @@ namespace streamfx::obs::gs {
 		gs_indexbuffer_t* get(bool refreshGPU);
 
 		protected:
-		gs_indexbuffer_t* _index_buffer;
+		gs_indexbuffer_t*                             _index_buffer;
+		std::shared_ptr<streamfx::obs::gs::lifecycle> _lifecycle;
 	};
 } // namespace streamfx::obs::gs
@@ -0,0 +1,337 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-ledger.hpp"
+#include "configuration.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <vector>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gs::ledger> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_BUDGET "GPU.MemoryBudget"
+
+// Owners that rendered more recently than this are considered in use and never evicted.
+static constexpr std::chrono::milliseconds eviction_idle{1000};
+
+// Minimum time between two evictions, so that a budget that is simply too small doesn't cause thrashing.
+static constexpr std::chrono::milliseconds eviction_interval{1000};
+
+static thread_local const void* current_owner = nullptr;
+
+static inline double to_mib(uint64_t bytes)
+{
+	return static_cast<double>(bytes) / 1048576.;
+}
+
+streamfx::obs::gs::ledger::owner_scope::owner_scope(const void* owner) : _previous(current_owner)
+{
+	current_owner = owner;
+}
+
+streamfx::obs::gs::ledger::owner_scope::~owner_scope()
+{
+	current_owner = _previous;
+}
+
+streamfx::obs::gs::ledger::~ledger() {}
+
+streamfx::obs::gs::ledger::ledger() : _lock(), _allocations(), _owners(), _usage(0), _peak(0), _budget(0), _last_eviction(), _evictions(0) {}
+
+void streamfx::obs::gs::ledger::track(const void* object, const char* kind, gs_color_format format, uint32_t width, uint32_t height, uint64_t size)
+{
+	std::unique_lock<decltype(_lock)> lock(_lock);
+
+	auto kv = _allocations.find(object);
+	if (kv != _allocations.end()) {
+		// Resized in place, the owner stays the same.
+		_usage -= kv->second.size;
+	} else {
+		kv = _allocations.emplace(object, allocation{current_owner, kind, format, 0, 0, 0}).first;
+	}
+	kv->second.format = format;
+	kv->second.width  = width;
+	kv->second.height = height;
+	kv->second.size   = size;
+
+	_usage += size;
+	_peak = std::max(_peak, _usage);
+	if ((_budget > 0) && (_usage > _budget)) {
+		mark_for_eviction();
+	}
+}
+
+void streamfx::obs::gs::ledger::untrack(const void* object)
+{
+	std::unique_lock<decltype(_lock)> lock(_lock);
+	if (auto kv = _allocations.find(object); kv != _allocations.end()) {
+		_usage -= kv->second.size;
+		_allocations.erase(kv);
+	}
+}
+
+void streamfx::obs::gs::ledger::touch(const void* owner, const char* name)
+{
+	int64_t now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+
+	// Called on every render, so the common case only needs to share the lock.
+	{
+		std::shared_lock<decltype(_lock)> lock(_lock);
+		if (auto kv = _owners.find(owner); kv != _owners.end()) {
+			kv->second.last_rendered.store(now);
+			return;
+		}
+	}
+
+	std::unique_lock<decltype(_lock)> lock(_lock);
+	auto&                             info = _owners[owner];
+	info.last_rendered.store(now);
+	if (name && info.name.empty()) {
+		info.name = name;
+	}
+}
+
+void streamfx::obs::gs::ledger::collect(const void* owner)
+{
+	if (_evictions.load() == 0) {
+		return;
+	}
+
+	evictor_t evictor;
+	{
+		std::shared_lock<decltype(_lock)> lock(_lock);
+		auto                              kv = _owners.find(owner);
+		if ((kv == _owners.end()) || !kv->second.evict.exchange(false)) {
+			return;
+		}
+		_evictions--;
+		evictor = kv->second.evictor;
+	}
+
+	if (evictor) {
+		// Evictors release resources through the gs wrappers, which take the lock again.
+		uint64_t before = get_usage();
+		try {
+			evictor();
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Evictor failed: %s", ex.what());
+		}
+		uint64_t after = get_usage();
+		D_LOG_DEBUG("Evicted an owner, releasing %.1f MiB.", to_mib(before > after ? before - after : 0));
+	}
+}
+
+void streamfx::obs::gs::ledger::set_evictor(const void* owner, evictor_t evictor)
+{
+	std::unique_lock<decltype(_lock)> lock(_lock);
+	auto&                             info = _owners[owner];
+	info.evictor                           = evictor;
+	if (info.last_rendered.load() == 0) {
+		info.last_rendered.store(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	}
+}
+
+void streamfx::obs::gs::ledger::remove_owner(const void* owner)
+{
+	std::unique_lock<decltype(_lock)> lock(_lock);
+	if (auto kv = _owners.find(owner); kv != _owners.end()) {
+		if (kv->second.evict.load()) {
+			_evictions--;
+		}
+		_owners.erase(kv);
+	}
+}
+
+void streamfx::obs::gs::ledger::set_budget(uint64_t bytes, bool persist)
+{
+	{
+		std::unique_lock<decltype(_lock)> lock(_lock);
+		_budget = bytes;
+		if ((_budget > 0) && (_usage > _budget)) {
+			_last_eviction = {};
+			mark_for_eviction();
+		}
+	}
+
+	if (persist) {
+		if (auto config = streamfx::configuration::instance(); config) {
+			obs_data_set_int(config->get().get(), ST_CFG_BUDGET, static_cast<long long>(bytes >> 20));
+			config->save();
+		}
+	}
+}
+
+uint64_t streamfx::obs::gs::ledger::get_budget()
+{
+	std::shared_lock<decltype(_lock)> lock(_lock);
+	return _budget;
+}
+
+uint64_t streamfx::obs::gs::ledger::get_usage()
+{
+	std::shared_lock<decltype(_lock)> lock(_lock);
+	return _usage;
+}
+
+uint64_t streamfx::obs::gs::ledger::get_peak()
+{
+	std::shared_lock<decltype(_lock)> lock(_lock);
+	return _peak;
+}
+
+void streamfx::obs::gs::ledger::report(bool leaks)
+{
+	struct entry {
+		std::size_t count;
+		uint64_t    size;
+	};
+	std::map<std::string, entry> per_owner;
+	uint64_t                     usage;
+	uint64_t                     peak;
+
+	{
+		std::shared_lock<decltype(_lock)> lock(_lock);
+		for (auto& kv : _allocations) {
+			std::string name = "(unknown)";
+			if (auto owner = _owners.find(kv.second.owner); (owner != _owners.end()) && !owner->second.name.empty()) {
+				name = owner->second.name;
+			} else if (kv.second.owner == nullptr) {
+				name = "(none)";
+			}
+
+			auto& e = per_owner[name];
+			e.count++;
+			e.size += kv.second.size;
+		}
+		usage = _usage;
+		peak  = _peak;
+	}
+
+	if (leaks) {
+		D_LOG_INFO("Peak usage was %.1f MiB.", to_mib(peak));
+		if (per_owner.empty()) {
+			return;
+		}
+		D_LOG_WARNING("%.1f MiB of GPU memory was not released:", to_mib(usage));
+		for (auto& kv : per_owner) {
+			D_LOG_WARNING("  '%s': %zu objects, %.1f MiB", kv.first.c_str(), kv.second.count, to_mib(kv.second.size));
+		}
+	} else {
+		D_LOG_INFO("Using %.1f MiB of GPU memory (peak %.1f MiB):", to_mib(usage), to_mib(peak));
+		for (auto& kv : per_owner) {
+			D_LOG_INFO("  '%s': %zu objects, %.1f MiB", kv.first.c_str(), kv.second.count, to_mib(kv.second.size));
+		}
+	}
+}
+
+void streamfx::obs::gs::ledger::mark_for_eviction()
+{
+	auto now = std::chrono::high_resolution_clock::now();
+	if ((now - _last_eviction) < eviction_interval) {
+		return;
+	}
+	_last_eviction = now;
+
+	// Only owners that are idle and release something are worth waiting for.
+	std::map<const void*, uint64_t> sizes;
+	for (auto& kv : _allocations) {
+		sizes[kv.second.owner] += kv.second.size;
+	}
+
+	struct candidate {
+		owner_info* info;
+		int64_t     last_rendered;
+		uint64_t    size;
+	};
+	std::vector<candidate> candidates;
+	int64_t                idle_before = (now - eviction_idle).time_since_epoch().count();
+	for (auto& kv : _owners) {
+		auto size = sizes.find(kv.first);
+		if (!kv.second.evictor || kv.second.evict.load() || (kv.first == current_owner) || (kv.second.last_rendered.load() > idle_before) || (size == sizes.end())) {
+			continue;
+		}
+		candidates.push_back({&kv.second, kv.second.last_rendered.load(), size->second});
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const candidate& a, const candidate& b) { return a.last_rendered < b.last_rendered; });
+
+	uint64_t    releasing = 0;
+	std::size_t marked    = 0;
+	for (auto& c : candidates) {
+		if ((_usage - std::min(releasing, _usage)) <= _budget) {
+			break;
+		}
+		c.info->evict.store(true);
+		_evictions++;
+		releasing += c.size;
+		marked++;
+	}
+
+	if ((_usage - std::min(releasing, _usage)) > _budget) {
+		D_LOG_WARNING("Over budget even after evicting %zu owners: %.1f MiB of %.1f MiB in use, %.1f MiB to be released.", marked, to_mib(_usage), to_mib(_budget), to_mib(releasing));
+	} else {
+		D_LOG_INFO("Evicting %zu owners on their next tick, releasing %.1f MiB.", marked, to_mib(releasing));
+	}
+}
+
+std::shared_ptr<streamfx::obs::gs::ledger> streamfx::obs::gs::ledger::instance()
+{
+	static std::weak_ptr<streamfx::obs::gs::ledger> winst;
+	static std::mutex                               mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::obs::gs::ledger>(new streamfx::obs::gs::ledger());
+		winst    = instance;
+	}
+	return instance;
+}
+
+uint64_t streamfx::obs::gs::ledger::estimate(gs_color_format format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_levels)
+{
+	uint64_t bpp   = gs_get_format_bpp(format);
+	uint64_t total = 0;
+	for (uint32_t level = 0; level < std::max<uint32_t>(mip_levels, 1); level++) {
+		total += (bpp * width * height * depth + 7) / 8;
+		width  = std::max<uint32_t>(width >> 1, 1);
+		height = std::max<uint32_t>(height >> 1, 1);
+		depth  = std::max<uint32_t>(depth >> 1, 1);
+	}
+	return total;
+}
+
+static std::shared_ptr<streamfx::obs::gs::ledger> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = streamfx::obs::gs::ledger::instance();
+
+		// Budget in MiB, 0 means unlimited. Meant for systems with little VRAM, and set from the StreamFX menu.
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto data = config->get();
+			obs_data_set_default_int(data.get(), ST_CFG_BUDGET, 0);
+			loader_instance->set_budget(static_cast<uint64_t>(std::max<long long>(obs_data_get_int(data.get(), ST_CFG_BUDGET), 0)) << 20);
+		}
+	},
+	[]() { // Finalizer
+		loader_instance->report(true);
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
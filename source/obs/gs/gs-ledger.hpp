@@ -0,0 +1,124 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include "warning-enable.hpp"
+
+/* ledger keeps track of all GPU memory allocated through the gs wrappers.
+ *
+ * Allocations are attributed to whichever owner (usually an obs_source_t) is
+ *  active on the current thread, which the source factory sets up around any
+ *  call into an instance. Owners may register an evictor that releases their
+ *  cached intermediates, which are then recreated on the next render.
+ *
+ * If a budget is configured and an allocation exceeds it, owners that haven't
+ *  rendered in a while are marked for eviction, least recently rendered first.
+ *  Evictors only ever run from the owner's own next tick or render on the
+ *  graphics thread, so they never race with the owner. Anything still
+ *  allocated when the plugin unloads is reported as a leak.
+ */
+
+namespace streamfx::obs::gs {
+	class ledger {
+		public:
+		typedef std::function<void()> evictor_t;
+
+		struct allocation {
+			const void*     owner;
+			const char*     kind;
+			gs_color_format format;
+			uint32_t        width;
+			uint32_t        height;
+			uint64_t        size;
+		};
+
+		struct owner_info {
+			std::string          name;
+			std::atomic<int64_t> last_rendered{0}; // Ticks since the clock's epoch.
+			evictor_t            evictor;
+			std::atomic<bool>    evict{false};
+		};
+
+		class owner_scope {
+			const void* _previous;
+
+			public:
+			owner_scope(const void* owner);
+			~owner_scope();
+		};
+
+		private:
+		std::shared_mutex                              _lock;
+		std::map<const void*, allocation>              _allocations;
+		std::map<const void*, owner_info>              _owners;
+		uint64_t                                       _usage;
+		uint64_t                                       _peak;
+		uint64_t                                       _budget;
+		std::chrono::high_resolution_clock::time_point _last_eviction;
+		std::atomic<std::size_t>                       _evictions;
+
+		public:
+		~ledger();
+		ledger();
+
+		/** Record or update an allocation made by the current owner.
+		 */
+		void track(const void* object, const char* kind, gs_color_format format, uint32_t width, uint32_t height, uint64_t size);
+
+		void untrack(const void* object);
+
+		/** Mark an owner as rendered just now.
+		 *
+		 * @param name Name for reports, only used the first time the owner is seen.
+		 */
+		void touch(const void* owner, const char* name);
+
+		/** Run the owner's evictor if it was marked for eviction. Must be called from the owner's own tick or render.
+		 */
+		void collect(const void* owner);
+
+		void set_evictor(const void* owner, evictor_t evictor);
+
+		/** Forget about an owner.
+		 */
+		void remove_owner(const void* owner);
+
+		/** Change the budget, and store it in the configuration if asked to.
+		 */
+		void set_budget(uint64_t bytes, bool persist = false);
+
+		uint64_t get_budget();
+
+		uint64_t get_usage();
+
+		uint64_t get_peak();
+
+		/** Log usage per owner, or only what's left over if this is the final report.
+		 */
+		void report(bool leaks);
+
+		private:
+		/** Mark owners for eviction until enough would be released. Expects the lock to be held.
+		 */
+		void mark_for_eviction();
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::obs::gs::ledger> instance();
+
+		/** Estimate the memory used by a surface, including all mip levels.
+		 */
+		static uint64_t estimate(gs_color_format format, uint32_t width, uint32_t height, uint32_t depth = 1, uint32_t mip_levels = 1);
+	};
+} // namespace streamfx::obs::gs
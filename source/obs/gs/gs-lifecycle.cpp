@@ -0,0 +1,135 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-lifecycle.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gs::lifecycle> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::obs::gs::lifecycle::~lifecycle()
+{
+	set_active(false);
+}
+
+streamfx::obs::gs::lifecycle::lifecycle() : _lock(), _queue(), _flushing(), _active(false), _immediate(0), _deferred(0), _batches(0) {}
+
+void streamfx::obs::gs::lifecycle::destroy(void* object, destroy_t destroy)
+{
+	if (!object) {
+		return;
+	}
+
+	// Already inside the graphics context, so there is nothing to save.
+	if (gs_get_context() != nullptr) {
+		destroy(object);
+		_immediate++;
+		return;
+	}
+
+	{
+		std::unique_lock<decltype(_lock)> lock(_lock);
+		if (_active) {
+			_queue.push_back({object, destroy});
+			_deferred++;
+			return;
+		}
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+	destroy(object);
+	_immediate++;
+}
+
+void streamfx::obs::gs::lifecycle::flush()
+{
+	{
+		std::unique_lock<decltype(_lock)> lock(_lock);
+		std::swap(_queue, _flushing);
+	}
+	if (_flushing.empty()) {
+		return;
+	}
+
+	for (auto& entry : _flushing) {
+		entry.destroy(entry.object);
+	}
+	_flushing.clear();
+	_batches++;
+}
+
+void streamfx::obs::gs::lifecycle::set_active(bool active)
+{
+	{
+		std::unique_lock<decltype(_lock)> lock(_lock);
+		if (_active == active) {
+			return;
+		}
+		_active = active;
+	}
+
+	if (active) {
+		obs_add_main_render_callback(on_render, this);
+	} else {
+		// Waits for a running callback to finish, so nothing is destroyed twice.
+		obs_remove_main_render_callback(on_render, this);
+
+		auto gctx = streamfx::obs::gs::context();
+		flush();
+	}
+}
+
+void streamfx::obs::gs::lifecycle::report()
+{
+	uint64_t deferred = _deferred;
+	uint64_t batches  = _batches;
+	D_LOG_INFO("Destroyed %" PRIu64 " objects right away and %" PRIu64 " in %" PRIu64 " batches, saving %" PRIu64 " graphics context entries.", _immediate.load(), deferred, batches, (deferred > batches) ? (deferred - batches) : 0);
+}
+
+void streamfx::obs::gs::lifecycle::on_render(void* data, uint32_t, uint32_t)
+{
+	// Main render callbacks run on the graphics thread with the context held, before any source renders.
+	reinterpret_cast<streamfx::obs::gs::lifecycle*>(data)->flush();
+}
+
+std::shared_ptr<streamfx::obs::gs::lifecycle> streamfx::obs::gs::lifecycle::instance()
+{
+	static std::weak_ptr<streamfx::obs::gs::lifecycle> winst;
+	static std::mutex                                  mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::obs::gs::lifecycle>(new streamfx::obs::gs::lifecycle());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::obs::gs::lifecycle> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = streamfx::obs::gs::lifecycle::instance();
+		loader_instance->set_active(true);
+	},
+	[]() { // Finalizer
+		loader_instance->set_active(false);
+		loader_instance->report();
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -0,0 +1,71 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+/* lifecycle collects the destruction of graphics objects that are released
+ *  outside of the graphics context, and destroys all of them at once when the
+ *  next frame is rendered.
+ *
+ * Releasing a texture or effect from a UI or worker thread would otherwise
+ *  take the graphics lock once per object, competing with the render thread
+ *  every time. Objects released while the graphics context is already held are
+ *  destroyed right away, as is everything once the plugin is unloading.
+ */
+
+namespace streamfx::obs::gs {
+	class lifecycle {
+		public:
+		typedef void (*destroy_t)(void* object);
+
+		private:
+		struct entry {
+			void*     object;
+			destroy_t destroy;
+		};
+
+		std::mutex         _lock;
+		std::vector<entry> _queue;
+		std::vector<entry> _flushing;
+		bool               _active;
+
+		std::atomic<uint64_t> _immediate;
+		std::atomic<uint64_t> _deferred;
+		std::atomic<uint64_t> _batches;
+
+		public:
+		~lifecycle();
+		lifecycle();
+
+		/** Destroy an object now if the graphics context is held, or with the next frame otherwise.
+		 */
+		void destroy(void* object, destroy_t destroy);
+
+		/** Destroy everything that was queued. Must be called with the graphics context held.
+		 */
+		void flush();
+
+		/** Start or stop flushing once per frame. While stopped, nothing is queued.
+		 */
+		void set_active(bool active);
+
+		/** Log how many objects were destroyed and how many graphics context entries were saved.
+		 */
+		void report();
+
+		private:
+		static void on_render(void* data, uint32_t cx, uint32_t cy);
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::obs::gs::lifecycle> instance();
+	};
+} // namespace streamfx::obs::gs
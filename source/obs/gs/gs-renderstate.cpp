@@ -0,0 +1,242 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-renderstate.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gs::renderstate> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+namespace {
+	enum field : uint32_t {
+		BLENDING         = 1 << 0,
+		BLEND_FUNCTION   = 1 << 1,
+		COLOR            = 1 << 2,
+		DEPTH_TEST       = 1 << 3,
+		DEPTH_FUNCTION   = 1 << 4,
+		STENCIL_TEST     = 1 << 5,
+		STENCIL_WRITE    = 1 << 6,
+		STENCIL_FUNCTION = 1 << 7,
+		STENCIL_OP       = 1 << 8,
+		CULL             = 1 << 9,
+
+		BLEND = BLENDING | BLEND_FUNCTION,
+		ALL   = (1 << 10) - 1,
+	};
+
+	struct tracker {
+		streamfx::obs::gs::renderstate::description        state;
+		uint32_t                                           valid;  // Fields of state that are known to be in effect.
+		std::size_t                                        depth;  // Active scopes and sessions.
+		const streamfx::obs::gs::renderstate::description* active; // Innermost block.
+	};
+
+	thread_local tracker known = {};
+
+	std::atomic<uint64_t> issued;
+	std::atomic<uint64_t> skipped;
+	std::atomic<uint64_t> elided;
+
+	// Returns true if the call can be skipped, otherwise marks the field as known and expects the caller to issue it.
+	inline bool is_known(uint32_t field, bool same)
+	{
+		if ((known.valid & field) && same) {
+			skipped++;
+			return true;
+		}
+		known.valid |= field;
+		issued++;
+		return false;
+	}
+
+	// State that has no effect is skipped as well, and left unknown.
+	inline bool is_irrelevant(uint32_t field, bool relevant)
+	{
+		if (!relevant) {
+			known.valid &= ~field;
+			skipped++;
+			return true;
+		}
+		return false;
+	}
+
+	void apply_state(const streamfx::obs::gs::renderstate::description& desc, uint32_t fields)
+	{
+		auto& state = known.state;
+
+		if ((fields & BLENDING) && !is_known(BLENDING, state.blending == desc.blending)) {
+			gs_enable_blending(desc.blending);
+			state.blending = desc.blending;
+		}
+		if ((fields & BLEND_FUNCTION) && !is_irrelevant(BLEND_FUNCTION, desc.blending) && !is_known(BLEND_FUNCTION, (state.blend_src_color == desc.blend_src_color) && (state.blend_dst_color == desc.blend_dst_color) && (state.blend_src_alpha == desc.blend_src_alpha) && (state.blend_dst_alpha == desc.blend_dst_alpha))) {
+			gs_blend_function_separate(desc.blend_src_color, desc.blend_dst_color, desc.blend_src_alpha, desc.blend_dst_alpha);
+			state.blend_src_color = desc.blend_src_color;
+			state.blend_dst_color = desc.blend_dst_color;
+			state.blend_src_alpha = desc.blend_src_alpha;
+			state.blend_dst_alpha = desc.blend_dst_alpha;
+		}
+		if ((fields & COLOR) && !is_known(COLOR, (state.color[0] == desc.color[0]) && (state.color[1] == desc.color[1]) && (state.color[2] == desc.color[2]) && (state.color[3] == desc.color[3]))) {
+			gs_enable_color(desc.color[0], desc.color[1], desc.color[2], desc.color[3]);
+			for (std::size_t idx = 0; idx < 4; idx++) {
+				state.color[idx] = desc.color[idx];
+			}
+		}
+		if ((fields & DEPTH_TEST) && !is_known(DEPTH_TEST, state.depth_test == desc.depth_test)) {
+			gs_enable_depth_test(desc.depth_test);
+			state.depth_test = desc.depth_test;
+		}
+		if ((fields & DEPTH_FUNCTION) && !is_irrelevant(DEPTH_FUNCTION, desc.depth_test) && !is_known(DEPTH_FUNCTION, state.depth_function == desc.depth_function)) {
+			gs_depth_function(desc.depth_function);
+			state.depth_function = desc.depth_function;
+		}
+		if ((fields & STENCIL_TEST) && !is_known(STENCIL_TEST, state.stencil_test == desc.stencil_test)) {
+			gs_enable_stencil_test(desc.stencil_test);
+			state.stencil_test = desc.stencil_test;
+		}
+		if ((fields & STENCIL_WRITE) && !is_known(STENCIL_WRITE, state.stencil_write == desc.stencil_write)) {
+			gs_enable_stencil_write(desc.stencil_write);
+			state.stencil_write = desc.stencil_write;
+		}
+		if ((fields & STENCIL_FUNCTION) && !is_irrelevant(STENCIL_FUNCTION, desc.stencil_test) && !is_known(STENCIL_FUNCTION, state.stencil_function == desc.stencil_function)) {
+			gs_stencil_function(GS_STENCIL_BOTH, desc.stencil_function);
+			state.stencil_function = desc.stencil_function;
+		}
+		if ((fields & STENCIL_OP) && !is_irrelevant(STENCIL_OP, desc.stencil_test) && !is_known(STENCIL_OP, (state.stencil_fail == desc.stencil_fail) && (state.stencil_depth_fail == desc.stencil_depth_fail) && (state.stencil_pass == desc.stencil_pass))) {
+			gs_stencil_op(GS_STENCIL_BOTH, desc.stencil_fail, desc.stencil_depth_fail, desc.stencil_pass);
+			state.stencil_fail       = desc.stencil_fail;
+			state.stencil_depth_fail = desc.stencil_depth_fail;
+			state.stencil_pass       = desc.stencil_pass;
+		}
+		if ((fields & CULL) && !is_known(CULL, state.cull == desc.cull)) {
+			gs_set_cull_mode(desc.cull);
+			state.cull = desc.cull;
+		}
+	}
+} // namespace
+
+streamfx::obs::gs::renderstate::scope::~scope()
+{
+	// The blend state stack brings back whatever was in effect before.
+	gs_blend_state_pop();
+	known.state.blending        = _previous.blending;
+	known.state.blend_src_color = _previous.blend_src_color;
+	known.state.blend_dst_color = _previous.blend_dst_color;
+	known.state.blend_src_alpha = _previous.blend_src_alpha;
+	known.state.blend_dst_alpha = _previous.blend_dst_alpha;
+	known.valid                 = (known.valid & ~BLEND) | (_previous_valid & BLEND);
+
+	// Nothing else is on a stack, so an enclosing block needs its state back.
+	if (_enclosing) {
+		apply_state(*_enclosing, ALL & ~BLEND);
+	}
+	known.active = _enclosing;
+
+	if (--known.depth == 0) {
+		known.valid = 0;
+	}
+}
+
+streamfx::obs::gs::renderstate::scope::scope(const description& desc) : _desc(desc), _enclosing(known.active), _previous(known.state), _previous_valid(known.valid)
+{
+	known.depth++;
+	gs_blend_state_push();
+	apply_state(_desc, ALL);
+	known.active = &_desc;
+}
+
+void streamfx::obs::gs::renderstate::scope::clear(uint32_t flags, const vec4* color, float depth, uint8_t stencil)
+{
+	if ((flags & GS_CLEAR_COLOR) && _desc.covers_target && !_desc.blending && _desc.color[0] && _desc.color[1] && _desc.color[2] && _desc.color[3]) {
+		flags &= ~GS_CLEAR_COLOR;
+	}
+	if ((flags & (GS_CLEAR_DEPTH | GS_CLEAR_STENCIL)) && (gs_get_zstencil_target() == nullptr)) {
+		flags &= ~(GS_CLEAR_DEPTH | GS_CLEAR_STENCIL);
+	}
+
+	if (flags == 0) {
+		elided++;
+		return;
+	}
+	gs_clear(flags, color, depth, stencil);
+}
+
+streamfx::obs::gs::renderstate::session::~session()
+{
+	// Whoever rendered us may change state before the enclosing session continues.
+	known.depth--;
+	known.valid = 0;
+}
+
+streamfx::obs::gs::renderstate::session::session()
+{
+	// A nested session is reached through libOBS, which may have changed anything since.
+	known.depth++;
+	known.valid = 0;
+}
+
+streamfx::obs::gs::renderstate::~renderstate() {}
+
+streamfx::obs::gs::renderstate::renderstate(const description& desc) : _desc(desc) {}
+
+const streamfx::obs::gs::renderstate::description& streamfx::obs::gs::renderstate::get() const
+{
+	return _desc;
+}
+
+streamfx::obs::gs::renderstate::scope streamfx::obs::gs::renderstate::apply() const
+{
+	return scope(_desc);
+}
+
+void streamfx::obs::gs::renderstate::invalidate()
+{
+	known.valid = 0;
+}
+
+void streamfx::obs::gs::renderstate::report()
+{
+	uint64_t saved  = skipped.load() + elided.load();
+	uint32_t frames = obs_get_total_frames();
+	D_LOG_INFO("Issued %" PRIu64 " state changes, skipped %" PRIu64 " and elided %" PRIu64 " clears.", issued.load(), skipped.load(), elided.load());
+	if (frames > 0) {
+		D_LOG_INFO("Saved %.2f graphics calls per frame over %" PRIu32 " frames.", static_cast<double>(saved) / static_cast<double>(frames), frames);
+	}
+}
+
+const streamfx::obs::gs::renderstate& streamfx::obs::gs::renderstate::overwrite()
+{
+	static const renderstate state({
+		false, GS_BLEND_ONE, GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_ZERO, // Blending
+		{true, true, true, true},                                         // Color
+		false, GS_ALWAYS,                                                 // Depth
+		false, false, GS_ALWAYS, GS_KEEP, GS_KEEP, GS_KEEP,               // Stencil
+		GS_NEITHER,                                                       // Culling
+		true,
+	});
+	return state;
+}
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+	},
+	[]() { // Finalizer
+		streamfx::obs::gs::renderstate::report();
+	},
+	streamfx::loader_priority::NORMAL);
@@ -0,0 +1,101 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+/* renderstate is an immutable block of the fixed function state that a render
+ *  pass depends on, applied with a single call instead of the usual dozen.
+ *
+ * While a block or a session is active, the state in effect is tracked per
+ *  thread, and applying a block only issues the calls for state that differs
+ *  from it. Blend state is restored by the blend state stack as usual, while
+ *  everything else is restored only if an enclosing block exists. Anything
+ *  that changes state by other means inside of a session, like rendering
+ *  another source or ending filter processing, must be followed by
+ *  invalidate(). Sessions nested through such a render start from nothing.
+ */
+
+namespace streamfx::obs::gs {
+	class renderstate {
+		public:
+		struct description {
+			bool          blending;
+			gs_blend_type blend_src_color;
+			gs_blend_type blend_dst_color;
+			gs_blend_type blend_src_alpha;
+			gs_blend_type blend_dst_alpha;
+
+			bool color[4];
+
+			bool          depth_test;
+			gs_depth_test depth_function;
+
+			bool               stencil_test;
+			bool               stencil_write;
+			gs_depth_test      stencil_function;
+			gs_stencil_op_type stencil_fail;
+			gs_stencil_op_type stencil_depth_fail;
+			gs_stencil_op_type stencil_pass;
+
+			gs_cull_mode cull;
+
+			// Every draw covers the entire target, so clearing its color first is wasted work.
+			bool covers_target;
+		};
+
+		class scope {
+			const description& _desc;
+			const description* _enclosing;
+			description        _previous;
+			uint32_t           _previous_valid;
+
+			public:
+			~scope();
+			scope(const description& desc);
+
+			scope(const scope&)            = delete;
+			scope& operator=(const scope&) = delete;
+
+			/** Clear the current render target, leaving out whatever the pass is known to overwrite or the target doesn't have.
+			 */
+			void clear(uint32_t flags, const vec4* color, float depth, uint8_t stencil);
+		};
+
+		class session {
+			public:
+			~session();
+			session();
+
+			session(const session&)            = delete;
+			session& operator=(const session&) = delete;
+		};
+
+		private:
+		description _desc;
+
+		public:
+		~renderstate();
+		renderstate(const description& desc);
+
+		const description& get() const;
+
+		/** Apply the block until the returned scope ends.
+		 */
+		[[nodiscard]] scope apply() const;
+
+		/** Forget the tracked state, so the next block is applied in full.
+		 */
+		static void invalidate();
+
+		/** Log how many calls were issued and how many were skipped.
+		 */
+		static void report();
+
+		public:
+		/** No blending, depth, stencil or culling, and every draw covers the target.
+		 */
+		static const renderstate& overwrite();
+	};
+} // namespace streamfx::obs::gs
@@ -5,6 +5,8 @@
 
 #include "gs-rendertarget.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-ledger.hpp"
+#include "obs/gs/gs-lifecycle.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
@@ -12,11 +14,12 @@
 
 streamfx::obs::gs::rendertarget::~rendertarget()
 {
-	auto gctx = streamfx::obs::gs::context();
-	gs_texrender_destroy(_render_target);
+	streamfx::obs::gs::ledger::instance()->untrack(this);
+
+	_lifecycle->destroy(_render_target, [](void* ptr) { gs_texrender_destroy(static_cast<gs_texrender_t*>(ptr)); });
 }
 
-streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _color_format(colorFormat), _zstencil_format(zsFormat)
+streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat) : _lifecycle(streamfx::obs::gs::lifecycle::instance()), _color_format(colorFormat), _zstencil_format(zsFormat), _tracked_width(0), _tracked_height(0)
 {
 	_is_being_rendered = false;
 	auto gctx          = streamfx::obs::gs::context();
@@ -73,6 +76,33 @@ gs_zstencil_format streamfx::obs::gs::rendertarget::get_zstencil_format()
 	return _zstencil_format;
 }
 
+void streamfx::obs::gs::rendertarget::track(uint32_t width, uint32_t height)
+{
+	// gs_texrender only reallocates if the size changes, so only tell the ledger about that.
+	if ((width == _tracked_width) && (height == _tracked_height)) {
+		return;
+	}
+	_tracked_width  = width;
+	_tracked_height = height;
+
+	uint64_t size = streamfx::obs::gs::ledger::estimate(_color_format, width, height);
+	switch (_zstencil_format) {
+	case GS_Z16:
+		size += uint64_t(width) * height * 2;
+		break;
+	case GS_Z24_S8:
+	case GS_Z32F:
+		size += uint64_t(width) * height * 4;
+		break;
+	case GS_Z32F_S8X24:
+		size += uint64_t(width) * height * 8;
+		break;
+	default:
+		break;
+	}
+	streamfx::obs::gs::ledger::instance()->track(this, "Render Target", _color_format, width, height, size);
+}
+
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height) : parent(rt)
 {
 	if (parent == nullptr)
@@ -86,6 +116,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->track(width, height);
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width, uint32_t height, gs_color_space cs) : parent(rt)
@@ -101,6 +132,7 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+	parent->track(width, height);
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget_op&& r) noexcept
@@ -5,6 +5,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gs-lifecycle.hpp"
 #include "gs-texture.hpp"
 
 namespace streamfx::obs::gs {
@@ -14,12 +15,16 @@ namespace streamfx::obs::gs {
 		friend class rendertarget_op;
 
 		protected:
-		gs_texrender_t* _render_target;
-		bool            _is_being_rendered;
+		gs_texrender_t*                               _render_target;
+		bool                                          _is_being_rendered;
+		std::shared_ptr<streamfx::obs::gs::lifecycle> _lifecycle;
 
 		gs_color_format    _color_format;
 		gs_zstencil_format _zstencil_format;
 
+		uint32_t _tracked_width;
+		uint32_t _tracked_height;
+
 		public:
 		~rendertarget();
 
@@ -42,6 +47,9 @@ namespace streamfx::obs::gs {
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height);
 
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height, gs_color_space cs);
+
+		protected:
+		void track(uint32_t width, uint32_t height);
 	};
 
 	class rendertarget_op {
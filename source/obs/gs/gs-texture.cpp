@@ -4,6 +4,8 @@
 
 #include "gs-texture.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-ledger.hpp"
+#include "obs/gs/gs-lifecycle.hpp"
 
 #include "warning-disable.hpp"
 #include <fstream>
@@ -49,6 +51,8 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, gs_color_fo
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Normal;
+	_lifecycle = streamfx::obs::gs::lifecycle::instance();
+	streamfx::obs::gs::ledger::instance()->track(this, "Texture", format, width, height, streamfx::obs::gs::ledger::estimate(format, width, height, 1, mip_levels));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t depth, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -77,6 +81,8 @@ streamfx::obs::gs::texture::texture(uint32_t width, uint32_t height, uint32_t de
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Volume;
+	_lifecycle = streamfx::obs::gs::lifecycle::instance();
+	streamfx::obs::gs::ledger::instance()->track(this, "Volume Texture", format, width, height, streamfx::obs::gs::ledger::estimate(format, width, height, depth, mip_levels));
 }
 
 streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint32_t mip_levels, const uint8_t** mip_data, streamfx::obs::gs::texture::flags texture_flags)
@@ -101,6 +107,8 @@ streamfx::obs::gs::texture::texture(uint32_t size, gs_color_format format, uint3
 		throw std::runtime_error("Failed to create texture.");
 
 	_type = type::Cube;
+	_lifecycle = streamfx::obs::gs::lifecycle::instance();
+	streamfx::obs::gs::ledger::instance()->track(this, "Cube Texture", format, size, size, streamfx::obs::gs::ledger::estimate(format, size, size, 6, mip_levels));
 }
 
 streamfx::obs::gs::texture::texture(std::string file)
@@ -114,23 +122,34 @@ streamfx::obs::gs::texture::texture(std::string file)
 
 	if (!_texture)
 		throw std::runtime_error("Failed to load texture.");
+
+	auto format = gs_texture_get_color_format(_texture);
+	auto width  = gs_texture_get_width(_texture);
+	auto height = gs_texture_get_height(_texture);
+	_lifecycle = streamfx::obs::gs::lifecycle::instance();
+	streamfx::obs::gs::ledger::instance()->track(this, "Texture", format, width, height, streamfx::obs::gs::ledger::estimate(format, width, height));
 }
 
 streamfx::obs::gs::texture::~texture()
 {
 	if (_is_owner && _texture) {
-		auto gctx = streamfx::obs::gs::context();
-		switch (gs_get_texture_type(_texture)) {
-		case GS_TEXTURE_2D:
-			gs_texture_destroy(_texture);
-			break;
-		case GS_TEXTURE_3D:
-			gs_voltexture_destroy(_texture);
-			break;
-		case GS_TEXTURE_CUBE:
-			gs_cubetexture_destroy(_texture);
-			break;
-		}
+		streamfx::obs::gs::ledger::instance()->untrack(this);
+
+		auto lifecycle = _lifecycle ? _lifecycle : streamfx::obs::gs::lifecycle::instance();
+		lifecycle->destroy(_texture, [](void* ptr) {
+			gs_texture_t* texture = static_cast<gs_texture_t*>(ptr);
+			switch (gs_get_texture_type(texture)) {
+			case GS_TEXTURE_2D:
+				gs_texture_destroy(texture);
+				break;
+			case GS_TEXTURE_3D:
+				gs_voltexture_destroy(texture);
+				break;
+			case GS_TEXTURE_CUBE:
+				gs_cubetexture_destroy(texture);
+				break;
+			}
+		});
 	}
 	_texture = nullptr;
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "gs-lifecycle.hpp"
 
 namespace streamfx::obs::gs {
 	class texture {
@@ -19,9 +20,10 @@ namespace streamfx::obs::gs {
 		};
 
 		protected:
-		gs_texture_t* _texture;
-		bool          _is_owner = true;
-		type          _type     = type::Normal;
+		gs_texture_t*                                 _texture;
+		bool                                          _is_owner = true;
+		type                                          _type     = type::Normal;
+		std::shared_ptr<streamfx::obs::gs::lifecycle> _lifecycle; // Only held by owners.
 
 		public:
 		~texture();
@@ -0,0 +1,126 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "gs-timer.hpp"
+#include "obs/gs/gs-helper.hpp"
+
+#include "warning-disable.hpp"
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+// Timer ranges can't be nested, so only the outermost timer on a thread measures anything.
+static thread_local std::size_t active_timers = 0;
+
+// Measurement attempts after which a query that still isn't ready is given up on.
+static constexpr uint64_t stale_after = 60;
+
+streamfx::obs::gs::timer::~timer()
+{
+	for (auto& query : _queries) {
+		_lifecycle->destroy(query.timer, [](void* ptr) { gs_timer_destroy(static_cast<gs_timer_t*>(ptr)); });
+		_lifecycle->destroy(query.range, [](void* ptr) { gs_timer_range_destroy(static_cast<gs_timer_range_t*>(ptr)); });
+	}
+}
+
+streamfx::obs::gs::timer::timer(std::size_t depth) : _queries(), _index(0), _active(false), _attempts(0), _lifecycle(streamfx::obs::gs::lifecycle::instance())
+{
+	if (depth == 0) {
+		throw std::invalid_argument("depth must be at least 1");
+	}
+
+	auto gctx = streamfx::obs::gs::context();
+	_queries.resize(depth, {nullptr, nullptr, false, 0});
+	for (auto& query : _queries) {
+		query.range = gs_timer_range_create();
+		query.timer = gs_timer_create();
+		if (!query.range || !query.timer) {
+			// Not supported by this backend, leave everything empty.
+			for (auto& entry : _queries) {
+				if (entry.timer)
+					gs_timer_destroy(entry.timer);
+				if (entry.range)
+					gs_timer_range_destroy(entry.range);
+			}
+			_queries.clear();
+			break;
+		}
+	}
+}
+
+void streamfx::obs::gs::timer::begin()
+{
+	if (_queries.empty() || _active || (active_timers > 0))
+		return;
+	_attempts++;
+
+	// Still waiting on the GPU for the result in this slot, so skip this measurement.
+	auto& query = _queries[_index];
+	if (query.pending)
+		return;
+
+	gs_timer_range_begin(query.range);
+	gs_timer_begin(query.timer);
+	_active = true;
+	active_timers++;
+}
+
+void streamfx::obs::gs::timer::end()
+{
+	if (_queries.empty() || !_active)
+		return;
+
+	auto& query = _queries[_index];
+	gs_timer_end(query.timer);
+	gs_timer_range_end(query.range);
+	query.pending = true;
+	query.issued  = _attempts;
+	_active       = false;
+	active_timers--;
+
+	_index = (_index + 1) % _queries.size();
+}
+
+bool streamfx::obs::gs::timer::get(std::chrono::nanoseconds& duration)
+{
+	if (_queries.empty())
+		return false;
+
+	// Slots are written in order, so the first pending one from the next slot on holds the oldest measurement.
+	query* oldest = nullptr;
+	for (std::size_t idx = 0; idx < _queries.size(); idx++) {
+		auto& entry = _queries[(_index + idx) % _queries.size()];
+		if (entry.pending) {
+			oldest = &entry;
+			break;
+		}
+	}
+	if (!oldest)
+		return false;
+
+	bool     disjoint  = false;
+	uint64_t frequency = 0;
+	uint64_t ticks     = 0;
+	if (!gs_timer_range_get_data(oldest->range, &disjoint, &frequency) || !gs_timer_get_data(oldest->timer, &ticks)) {
+		// Not ready yet, unless it's been so long that it never will be.
+		if ((_attempts - oldest->issued) > stale_after)
+			oldest->pending = false;
+		return false;
+	}
+	oldest->pending = false;
+	if (disjoint || (frequency == 0))
+		return false;
+
+	duration = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(ticks) * 1000000000. / static_cast<double>(frequency)));
+	return true;
+}
+
+bool streamfx::obs::gs::timer::is_supported()
+{
+	return !_queries.empty();
+}
+
+bool streamfx::obs::gs::timer::is_any_active()
+{
+	return active_timers > 0;
+}
@@ -0,0 +1,61 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "gs-lifecycle.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::obs::gs {
+	/** GPU timer for measuring how long a block of rendering took.
+	 *
+	 * Results arrive a few frames late, so queries are kept in a ring with the
+	 *  given depth and read back in order once the GPU has finished them. While
+	 *  the ring is full, new measurements are skipped instead, which is fine for
+	 *  controllers that only need a trend. The same happens if another timer is
+	 *  already running on this thread.
+	 */
+	class timer {
+		struct query {
+			gs_timer_range_t* range;
+			gs_timer_t*       timer;
+			bool              pending;
+			uint64_t          issued;
+		};
+
+		std::vector<query>                            _queries;
+		std::size_t                                   _index;
+		bool                                          _active;
+		uint64_t                                      _attempts;
+		std::shared_ptr<streamfx::obs::gs::lifecycle> _lifecycle;
+
+		public:
+		~timer();
+		timer(std::size_t depth = 3);
+
+		void begin();
+
+		void end();
+
+		/** Retrieve the oldest outstanding measurement.
+		 *
+		 * Measurements that aren't ready yet stay queued for the next call.
+		 *
+		 * @return true if a measurement was available.
+		 */
+		bool get(std::chrono::nanoseconds& duration);
+
+		/** Whether the graphics backend supports timer queries at all.
+		 */
+		bool is_supported();
+
+		/** Whether any timer is currently measuring on this thread.
+		 */
+		static bool is_any_active();
+	};
+} // namespace streamfx::obs::gs
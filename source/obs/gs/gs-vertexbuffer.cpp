@@ -5,6 +5,7 @@
 
 #include "gs-vertexbuffer.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-lifecycle.hpp"
 
 #include "warning-disable.hpp"
 #include <stdexcept>
@@ -50,10 +51,9 @@ void streamfx::obs::gs::vertex_buffer::initialize(uint32_t capacity, uint8_t lay
 	// Allocate actual GPU vertex buffer.
 	{
 		auto gctx = streamfx::obs::gs::context();
-		_buffer   = decltype(_buffer)(gs_vertexbuffer_create(_data.get(), GS_DYNAMIC | GS_DUP_BUFFER), [this](gs_vertbuffer_t* v) {
+		_buffer   = decltype(_buffer)(gs_vertexbuffer_create(_data.get(), GS_DYNAMIC | GS_DUP_BUFFER), [this, lifecycle = streamfx::obs::gs::lifecycle::instance()](gs_vertbuffer_t* v) {
             try {
-                auto gctx = streamfx::obs::gs::context();
-                gs_vertexbuffer_destroy(v);
+                lifecycle->destroy(v, [](void* ptr) { gs_vertexbuffer_destroy(static_cast<gs_vertbuffer_t*>(ptr)); });
             } catch (...) {
                 if (obs_get_version() < MAKE_SEMANTIC_VERSION(26, 0, 0)) {
                     // Fixes a memory leak with OBS Studio versions older than 26.x.
@@ -49,6 +49,13 @@ namespace streamfx::obs {
 			return false;
 		};
 
+#if LIBOBS_API_MAJOR_VER >= 30
+		virtual bool encode_video(struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet)
+		{
+			return encode_video(texture->handle, pts, lock_key, next_key, packet, received_packet);
+		};
+#endif
+
 		virtual size_t get_frame_size()
 		{
 			return 0;
@@ -84,6 +91,8 @@ namespace streamfx::obs {
 		obs_encoder_info _info          = {};
 		obs_encoder_info _info_fallback = {};
 		std::string      _info_fallback_id;
+		obs_encoder_info _info_texture  = {};
+		std::string      _info_texture_id;
 
 		std::map<std::string, std::shared_ptr<obs_encoder_info>> _proxies;
 		std::set<std::string>                                    _proxy_names;
@@ -115,6 +124,9 @@ namespace streamfx::obs {
 			}
 			if (_info.caps & OBS_ENCODER_CAP_PASS_TEXTURE) {
 				_info.encode_texture = _encode_texture;
+#if LIBOBS_API_MAJOR_VER >= 30
+				_info.encode_texture2 = _encode_texture2;
+#endif
 
 				memcpy(&_info_fallback, &_info, sizeof(obs_encoder_info));
 				_info_fallback_id             = std::string(_info.id) + "_sw";
@@ -122,6 +134,9 @@ namespace streamfx::obs {
 				_info_fallback.caps           = (_info_fallback.caps & ~OBS_ENCODER_CAP_PASS_TEXTURE) | OBS_ENCODER_CAP_DEPRECATED;
 				_info_fallback.create         = _create;
 				_info_fallback.encode_texture = nullptr;
+#if LIBOBS_API_MAJOR_VER >= 30
+				_info_fallback.encode_texture2 = nullptr;
+#endif
 				obs_register_encoder(&_info_fallback);
 			} else {
 				_info.create = _create;
@@ -130,6 +145,31 @@ namespace streamfx::obs {
 			obs_register_encoder(&_info);
 		}
 
+		/** Register an additional copy of the encoder that takes textures.
+		 *
+		 * This is for encoders whose texture path is opt-in: the regular id stays as
+		 *  it is, and the copy falls back to it if it can't be created.
+		 */
+		void register_texture_variant(std::string_view suffix)
+		{
+			memcpy(&_info_texture, &_info, sizeof(obs_encoder_info));
+			_info_texture_id             = std::string(_info.id) + std::string(suffix);
+			_info_texture.id             = _info_texture_id.c_str();
+			_info_texture.caps           = (_info_texture.caps | OBS_ENCODER_CAP_PASS_TEXTURE) & ~OBS_ENCODER_CAP_DEPRECATED;
+			_info_texture.get_name       = _get_name_texture;
+			_info_texture.create         = _create_texture;
+			_info_texture.encode_texture = _encode_texture;
+#if LIBOBS_API_MAJOR_VER >= 30
+			_info_texture.encode_texture2 = _encode_texture2;
+#endif
+			obs_register_encoder(&_info_texture);
+		}
+
+		bool is_texture_variant(obs_encoder_t* encoder)
+		{
+			return !_info_texture_id.empty() && (_info_texture_id == obs_encoder_get_id(encoder));
+		}
+
 		void register_proxy(std::string_view name)
 		{
 			auto iter = _proxy_names.emplace(name);
@@ -172,6 +212,21 @@ namespace streamfx::obs {
 			}
 		}
 
+		static const char* _get_name_texture(void* type_data) noexcept
+		{
+			try {
+				if (type_data)
+					return reinterpret_cast<factory_t*>(type_data)->get_name_texture();
+				return nullptr;
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+				return nullptr;
+			} catch (...) {
+				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+				return nullptr;
+			}
+		}
+
 		static void* _create(obs_data_t* settings, obs_encoder_t* encoder) noexcept
 		{
 			try {
@@ -204,6 +259,24 @@ namespace streamfx::obs {
 			}
 		}
 
+		static void* _create_texture(obs_data_t* settings, obs_encoder_t* encoder) noexcept
+		{
+			try {
+				auto* fac = reinterpret_cast<factory_t*>(obs_encoder_get_type_data(encoder));
+				try {
+					return fac->create(settings, encoder, true);
+				} catch (...) {
+					return obs_encoder_create_rerouted(encoder, fac->_info.id);
+				}
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+				return nullptr;
+			} catch (...) {
+				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+				return nullptr;
+			}
+		}
+
 		static void _get_defaults2(obs_data_t* settings, void* type_data) noexcept
 		{
 			try {
@@ -315,6 +388,23 @@ namespace streamfx::obs {
 			}
 		}
 
+#if LIBOBS_API_MAJOR_VER >= 30
+		static bool _encode_texture2(void* data, struct encoder_texture* texture, int64_t pts, uint64_t lock_key, uint64_t* next_key, struct encoder_packet* packet, bool* received_packet) noexcept
+		{
+			try {
+				if (data)
+					return reinterpret_cast<encoder_instance*>(data)->encode_video(texture, pts, lock_key, next_key, packet, received_packet);
+				return false;
+			} catch (const std::exception& ex) {
+				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
+				return false;
+			} catch (...) {
+				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+				return false;
+			}
+		}
+#endif
+
 		static size_t _get_frame_size(void* data) noexcept
 		{
 			try {
@@ -390,6 +480,11 @@ namespace streamfx::obs {
 			return "Not Yet Implemented";
 		}
 
+		virtual const char* get_name_texture()
+		{
+			return get_name();
+		}
+
 		virtual void* create(obs_data_t* settings, obs_encoder_t* encoder, bool is_hw)
 		{
 			return reinterpret_cast<void*>(new instance_t(settings, encoder, is_hw));
@@ -6,6 +6,8 @@
 #pragma once
 #include "common.hpp"
 #include "obs-source.hpp"
+#include "obs/gs/gs-ledger.hpp"
+#include "obs/obs-watchdog.hpp"
 
 namespace streamfx::obs {
 	template<class _factory, typename _instance>
@@ -146,6 +148,7 @@ namespace streamfx::obs {
 		static void* _create(obs_data_t* settings, obs_source_t* source) noexcept
 		{
 			try {
+				::streamfx::obs::gs::ledger::owner_scope owner(source);
 				return reinterpret_cast<_factory*>(obs_source_get_type_data(source))->create(settings, source);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
@@ -236,8 +239,12 @@ namespace streamfx::obs {
 		static void _video_tick(void* data, float seconds) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_tick(seconds);
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					::streamfx::obs::gs::ledger::instance()->collect(self->get().get());
+					self->video_tick(seconds);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -248,8 +255,15 @@ namespace streamfx::obs {
 		static void _video_render(void* data, gs_effect_t* effect) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_render(effect);
+				if (data) {
+					auto          self   = reinterpret_cast<_instance*>(data);
+					obs_source_t* source = self->get().get();
+					::streamfx::obs::gs::ledger::instance()->touch(source, obs_source_get_name(source));
+					::streamfx::obs::gs::ledger::owner_scope owner(source);
+					::streamfx::obs::gs::ledger::instance()->collect(source);
+					::streamfx::obs::watchdog::scope watchdog(self->get_watchdog(), self, false);
+					self->video_render(effect);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -260,8 +274,20 @@ namespace streamfx::obs {
 		static void _video_render_filter(void* data, gs_effect_t* effect) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->video_render(effect);
+				if (data) {
+					auto          self   = reinterpret_cast<_instance*>(data);
+					obs_source_t* source = self->get().get();
+					::streamfx::obs::gs::ledger::instance()->touch(source, obs_source_get_name(source));
+					if (self->get_watchdog().level() == ::streamfx::obs::degradation::Bypass) {
+						self->get_watchdog().skip(self);
+						obs_source_skip_video_filter(source);
+						return;
+					}
+					::streamfx::obs::gs::ledger::owner_scope owner(source);
+					::streamfx::obs::gs::ledger::instance()->collect(source);
+					::streamfx::obs::watchdog::scope watchdog(self->get_watchdog(), self, true);
+					self->video_render(effect);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
@@ -448,7 +474,8 @@ namespace streamfx::obs {
 			try {
 				auto priv = reinterpret_cast<_instance*>(data);
 				if (priv) {
-					uint64_t version = static_cast<uint64_t>(obs_data_get_int(settings, S_VERSION));
+					::streamfx::obs::gs::ledger::owner_scope owner(priv->get().get());
+					uint64_t                                 version = static_cast<uint64_t>(obs_data_get_int(settings, S_VERSION));
 					priv->migrate(settings, version);
 					obs_data_set_int(settings, S_VERSION, static_cast<int64_t>(STREAMFX_VERSION));
 					obs_data_set_string(settings, S_COMMIT, STREAMFX_VERSION_BUILD);
@@ -464,8 +491,11 @@ namespace streamfx::obs {
 		static void _update(void* data, obs_data_t* settings) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->update(settings);
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					self->update(settings);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -503,8 +533,11 @@ namespace streamfx::obs {
 		static void _activate(void* data) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->activate();
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					self->activate();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -515,8 +548,11 @@ namespace streamfx::obs {
 		static void _deactivate(void* data) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->deactivate();
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					self->deactivate();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -539,8 +575,11 @@ namespace streamfx::obs {
 		static void _show(void* data) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->show();
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					self->show();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -551,8 +590,11 @@ namespace streamfx::obs {
 		static void _hide(void* data) noexcept
 		{
 			try {
-				if (data)
-					reinterpret_cast<_instance*>(data)->hide();
+				if (data) {
+					auto                                     self = reinterpret_cast<_instance*>(data);
+					::streamfx::obs::gs::ledger::owner_scope owner(self->get().get());
+					self->hide();
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -833,8 +875,11 @@ namespace streamfx::obs {
 		protected:
 		::streamfx::obs::source _self;
 
+		private:
+		::streamfx::obs::watchdog::tracker _watchdog;
+
 		public:
-		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false) {}
+		source_instance(obs_data_t* settings, obs_source_t* source) : _self(source, false, false), _watchdog() {}
 		virtual ~source_instance(){};
 
 		virtual ::streamfx::obs::source get()
@@ -842,6 +887,11 @@ namespace streamfx::obs {
 			return _self;
 		}
 
+		::streamfx::obs::watchdog::tracker& get_watchdog()
+		{
+			return _watchdog;
+		}
+
 		virtual void filter_remove(obs_source_t* source) {}
 
 		public /* Instance > Video */:
@@ -854,6 +904,25 @@ namespace streamfx::obs {
 
 		virtual void video_render(gs_effect_t* effect) {}
 
+		/** Apply a degradation level requested by the watchdog.
+		 *
+		 * By default an instance can't be degraded, only bypassed. Bypass is only
+		 *  ever requested for filters, and an override that returns false for it
+		 *  keeps the filter from being skipped.
+		 *
+		 * @return false if the level isn't supported, in which case the watchdog tries the next one.
+		 */
+		virtual bool degrade(::streamfx::obs::degradation level)
+		{
+			switch (level) {
+			case ::streamfx::obs::degradation::None:
+			case ::streamfx::obs::degradation::Bypass:
+				return true;
+			default:
+				return false;
+			}
+		}
+
 		virtual struct obs_source_frame* filter_video(struct obs_source_frame* frame)
 		{
 			return frame;
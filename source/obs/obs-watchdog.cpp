@@ -0,0 +1,362 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "obs-watchdog.hpp"
+#include "configuration.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-source-factory.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<watchdog> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_ENABLED "Watchdog.Enabled"
+#define ST_CFG_BUDGET_INSTANCE "Watchdog.Budget.Instance"
+#define ST_CFG_BUDGET_FRAME "Watchdog.Budget.Frame"
+
+// Parts of the frame interval used if no budget is configured.
+static constexpr double default_instance_budget = 0.5;
+static constexpr double default_frame_budget    = 0.75;
+
+// Frames in a row an instance has to be over budget before it is degraded.
+static constexpr uint32_t escalate_frames = 30;
+
+// GPU time is only sampled every few frames, as timers can't nest and other timers need their share too.
+static constexpr uint32_t gpu_sample_interval = 8;
+
+// Time before a degraded instance gets another chance, doubled each time it fails again.
+static constexpr std::chrono::seconds hold_minimum{10};
+static constexpr std::chrono::seconds hold_maximum{300};
+
+// Time an instance has to behave after being restored before it is forgiven.
+static constexpr std::chrono::seconds forgive_after{60};
+
+static thread_local streamfx::obs::watchdog::tracker* current_tracker = nullptr;
+
+// Ids start at 1, as 0 marks a frame that wasn't over budget.
+static std::atomic<uint64_t> next_tracker_id{1};
+
+static inline double to_ms(std::chrono::nanoseconds v)
+{
+	return static_cast<double>(v.count()) / 1000000.;
+}
+
+static inline const char* get_name(streamfx::obs::source_instance* instance)
+{
+	const char* name = obs_source_get_name(instance->get().get());
+	return name ? name : "(unnamed)";
+}
+
+const char* streamfx::obs::degradation_to_string(degradation level)
+{
+	switch (level) {
+	case degradation::None:
+		return "None";
+	case degradation::Resolution:
+		return "Reduced Resolution";
+	case degradation::Cached:
+		return "Cached Output";
+	case degradation::Bypass:
+		return "Bypass";
+	}
+	return "Unknown";
+}
+
+streamfx::obs::watchdog::tracker::~tracker()
+{
+	if (_gpu) {
+		auto gctx = streamfx::obs::gs::context();
+		_gpu.reset();
+	}
+}
+
+streamfx::obs::watchdog::tracker::tracker()
+	: _watchdog(streamfx::obs::watchdog::instance()), _id(next_tracker_id++), _level(degradation::None),
+
+	  _running(false), _parent(nullptr), _start(), _children(0), _gpu(), _gpu_last(0), _gpu_sampling(false), _gpu_valid(false), _gpu_frame(0), _cpu_last(0), _measure(false),
+
+	  _over(0), _over_total(0), _over_frame(false), _changed(), _hold(hold_minimum), _restored(false), _exhausted(false)
+{}
+
+streamfx::obs::degradation streamfx::obs::watchdog::tracker::level()
+{
+	return _level;
+}
+
+void streamfx::obs::watchdog::tracker::measure(bool enable)
+{
+	_measure = enable;
+}
+
+std::chrono::nanoseconds streamfx::obs::watchdog::tracker::cpu_time()
+{
+	return _cpu_last;
+}
+
+bool streamfx::obs::watchdog::tracker::gpu_time(std::chrono::nanoseconds& duration)
+{
+	if (!_gpu_valid) {
+		return false;
+	}
+	duration = _gpu_last;
+	return true;
+}
+
+void streamfx::obs::watchdog::tracker::begin()
+{
+	if (!_watchdog->is_enabled() && !_measure) {
+		return;
+	}
+
+	_running        = true;
+	_parent         = current_tracker;
+	_children       = std::chrono::nanoseconds(0);
+	current_tracker = this;
+
+	// Only the outermost instance can be timed on the GPU, nested ones would include each other.
+	if (!_parent && (_measure || ((_gpu_frame++ % gpu_sample_interval) == 0)) && !streamfx::obs::gs::timer::is_any_active()) {
+		if (!_gpu) {
+			_gpu = std::make_unique<streamfx::obs::gs::timer>();
+		}
+		_gpu->begin();
+		_gpu_sampling = true;
+	}
+
+	_start = std::chrono::high_resolution_clock::now();
+}
+
+void streamfx::obs::watchdog::tracker::end(::streamfx::obs::source_instance* instance, bool can_bypass)
+{
+	if (!_running) {
+		return;
+	}
+	_running = false;
+
+	auto now       = std::chrono::high_resolution_clock::now();
+	auto inclusive = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _start);
+	auto cpu       = inclusive - _children;
+
+	current_tracker = _parent;
+	if (_parent) {
+		_parent->_children += inclusive;
+	}
+	_parent = nullptr;
+
+	if (_gpu_sampling) {
+		_gpu->end();
+		_gpu_sampling = false;
+
+		// Results that include nested instances would blame us for their cost.
+		_gpu_valid = (_children.count() == 0);
+	}
+	if (_gpu) {
+		if (std::chrono::nanoseconds duration; _gpu->get(duration)) {
+			_gpu_last = duration;
+		}
+	}
+
+	_cpu_last = cpu;
+	if (_measure) {
+		return;
+	}
+
+	auto cost       = _gpu_valid ? std::max(cpu, _gpu_last) : cpu;
+	bool frame_over = false;
+	if (_watchdog->account(_id, cost, frame_over)) {
+		_over++;
+		_over_total += cost;
+		_over_frame = frame_over;
+	} else {
+		_over       = 0;
+		_over_total = std::chrono::nanoseconds(0);
+	}
+
+	try {
+		if (_over >= escalate_frames) {
+			escalate(instance, can_bypass, now);
+		} else if ((_level != degradation::None) && (_over == 0) && ((now - _changed) >= _hold)) {
+			restore(instance, now);
+		} else if ((_level == degradation::None) && _restored && ((now - _changed) >= forgive_after)) {
+			_hold     = hold_minimum;
+			_restored = false;
+		}
+	} catch (const std::exception& ex) {
+		D_LOG_ERROR("Failed to change degradation of '%s': %s", get_name(instance), ex.what());
+	}
+}
+
+void streamfx::obs::watchdog::tracker::skip(::streamfx::obs::source_instance* instance)
+{
+	auto now = std::chrono::high_resolution_clock::now();
+	if ((now - _changed) >= _hold) {
+		try {
+			restore(instance, now);
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Failed to change degradation of '%s': %s", get_name(instance), ex.what());
+		}
+	}
+}
+
+void streamfx::obs::watchdog::tracker::escalate(::streamfx::obs::source_instance* instance, bool can_bypass, std::chrono::high_resolution_clock::time_point now)
+{
+	double average = to_ms(_over_total) / static_cast<double>(_over);
+	_over          = 0;
+	_over_total    = std::chrono::nanoseconds(0);
+
+	degradation next = _level;
+	for (auto idx = static_cast<uint8_t>(_level) + 1; idx <= static_cast<uint8_t>(degradation::Bypass); idx++) {
+		auto level = static_cast<degradation>(idx);
+		// Only filters can be skipped, and only if the instance accepts it as well.
+		if (((level != degradation::Bypass) || can_bypass) && instance->degrade(level)) {
+			next = level;
+			break;
+		}
+	}
+
+	if (next == _level) {
+		if (!_exhausted) {
+			D_LOG_WARNING("'%s' takes %.2f ms per frame, but can't be degraded any further.", get_name(instance), average);
+			_exhausted = true;
+		}
+		return;
+	}
+
+	// Failing again right after being restored means it wasn't a temporary spike.
+	if (_restored && ((now - _changed) < (_hold * 2))) {
+		_hold = std::min(_hold * 2, hold_maximum);
+	}
+	_restored = false;
+
+	D_LOG_WARNING("'%s' took %.2f ms per frame for %" PRIu32 " frames, exceeding the %s budget. Degrading to '%s' for at least %lld seconds.", get_name(instance), average, escalate_frames, _over_frame ? "per-frame" : "per-instance", degradation_to_string(next), static_cast<long long>(_hold.count()));
+	_level   = next;
+	_changed = now;
+}
+
+void streamfx::obs::watchdog::tracker::restore(::streamfx::obs::source_instance* instance, std::chrono::high_resolution_clock::time_point now)
+{
+	degradation previous = degradation::None;
+	for (auto idx = static_cast<uint8_t>(_level) - 1; idx > static_cast<uint8_t>(degradation::None); idx--) {
+		auto level = static_cast<degradation>(idx);
+		if (instance->degrade(level)) {
+			previous = level;
+			break;
+		}
+	}
+	if (previous == degradation::None) {
+		instance->degrade(degradation::None);
+	}
+
+	D_LOG_INFO("'%s' is given another chance at '%s'.", get_name(instance), degradation_to_string(previous));
+	_level     = previous;
+	_changed   = now;
+	_restored  = true;
+	_exhausted = false;
+	_over      = 0;
+}
+
+streamfx::obs::watchdog::scope::scope(tracker& tracker, ::streamfx::obs::source_instance* instance, bool can_bypass) : _tracker(tracker), _instance(instance), _can_bypass(can_bypass)
+{
+	_tracker.begin();
+}
+
+streamfx::obs::watchdog::scope::~scope()
+{
+	_tracker.end(_instance, _can_bypass);
+}
+
+streamfx::obs::watchdog::~watchdog() {}
+
+streamfx::obs::watchdog::watchdog()
+	: _enabled(false), _instance_budget(0), _frame_budget(0), _lock(), _frame(0), _frame_total(0), _frame_max(0), _frame_max_id(0), _frame_over_id(0), _instance_limit(std::chrono::nanoseconds::max()), _frame_limit(std::chrono::nanoseconds::max())
+{
+	// There is no UI for this, budgets are in milliseconds with 0 picking a part of the frame interval.
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto data = config->get();
+		obs_data_set_default_bool(data.get(), ST_CFG_ENABLED, false);
+		obs_data_set_default_double(data.get(), ST_CFG_BUDGET_INSTANCE, 0.);
+		obs_data_set_default_double(data.get(), ST_CFG_BUDGET_FRAME, 0.);
+		_enabled         = obs_data_get_bool(data.get(), ST_CFG_ENABLED);
+		_instance_budget = std::max(obs_data_get_double(data.get(), ST_CFG_BUDGET_INSTANCE), 0.);
+		_frame_budget    = std::max(obs_data_get_double(data.get(), ST_CFG_BUDGET_FRAME), 0.);
+	}
+}
+
+bool streamfx::obs::watchdog::is_enabled()
+{
+	return _enabled;
+}
+
+bool streamfx::obs::watchdog::account(uint64_t id, std::chrono::nanoseconds cost, bool& frame_over)
+{
+	std::unique_lock<decltype(_lock)> lock(_lock);
+
+	if (uint64_t frame = obs_get_video_frame_time(); frame != _frame) {
+		// The previous frame is complete, so the most expensive instance in it is known now.
+		_frame_over_id = (_frame_total > _frame_limit) ? _frame_max_id : 0;
+
+		_frame        = frame;
+		_frame_total  = std::chrono::nanoseconds(0);
+		_frame_max    = std::chrono::nanoseconds(0);
+		_frame_max_id = 0;
+
+		// The frame rate may change at any time, so keep the limits up to date.
+		if (obs_video_info ovi; obs_get_video_info(&ovi) && (ovi.fps_num > 0)) {
+			double interval = 1000. * static_cast<double>(ovi.fps_den) / static_cast<double>(ovi.fps_num);
+			_instance_limit = std::chrono::nanoseconds(static_cast<int64_t>(1000000. * ((_instance_budget > 0.) ? _instance_budget : (interval * default_instance_budget))));
+			_frame_limit    = std::chrono::nanoseconds(static_cast<int64_t>(1000000. * ((_frame_budget > 0.) ? _frame_budget : (interval * default_frame_budget))));
+		}
+	}
+
+	_frame_total += cost;
+	if (cost >= _frame_max) {
+		_frame_max    = cost;
+		_frame_max_id = id;
+	}
+
+	frame_over = (_frame_over_id == id);
+	return (cost > _instance_limit) || frame_over;
+}
+
+std::shared_ptr<streamfx::obs::watchdog> streamfx::obs::watchdog::instance()
+{
+	static std::weak_ptr<streamfx::obs::watchdog> winst;
+	static std::mutex                             mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::obs::watchdog>(new streamfx::obs::watchdog());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::obs::watchdog> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = streamfx::obs::watchdog::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -0,0 +1,157 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-timer.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include "warning-enable.hpp"
+
+/* watchdog keeps a single expensive instance from taking down the entire
+ *  render loop.
+ *
+ * Every video_render call is measured: CPU time excluding any nested StreamFX
+ *  instances, and GPU time where timer queries are available. An instance is
+ *  over budget if it alone exceeds the per-instance budget, or if it was the
+ *  most expensive one in the previous frame and that frame exceeded the
+ *  per-frame budget. After being over budget for a number of frames in a row,
+ *  it is degraded one step further, skipping any step it doesn't support:
+ * - Resolution: Render at a reduced internal resolution.
+ * - Cached: Keep showing the last output instead of rendering again.
+ * - Bypass: Skip the filter entirely (filters only).
+ * Degraded instances are given another chance after a while, and the time
+ *  until then doubles each time they fail again. The watchdog is off unless
+ *  enabled in the configuration.
+ */
+
+namespace streamfx::obs {
+	class source_instance;
+
+	enum class degradation : uint8_t {
+		None,
+		Resolution,
+		Cached,
+		Bypass,
+	};
+
+	class watchdog {
+		public:
+		class tracker {
+			std::shared_ptr<streamfx::obs::watchdog> _watchdog;
+			uint64_t                                 _id;
+			degradation                              _level;
+
+			// Measurement
+			bool                                           _running;
+			tracker*                                       _parent;
+			std::chrono::high_resolution_clock::time_point _start;
+			std::chrono::nanoseconds                       _children;
+			std::unique_ptr<::streamfx::obs::gs::timer>    _gpu;
+			std::chrono::nanoseconds                       _gpu_last;
+			bool                                           _gpu_sampling;
+			bool                                           _gpu_valid;
+			uint32_t                                       _gpu_frame;
+			std::chrono::nanoseconds                       _cpu_last;
+			bool                                           _measure;
+
+			// Decision
+			uint32_t                                       _over;
+			std::chrono::nanoseconds                       _over_total;
+			bool                                           _over_frame;
+			std::chrono::high_resolution_clock::time_point _changed;
+			std::chrono::seconds                           _hold;
+			bool                                           _restored;
+			bool                                           _exhausted;
+
+			public:
+			~tracker();
+			tracker();
+
+			degradation level();
+
+			/** Measure every call even if the watchdog is disabled, but never degrade or restore.
+			 *
+			 * Used while replaying captures, where the cost of each instance is what we want to know.
+			 */
+			void measure(bool enable);
+
+			/** Exclusive CPU time of the last measured call.
+			 */
+			std::chrono::nanoseconds cpu_time();
+
+			/** GPU time of the last measured call.
+			 *
+			 * @return false if there is none, or it would include nested instances.
+			 */
+			bool gpu_time(std::chrono::nanoseconds& duration);
+
+			/** Start measuring a call to video_render.
+			 */
+			void begin();
+
+			/** Stop measuring, and degrade or restore the instance if necessary.
+			 *
+			 * @param can_bypass Whether the instance may be skipped entirely.
+			 */
+			void end(::streamfx::obs::source_instance* instance, bool can_bypass);
+
+			/** Called instead of begin/end while bypassed, so that the instance eventually gets another chance.
+			 */
+			void skip(::streamfx::obs::source_instance* instance);
+
+			private:
+			void escalate(::streamfx::obs::source_instance* instance, bool can_bypass, std::chrono::high_resolution_clock::time_point now);
+			void restore(::streamfx::obs::source_instance* instance, std::chrono::high_resolution_clock::time_point now);
+		};
+
+		class scope {
+			tracker&                           _tracker;
+			::streamfx::obs::source_instance* _instance;
+			bool                               _can_bypass;
+
+			public:
+			scope(tracker& tracker, ::streamfx::obs::source_instance* instance, bool can_bypass);
+			~scope();
+		};
+
+		private:
+		bool                     _enabled;
+		double                   _instance_budget; // Milliseconds, 0 for automatic.
+		double                   _frame_budget;    // Milliseconds, 0 for automatic.
+		std::mutex               _lock;
+		uint64_t                 _frame;
+		std::chrono::nanoseconds _frame_total;
+		std::chrono::nanoseconds _frame_max;
+		uint64_t                 _frame_max_id;
+		uint64_t                 _frame_over_id;
+		std::chrono::nanoseconds _instance_limit;
+		std::chrono::nanoseconds _frame_limit;
+
+		public:
+		~watchdog();
+		watchdog();
+
+		bool is_enabled();
+
+		/** Add an instance's cost to the current frame.
+		 *
+		 * Which instance was the most expensive is only known once a frame is complete, so the per-frame
+		 *  budget is judged one frame late.
+		 *
+		 * @param id Unique id of the tracker.
+		 * @param frame_over Set if the instance was the most expensive one in the previous frame, and that frame was over budget.
+		 * @return true if the instance is over its own budget, or frame_over was set.
+		 */
+		bool account(uint64_t id, std::chrono::nanoseconds cost, bool& frame_over);
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::obs::watchdog> instance();
+	};
+
+	const char* degradation_to_string(degradation level);
+} // namespace streamfx::obs
@@ -0,0 +1,395 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "source-replay.hpp"
+#include "strings.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-tools.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<source::replay> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_I18N "Source.Replay"
+#define ST_I18N_PATH ST_I18N ".Path"
+#define ST_KEY_PATH "Path"
+#define ST_I18N_LOOP ST_I18N ".Loop"
+#define ST_KEY_LOOP "Loop"
+
+// Frames read ahead of playback, enough to cover a slow disk for a moment without holding much memory.
+static constexpr std::size_t read_ahead_frames = 4;
+
+using namespace streamfx::source::replay;
+
+void replay_instance::statistics::add(std::chrono::nanoseconds value)
+{
+	double ms = static_cast<double>(value.count()) / 1000000.;
+	minimum   = (count > 0) ? std::min(minimum, ms) : ms;
+	maximum   = (count > 0) ? std::max(maximum, ms) : ms;
+	total += ms;
+	count++;
+}
+
+replay_instance::replay_instance(obs_data_t* data, obs_source_t* self)
+	: obs::source_instance(data, self), _path(), _loop(true), _reopen(false), _read_thread(), _read_lock(), _read_wake(), _read_queue(), _read_exit(false), _reader(), _frame(), _finished(false), _uploaded(false), _rendered(false), _texture(), _filters(), _frames(0), _recorded(0)
+{
+	update(data);
+}
+
+replay_instance::~replay_instance()
+{
+	stop_read_ahead();
+	_filters.clear();
+
+	auto gctx = obs::gs::context();
+	_texture.reset();
+}
+
+uint32_t replay_instance::get_width()
+{
+	return _frame.width;
+}
+
+uint32_t replay_instance::get_height()
+{
+	return _frame.height;
+}
+
+void replay_instance::load(obs_data_t* settings)
+{
+	update(settings);
+}
+
+void replay_instance::migrate(obs_data_t* data, uint64_t version) {}
+
+void replay_instance::update(obs_data_t* data)
+{
+	std::string path = obs_data_get_string(data, ST_KEY_PATH);
+	_loop            = obs_data_get_bool(data, ST_KEY_LOOP);
+
+	// Filters can't be added while we are still being created, so this waits for the next tick.
+	if (path != _path) {
+		_path   = path;
+		_reopen = true;
+	}
+}
+
+void replay_instance::video_tick(float)
+{
+	if (_reopen.exchange(false)) {
+		close();
+		if (!_path.empty()) {
+			try {
+				open();
+			} catch (const std::exception& ex) {
+				D_LOG_ERROR("Failed to open capture '%s': %s", _path.c_str(), ex.what());
+				close();
+			}
+		}
+	}
+
+	if (!_reader || _finished) {
+		return;
+	}
+
+	// The filters rendered the previous frame since the last tick, so their timings are about it.
+	if (_rendered) {
+		collect();
+		_rendered = false;
+	}
+
+	// At most one frame per tick, no matter how long the tick was.
+	prefetched entry{};
+	{
+		std::unique_lock<std::mutex> lock(_read_lock);
+		if (_read_queue.empty()) {
+			return;
+		}
+		entry = std::move(_read_queue.front());
+		_read_queue.pop_front();
+	}
+	_read_wake.notify_all();
+
+	if (!entry.error.empty()) {
+		D_LOG_ERROR("Failed to read capture '%s': %s", _path.c_str(), entry.error.c_str());
+		_finished = true;
+		return;
+	}
+	if (entry.end || entry.rewound) {
+		report();
+		if (entry.end) {
+			_finished = true;
+			return;
+		}
+		reset();
+	}
+
+	_frame    = std::move(entry.frame);
+	_uploaded = false;
+}
+
+void replay_instance::video_render(gs_effect_t* effect)
+{
+	if (!_reader || (_frame.width == 0) || (_frame.height == 0)) {
+		return;
+	}
+
+#if defined(ENABLE_PROFILING) && !defined(D_PLATFORM_MAC) && _DEBUG
+	streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_source, "Benchmark Replay '%s'", obs_source_get_name(_self)};
+#endif
+
+	if (!_uploaded) {
+		if (!_texture || (_texture->get_width() != _frame.width) || (_texture->get_height() != _frame.height)) {
+			_texture = std::make_shared<streamfx::obs::gs::texture>(_frame.width, _frame.height, GS_RGBA, 1, nullptr, streamfx::obs::gs::texture::flags::Dynamic);
+		}
+		gs_texture_set_image(_texture->get_object(), _frame.data.data(), _frame.width * 4, false);
+		_uploaded = true;
+		_rendered = true;
+	}
+
+	gs_effect_t* default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(default_effect, "image"), _texture->get_object());
+	while (gs_effect_loop(default_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, _frame.width, _frame.height);
+	}
+}
+
+void replay_instance::open()
+{
+	_reader = std::make_unique<streamfx::util::capture::reader>(std::filesystem::u8path(_path));
+
+	auto& header = _reader->get_header();
+	auto  chain  = std::shared_ptr<obs_data_t>(obs_data_create_from_json(header.chain.c_str()), obs::obs_data_deleter);
+	if (!chain) {
+		throw std::runtime_error("Capture contains an invalid filter chain.");
+	}
+
+	// Recreate the filters the capture was recorded with, in the same order.
+	obs_data_array_t* filters = obs_data_get_array(chain.get(), "filters");
+	for (std::size_t idx = 0, edx = obs_data_array_count(filters); idx < edx; idx++) {
+		obs_data_t*   data   = obs_data_array_item(filters, idx);
+		obs_source_t* filter = obs_load_private_source(data);
+		obs_data_release(data);
+		if (!filter) {
+			D_LOG_WARNING("Failed to recreate filter %zu of capture '%s', skipping it.", idx, _path.c_str());
+			continue;
+		}
+		obs_source_filter_add(_self, filter);
+
+		measurement entry{::streamfx::obs::source(filter, false, true), nullptr, {}, {}};
+
+		// Anything with our prefix was created by a source_factory, which hands out source_instance pointers.
+		if (strncmp(obs_source_get_id(filter), S_PREFIX, strlen(S_PREFIX)) == 0) {
+			entry.instance = static_cast<::streamfx::obs::source_instance*>(obs_obj_get_data(filter));
+			if (entry.instance) {
+				entry.instance->get_watchdog().measure(true);
+			}
+		}
+		_filters.push_back(std::move(entry));
+	}
+	obs_data_array_release(filters);
+
+	_finished = false;
+	_uploaded = false;
+	_rendered = false;
+	reset();
+
+	_read_exit   = false;
+	_read_thread = std::thread([this]() { read_ahead(); });
+
+	D_LOG_INFO("Replaying capture '%s' (%" PRIu32 "x%" PRIu32 " at %" PRIu32 "/%" PRIu32 " fps) through %zu filters.", _path.c_str(), header.width, header.height, header.fps_num, header.fps_den, _filters.size());
+}
+
+void replay_instance::close()
+{
+	stop_read_ahead();
+
+	for (auto& entry : _filters) {
+		obs_source_filter_remove(_self, entry.filter.get());
+	}
+	_filters.clear();
+	_reader.reset();
+	_frame = {};
+}
+
+void replay_instance::read_ahead()
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_read_lock);
+			_read_wake.wait(lock, [this]() { return _read_exit || (_read_queue.size() < read_ahead_frames); });
+			if (_read_exit) {
+				return;
+			}
+		}
+
+		// Only this thread touches the reader while it runs.
+		prefetched entry{{}, false, false, {}};
+		try {
+			if (!_reader->read(entry.frame)) {
+				if (_loop) {
+					_reader->rewind();
+					if (!_reader->read(entry.frame)) {
+						throw std::runtime_error("Capture contains no frames.");
+					}
+					entry.rewound = true;
+				} else {
+					entry.end = true;
+				}
+			}
+		} catch (const std::exception& ex) {
+			entry.end   = true;
+			entry.error = ex.what();
+		}
+
+		bool end = entry.end;
+		{
+			std::unique_lock<std::mutex> lock(_read_lock);
+			_read_queue.push_back(std::move(entry));
+		}
+		if (end) {
+			return;
+		}
+	}
+}
+
+void replay_instance::stop_read_ahead()
+{
+	if (_read_thread.joinable()) {
+		{
+			std::unique_lock<std::mutex> lock(_read_lock);
+			_read_exit = true;
+		}
+		_read_wake.notify_all();
+		_read_thread.join();
+	}
+	_read_queue.clear();
+}
+
+void replay_instance::collect()
+{
+	_frames++;
+	_recorded += static_cast<double>(_frame.seconds);
+	for (auto& entry : _filters) {
+		if (!entry.instance) {
+			continue;
+		}
+
+		auto& tracker = entry.instance->get_watchdog();
+		entry.cpu.add(tracker.cpu_time());
+		if (std::chrono::nanoseconds gpu; tracker.gpu_time(gpu)) {
+			entry.gpu.add(gpu);
+		}
+	}
+}
+
+void replay_instance::report()
+{
+	D_LOG_INFO("Replayed %zu frames of '%s', covering %.2f seconds as recorded:", _frames, _path.c_str(), _recorded);
+	for (auto& entry : _filters) {
+		const char* name = obs_source_get_name(entry.filter.get());
+		const char* id   = obs_source_get_id(entry.filter.get());
+		if (!entry.instance || (entry.cpu.count == 0)) {
+			D_LOG_INFO("  '%s' (%s): Not measured.", name, id);
+			continue;
+		}
+
+		auto& cpu = entry.cpu;
+		auto& gpu = entry.gpu;
+		if (gpu.count > 0) {
+			D_LOG_INFO("  '%s' (%s): CPU %.3f / %.3f / %.3f ms, GPU %.3f / %.3f / %.3f ms (avg / min / max).", name, id, cpu.total / static_cast<double>(cpu.count), cpu.minimum, cpu.maximum, gpu.total / static_cast<double>(gpu.count), gpu.minimum, gpu.maximum);
+		} else {
+			D_LOG_INFO("  '%s' (%s): CPU %.3f / %.3f / %.3f ms (avg / min / max), GPU not available.", name, id, cpu.total / static_cast<double>(cpu.count), cpu.minimum, cpu.maximum);
+		}
+	}
+}
+
+void replay_instance::reset()
+{
+	_frames   = 0;
+	_recorded = 0;
+	for (auto& entry : _filters) {
+		entry.cpu = {};
+		entry.gpu = {};
+	}
+}
+
+replay_factory::replay_factory()
+{
+	_info.id           = S_PREFIX "source-replay";
+	_info.type         = OBS_SOURCE_TYPE_INPUT;
+	_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW;
+
+	finish_setup();
+}
+
+replay_factory::~replay_factory() {}
+
+const char* replay_factory::get_name()
+{
+	return D_TRANSLATE(ST_I18N);
+}
+
+void replay_factory::get_defaults2(obs_data_t* data)
+{
+	obs_data_set_default_string(data, ST_KEY_PATH, "");
+	obs_data_set_default_bool(data, ST_KEY_LOOP, true);
+}
+
+obs_properties_t* replay_factory::get_properties2(replay_instance* data)
+{
+	obs_properties_t* pr = obs_properties_create();
+
+	{
+		obs_properties_add_path(pr, ST_KEY_PATH, D_TRANSLATE(ST_I18N_PATH), OBS_PATH_FILE, "StreamFX Capture (*.sfxc)", nullptr);
+	}
+	{
+		obs_properties_add_bool(pr, ST_KEY_LOOP, D_TRANSLATE(ST_I18N_LOOP));
+	}
+
+	return pr;
+}
+
+std::shared_ptr<replay_factory> replay_factory::instance()
+{
+	static std::weak_ptr<replay_factory> winst;
+	static std::mutex                    mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<replay_factory>(new replay_factory());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<replay_factory> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = replay_factory::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::NORMAL);
@@ -0,0 +1,123 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-source-factory.hpp"
+#include "obs/obs-source.hpp"
+#include "util/util-capture-file.hpp"
+
+#include "warning-disable.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "warning-enable.hpp"
+
+namespace streamfx::source::replay {
+	/** Plays back a capture through the filters it was recorded with, one frame per tick, and reports what each filter cost.
+	 *
+	 * Frames are read ahead on a separate thread, so that the graphics thread never waits for the disk. If reading
+	 *  falls behind, the previous frame is kept for another tick and not measured again.
+	 */
+	class replay_instance : public obs::source_instance {
+		struct statistics {
+			std::size_t count;
+			double      total; // Milliseconds
+			double      minimum;
+			double      maximum;
+
+			void add(std::chrono::nanoseconds value);
+		};
+
+		struct measurement {
+			::streamfx::obs::source           filter;
+			::streamfx::obs::source_instance* instance; // Only for StreamFX filters, others can't be measured.
+			statistics                        cpu;
+			statistics                        gpu;
+		};
+
+		struct prefetched {
+			streamfx::util::capture::frame frame;
+			bool                           rewound; // The capture ended before this frame and started over.
+			bool                           end;     // Nothing follows, and frame is empty.
+			std::string                    error;
+		};
+
+		// Settings
+		std::string       _path;
+		std::atomic<bool> _loop;
+		std::atomic<bool> _reopen;
+
+		// Read Ahead
+		std::thread             _read_thread;
+		std::mutex              _read_lock;
+		std::condition_variable _read_wake;
+		std::deque<prefetched>  _read_queue;
+		bool                    _read_exit;
+
+		// Playback
+		std::unique_ptr<streamfx::util::capture::reader> _reader;
+		streamfx::util::capture::frame                   _frame;
+		bool                                             _finished;
+		bool                                             _uploaded;
+		bool                                             _rendered;
+		std::shared_ptr<streamfx::obs::gs::texture>      _texture;
+
+		// Benchmark
+		std::vector<measurement> _filters;
+		std::size_t              _frames;
+		double                   _recorded; // Seconds covered by the replayed frames when they were recorded.
+
+		public:
+		replay_instance(obs_data_t*, obs_source_t*);
+		virtual ~replay_instance() override;
+
+		virtual uint32_t get_width() override;
+		virtual uint32_t get_height() override;
+
+		virtual void load(obs_data_t* settings) override;
+		virtual void migrate(obs_data_t* data, uint64_t version) override;
+		virtual void update(obs_data_t*) override;
+
+		virtual void video_tick(float) override;
+		virtual void video_render(gs_effect_t*) override;
+
+		private:
+		void open();
+
+		void close();
+
+		void read_ahead();
+
+		void stop_read_ahead();
+
+		void collect();
+
+		void report();
+
+		void reset();
+	};
+
+	class replay_factory : public obs::source_factory<source::replay::replay_factory, source::replay::replay_instance> {
+		public:
+		replay_factory();
+		virtual ~replay_factory() override;
+
+		virtual const char* get_name() override;
+
+		virtual void get_defaults2(obs_data_t* data) override;
+
+		virtual obs_properties_t* get_properties2(source::replay::replay_instance* data) override;
+
+		public: // Singleton
+		static std::shared_ptr<replay_factory> instance();
+	};
+} // namespace streamfx::source::replay
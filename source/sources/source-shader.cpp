@@ -93,6 +93,11 @@ void shader_instance::video_render(gs_effect_t* effect)
 	_fx->render(effect);
 }
 
+bool shader_instance::degrade(::streamfx::obs::degradation level)
+{
+	return _fx && _fx->degrade(level);
+}
+
 void streamfx::source::shader::shader_instance::show()
 {
 	_fx->set_visible(true);
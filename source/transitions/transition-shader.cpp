@@ -103,6 +103,18 @@ void shader_instance::transition_render(gs_texture_t* a, gs_texture_t* b, float_
 	_fx->render(nullptr);
 }
 
+bool shader_instance::degrade(::streamfx::obs::degradation level)
+{
+	// A frozen transition would look broken, so only the resolution may be reduced.
+	switch (level) {
+	case ::streamfx::obs::degradation::None:
+	case ::streamfx::obs::degradation::Resolution:
+		return _fx && _fx->degrade(level);
+	default:
+		return false;
+	}
+}
+
 bool shader_instance::audio_render(uint64_t* ts_out, obs_source_audio_mix* audio_output, uint32_t mixers, std::size_t channels, std::size_t sample_rate)
 {
 	return obs_transition_audio_render(
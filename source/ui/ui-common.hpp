@@ -9,6 +9,7 @@
 #include <QAction>
 #include <QDesktopServices>
 #include <QDialog>
+#include <QInputDialog>
 #include <QLayout>
 #include <QLayoutItem>
 #include <QMainWindow>
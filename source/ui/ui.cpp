@@ -7,6 +7,7 @@
 #include "strings.hpp"
 #include "ui-common.hpp"
 #include "configuration.hpp"
+#include "obs/gs/gs-ledger.hpp"
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 #include "ui/ui-obs-browser-widget.hpp"
@@ -26,6 +27,8 @@ constexpr std::string_view _i18n_menu_youtube = "UI.Menu.YouTube";
 constexpr std::string_view _i18n_menu_twitter = "UI.Menu.Twitter";
 constexpr std::string_view _i18n_menu_github  = "UI.Menu.Github";
 constexpr std::string_view _i18n_menu_about   = "UI.Menu.About";
+constexpr std::string_view _i18n_menu_budget  = "UI.Menu.GPUMemoryBudget";
+constexpr std::string_view _i18n_budget_text  = "UI.GPUMemoryBudget.Text";
 
 // Configuration
 constexpr std::string_view _cfg_have_shown_about = "UI.HaveShownAboutStreamFX";
@@ -68,7 +71,7 @@ bool streamfx::ui::handler::have_shown_about_streamfx(bool shown)
 streamfx::ui::handler::handler()
 	: QObject(), _menu_action(), _menu(),
 
-	  _action_support(), _action_wiki(), _action_website(), _action_discord(), _action_twitter(), _action_youtube(),
+	  _action_support(), _action_wiki(), _action_website(), _action_discord(), _action_twitter(), _action_youtube(), _action_gpu_budget(),
 
 	  _about_action(), _about_dialog(),
 
@@ -131,6 +134,8 @@ void streamfx::ui::handler::on_obs_loaded()
 		// Discord
 		// Twitter
 		// YouTube
+		// ---
+		// GPU Memory Budget
 		// <--->
 		// <Updater>
 		// ---
@@ -167,6 +172,13 @@ void streamfx::ui::handler::on_obs_loaded()
 			connect(_action_youtube, &QAction::triggered, this, &streamfx::ui::handler::on_action_youtube);
 		}
 
+		_menu->addSeparator();
+		{
+			_action_gpu_budget = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_budget.data())));
+			_action_gpu_budget->setMenuRole(QAction::NoRole);
+			connect(_action_gpu_budget, &QAction::triggered, this, &streamfx::ui::handler::on_action_gpu_budget);
+		}
+
 		// Create the updater.
 #ifdef ENABLE_UPDATER
 		_updater = streamfx::ui::updater::instance(_menu);
@@ -252,6 +264,16 @@ void streamfx::ui::handler::on_action_youtube(bool)
 	QDesktopServices::openUrl(QUrl(QString::fromUtf8(_url_youtube.data())));
 }
 
+void streamfx::ui::handler::on_action_gpu_budget(bool)
+{
+	auto ledger = streamfx::obs::gs::ledger::instance();
+	bool ok     = false;
+	int  budget = QInputDialog::getInt(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()), QString::fromUtf8(D_TRANSLATE(_i18n_menu_budget.data())), QString::fromUtf8(D_TRANSLATE(_i18n_budget_text.data())), static_cast<int>(ledger->get_budget() >> 20), 0, 1048576, 64, &ok);
+	if (ok) {
+		ledger->set_budget(static_cast<uint64_t>(budget) << 20, true);
+	}
+}
+
 void streamfx::ui::handler::on_action_about(bool checked)
 {
 	_about_dialog->show();
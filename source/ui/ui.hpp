@@ -25,6 +25,7 @@ namespace streamfx::ui {
 		QAction* _action_discord;
 		QAction* _action_twitter;
 		QAction* _action_youtube;
+		QAction* _action_gpu_budget;
 
 		// About Dialog
 		QAction*   _about_action;
@@ -60,6 +61,7 @@ namespace streamfx::ui {
 		void on_action_discord(bool);
 		void on_action_twitter(bool);
 		void on_action_youtube(bool);
+		void on_action_gpu_budget(bool);
 
 		// About
 		void on_action_about(bool);
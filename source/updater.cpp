@@ -217,14 +217,23 @@ streamfx::version_info::operator std::string()
 	}
 }
 
-void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
+struct updater_query {
+	std::unique_ptr<streamfx::util::curl> curl;
+	std::vector<char>                     buffer;
+	size_t                                buffer_offset = 0;
+};
+
+bool streamfx::updater::task(streamfx::util::threadpool::task_data_t data)
 {
+	auto query = std::static_pointer_cast<updater_query>(data);
 	try {
-		auto query_fn = [](std::vector<char>& buffer) {
+		auto start_fn = [](updater_query& query) {
 			static constexpr std::string_view ST_API_URL = "https://api.github.com/repos/Xaymar/obs-StreamFX/releases?per_page=25&page=1";
 
-			streamfx::util::curl curl;
-			size_t               buffer_offset = 0;
+			query.curl   = std::make_unique<streamfx::util::curl>();
+			auto& curl   = *query.curl;
+			auto& buffer = query.buffer;
+			auto& offset = query.buffer_offset;
 
 			// Set headers (User-Agent is needed so Github can contact us!).
 			curl.set_header("User-Agent", "StreamFX Updater v" STREAMFX_VERSION_STRING);
@@ -237,31 +246,36 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 			curl.set_option(CURLOPT_TIMEOUT, 30); // 10s until we fail.
 
 			// Callbacks
-			curl.set_write_callback([&buffer, &buffer_offset](void* data, size_t s1, size_t s2) {
+			curl.set_write_callback([&buffer, &offset](void* data, size_t s1, size_t s2) {
 				size_t size = s1 * s2;
-				if (buffer.size() < (size + buffer_offset))
-					buffer.resize(buffer_offset + size);
+				if (buffer.size() < (size + offset))
+					buffer.resize(offset + size);
 
-				memcpy(buffer.data() + buffer_offset, data, size);
-				buffer_offset += size;
+				memcpy(buffer.data() + offset, data, size);
+				offset += size;
 
 				return s1 * s2;
 			});
-			//std::bind(&streamfx::updater::task_write_cb, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
 
 			// Clear any unknown data and reserve 64KiB of memory.
 			buffer.clear();
 			buffer.reserve(0xFFFF);
 
-			// Finally, execute the request.
+			// Start the request, it is driven by later steps of the task.
 			D_LOG_DEBUG("Querying for latest releases...", "");
-			if (CURLcode res = curl.perform(); res != CURLE_OK) {
-				D_LOG_ERROR("Performing query failed with error: %s", curl_easy_strerror(res));
+			if (CURLcode res = curl.start(); res != CURLE_OK) {
+				D_LOG_ERROR("Starting query failed with error: %s", curl_easy_strerror(res));
 				throw std::runtime_error(curl_easy_strerror(res));
 			}
+		};
+		auto finish_fn = [](updater_query& query, CURLcode result) {
+			if (result != CURLE_OK) {
+				D_LOG_ERROR("Performing query failed with error: %s", curl_easy_strerror(result));
+				throw std::runtime_error(curl_easy_strerror(result));
+			}
 
 			int32_t status_code = 0;
-			if (CURLcode res = curl.get_info(CURLINFO_HTTP_CODE, status_code); res != CURLE_OK) {
+			if (CURLcode res = query.curl->get_info(CURLINFO_HTTP_CODE, status_code); res != CURLE_OK) {
 				D_LOG_ERROR("Retrieving status code failed with error: %s", curl_easy_strerror(res));
 				throw std::runtime_error(curl_easy_strerror(res));
 			}
@@ -323,9 +337,16 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 				json = nlohmann::json::parse(fs);
 				fs.close();
 			} else {
-				std::vector<char> buffer;
-				query_fn(buffer);
-				json = nlohmann::json::parse(buffer.begin(), buffer.end());
+				// Don't hold up a worker while waiting for the network, yield until there is progress instead.
+				CURLcode result = CURLE_OK;
+				if (!query->curl) {
+					start_fn(*query);
+					return false;
+				} else if (!query->curl->step(result)) {
+					return false;
+				}
+				finish_fn(*query, result);
+				json = nlohmann::json::parse(query->buffer.begin(), query->buffer.end());
 			}
 
 			// Parse the JSON response from the API.
@@ -349,6 +370,7 @@ void streamfx::updater::task(streamfx::util::threadpool::task_data_t)
 		std::string message = ex.what();
 		events.error.call(*this, message);
 	}
+	return true;
 }
 
 bool streamfx::updater::can_check()
@@ -485,7 +507,7 @@ void streamfx::updater::refresh()
 		save();
 
 		// Spawn a new task.
-		_task = streamfx::threadpool()->push(std::bind(&streamfx::updater::task, this, std::placeholders::_1), nullptr);
+		_task = streamfx::threadpool()->push_steps(std::bind(&streamfx::updater::task, this, std::placeholders::_1), std::chrono::milliseconds(50), std::make_shared<updater_query>());
 	} else {
 		events.refreshed(*this);
 	}
@@ -66,7 +66,7 @@ namespace streamfx {
 		bool                                  _dirty;
 
 		private:
-		void task(streamfx::util::threadpool::task_data_t);
+		bool task(streamfx::util::threadpool::task_data_t);
 
 		bool can_check();
 
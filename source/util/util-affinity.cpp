@@ -0,0 +1,459 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-affinity.hpp"
+#include "common.hpp"
+#include "configuration.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include "warning-enable.hpp"
+
+#include "warning-disable.hpp"
+#if defined(D_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(D_PLATFORM_LINUX)
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::affinity> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_ENABLED "Affinity.Enabled"
+#define ST_CFG_RESERVED "Affinity.Reserved"
+#define ST_CFG_WORKER "Affinity.Worker"
+#define ST_CFG_ENCODER "Affinity.Encoder"
+#define ST_CFG_REPORT "Affinity.Report"
+
+// Systems with this many physical cores or less are left alone, there is nothing to isolate.
+static constexpr std::size_t minimum_cores = 2;
+
+// One physical core out of this many is kept free for OBS by default.
+static constexpr std::size_t reserve_ratio = 8;
+
+// Highest number of logical processors an affinity can refer to.
+#if defined(D_PLATFORM_WINDOWS)
+static constexpr uint64_t maximum_cpus = sizeof(DWORD_PTR) * 8;
+#elif defined(D_PLATFORM_LINUX)
+static constexpr uint64_t maximum_cpus = CPU_SETSIZE;
+#else
+static constexpr uint64_t maximum_cpus = 1024;
+#endif
+
+using namespace streamfx::util::affinity;
+
+static std::vector<cpus_t> detect_cores(const cpus_t& allowed)
+{
+	std::vector<cpus_t> cores;
+
+#if defined(D_PLATFORM_WINDOWS)
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+	std::vector<uint8_t> buffer(length);
+	if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+		return cores;
+	}
+
+	// Thread affinity is limited to the processor group we're in.
+	GROUP_AFFINITY group;
+	GetThreadGroupAffinity(GetCurrentThread(), &group);
+
+	for (DWORD offset = 0; offset < length;) {
+		auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+		if ((info->Relationship == RelationProcessorCore) && (info->Processor.GroupMask[0].Group == group.Group)) {
+			cpus_t core;
+			for (uint32_t idx = 0; idx < (sizeof(KAFFINITY) * 8); idx++) {
+				if ((info->Processor.GroupMask[0].Mask & (KAFFINITY(1) << idx)) && std::binary_search(allowed.begin(), allowed.end(), idx)) {
+					core.push_back(idx);
+				}
+			}
+			if (!core.empty()) {
+				cores.push_back(core);
+			}
+		}
+		offset += info->Size;
+	}
+#elif defined(D_PLATFORM_LINUX)
+	// Processors sharing a package and core id are SMT siblings.
+	std::map<std::pair<int32_t, int32_t>, cpus_t> siblings;
+	for (auto cpu : allowed) {
+		std::filesystem::path base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology";
+		int32_t               package = -1, core = static_cast<int32_t>(cpu);
+		std::ifstream(base / "physical_package_id") >> package;
+		std::ifstream(base / "core_id") >> core;
+		siblings[{package, core}].push_back(cpu);
+	}
+	for (auto& kv : siblings) {
+		cores.push_back(kv.second);
+	}
+#endif
+
+	std::sort(cores.begin(), cores.end(), [](const cpus_t& a, const cpus_t& b) { return a.front() < b.front(); });
+	return cores;
+}
+
+static cpus_t get_process_cpus()
+{
+	cpus_t cpus;
+#if defined(D_PLATFORM_WINDOWS)
+	DWORD_PTR process = 0, system = 0;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) {
+		for (uint32_t idx = 0; idx < (sizeof(DWORD_PTR) * 8); idx++) {
+			if (process & (DWORD_PTR(1) << idx)) {
+				cpus.push_back(idx);
+			}
+		}
+	}
+#elif defined(D_PLATFORM_LINUX)
+	// The main thread carries the affinity (and cpuset) the process was started with.
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(getpid(), sizeof(set), &set) == 0) {
+		for (uint32_t idx = 0; idx < CPU_SETSIZE; idx++) {
+			if (CPU_ISSET(idx, &set)) {
+				cpus.push_back(idx);
+			}
+		}
+	}
+#endif
+	if (cpus.empty()) {
+		for (uint32_t idx = 0, edx = std::max(std::thread::hardware_concurrency(), 1u); idx < edx; idx++) {
+			cpus.push_back(idx);
+		}
+	}
+	return cpus;
+}
+
+policy::~policy() {}
+
+policy::policy() : _enabled(false), _allowed(get_process_cpus()), _cores(detect_cores(_allowed)), _worker(_allowed), _encoder(_allowed)
+{
+#if defined(D_PLATFORM_WINDOWS) || defined(D_PLATFORM_LINUX)
+	int64_t     reserved = -1;
+	std::string worker;
+	std::string encoder;
+	if (auto config = streamfx::configuration::instance(); config) {
+		auto data = config->get();
+		obs_data_set_default_bool(data.get(), ST_CFG_ENABLED, false);
+		obs_data_set_default_int(data.get(), ST_CFG_RESERVED, -1);
+		obs_data_set_default_string(data.get(), ST_CFG_WORKER, "");
+		obs_data_set_default_string(data.get(), ST_CFG_ENCODER, "");
+		_enabled = obs_data_get_bool(data.get(), ST_CFG_ENABLED);
+		reserved = obs_data_get_int(data.get(), ST_CFG_RESERVED);
+		worker   = obs_data_get_string(data.get(), ST_CFG_WORKER);
+		encoder  = obs_data_get_string(data.get(), ST_CFG_ENCODER);
+	}
+	if (!_enabled) {
+		D_LOG_INFO("Affinity policy is disabled.", nullptr);
+		return;
+	}
+
+	// Keep the first few physical cores free, OBS threads have nowhere else to go.
+	if (_cores.size() > minimum_cores) {
+		std::size_t skip = (reserved >= 0) ? static_cast<std::size_t>(reserved) : std::max<std::size_t>(_cores.size() / reserve_ratio, 1);
+		skip             = std::min(skip, _cores.size() - 1);
+
+		cpus_t cpus;
+		for (std::size_t idx = skip; idx < _cores.size(); idx++) {
+			cpus.insert(cpus.end(), _cores[idx].begin(), _cores[idx].end());
+		}
+		std::sort(cpus.begin(), cpus.end());
+		_worker  = cpus;
+		_encoder = cpus;
+	}
+
+	// Explicit lists win, but are limited to what the process may use.
+	auto apply_list = [this](const std::string& text, cpus_t& target) {
+		cpus_t cpus = from_string(text), result;
+		std::set_intersection(cpus.begin(), cpus.end(), _allowed.begin(), _allowed.end(), std::back_inserter(result));
+		if (!result.empty()) {
+			target = result;
+		} else if (!text.empty()) {
+			D_LOG_WARNING("Ignoring processor list '%s', as none of it is available.", text.c_str());
+		}
+	};
+	apply_list(worker, _worker);
+	apply_list(encoder, _encoder);
+
+	D_LOG_INFO("Detected %zu physical cores with %zu logical processors (%s).", _cores.size(), _allowed.size(), to_string(_allowed).c_str());
+	D_LOG_INFO("Workers run on %s, encoders on %s.", to_string(_worker).c_str(), to_string(_encoder).c_str());
+#else
+	D_LOG_INFO("Affinity policy is not supported on this platform.", nullptr);
+#endif
+}
+
+bool policy::is_enabled()
+{
+	return _enabled;
+}
+
+cpus_t policy::get(role role)
+{
+	switch (role) {
+	case role::Worker:
+		return _worker;
+	case role::Encoder:
+		return _encoder;
+	}
+	return _allowed;
+}
+
+std::size_t policy::concurrency(role role)
+{
+	if (!_enabled) {
+		return std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	return get(role).size();
+}
+
+bool policy::apply(role role)
+{
+	if (!_enabled) {
+		return false;
+	}
+	return set_current(get(role));
+}
+
+void policy::report()
+{
+#if defined(D_PLATFORM_LINUX)
+	{
+		bool enabled = false;
+		if (auto config = streamfx::configuration::instance(); config) {
+			auto data = config->get();
+			obs_data_set_default_bool(data.get(), ST_CFG_REPORT, false);
+			enabled = obs_data_get_bool(data.get(), ST_CFG_REPORT);
+		}
+		if (!enabled) {
+			return;
+		}
+	}
+
+	// Group threads by name and allowed processors, and collect where they ran last.
+	struct entry {
+		std::size_t        count = 0;
+		std::set<uint32_t> last;
+	};
+	std::map<std::pair<std::string, std::string>, entry> threads;
+
+	std::error_code ec;
+	for (auto& task : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+		pid_t tid = static_cast<pid_t>(std::strtol(task.path().filename().c_str(), nullptr, 10));
+
+		std::string name;
+		std::getline(std::ifstream(task.path() / "comm"), name);
+
+		cpus_t    cpus;
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+			for (uint32_t idx = 0; idx < CPU_SETSIZE; idx++) {
+				if (CPU_ISSET(idx, &set)) {
+					cpus.push_back(idx);
+				}
+			}
+		}
+
+		// Field 39 is the processor the thread last ran on. The name may contain spaces, so skip past it first.
+		int32_t last = -1;
+		if (std::string stat; std::getline(std::ifstream(task.path() / "stat"), stat)) {
+			if (auto pos = stat.rfind(')'); pos != std::string::npos) {
+				std::istringstream sstr(stat.substr(pos + 2));
+				std::string        field;
+				for (std::size_t idx = 3; (idx <= 39) && (sstr >> field); idx++) {
+					if (idx == 39) {
+						last = std::atoi(field.c_str());
+					}
+				}
+			}
+		}
+
+		auto& e = threads[{name, to_string(cpus)}];
+		e.count++;
+		if (last >= 0) {
+			e.last.insert(static_cast<uint32_t>(last));
+		}
+	}
+
+	D_LOG_INFO("Thread placement (name, threads, allowed processors, last processors):", nullptr);
+	for (auto& kv : threads) {
+		cpus_t last(kv.second.last.begin(), kv.second.last.end());
+		D_LOG_INFO("  '%s': %zu, %s, %s", kv.first.first.c_str(), kv.second.count, kv.first.second.c_str(), to_string(last).c_str());
+	}
+#endif
+}
+
+std::shared_ptr<policy> policy::instance()
+{
+	static std::weak_ptr<policy> winst;
+	static std::mutex            mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<policy>(new policy());
+		winst    = instance;
+	}
+	return instance;
+}
+
+scope::~scope()
+{
+	if (_changed) {
+		set_current(_previous);
+	}
+}
+
+scope::scope(role role) : _previous(), _changed(false)
+{
+#if defined(D_PLATFORM_LINUX)
+	// Only useful where new threads inherit the affinity of their creator.
+	if (auto policy = policy::instance(); policy->is_enabled() && get_current(_previous)) {
+		_changed = policy->apply(role);
+	}
+#endif
+}
+
+bool streamfx::util::affinity::get_current(cpus_t& cpus)
+{
+	cpus.clear();
+#if defined(D_PLATFORM_WINDOWS)
+	// There is no getter, but setting returns the previous mask.
+	DWORD_PTR mask = SetThreadAffinityMask(GetCurrentThread(), ~DWORD_PTR(0));
+	if (mask == 0) {
+		return false;
+	}
+	SetThreadAffinityMask(GetCurrentThread(), mask);
+	for (uint32_t idx = 0; idx < (sizeof(DWORD_PTR) * 8); idx++) {
+		if (mask & (DWORD_PTR(1) << idx)) {
+			cpus.push_back(idx);
+		}
+	}
+	return true;
+#elif defined(D_PLATFORM_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+		return false;
+	}
+	for (uint32_t idx = 0; idx < CPU_SETSIZE; idx++) {
+		if (CPU_ISSET(idx, &set)) {
+			cpus.push_back(idx);
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool streamfx::util::affinity::set_current(const cpus_t& cpus)
+{
+	if (cpus.empty()) {
+		return false;
+	}
+
+#if defined(D_PLATFORM_WINDOWS)
+	DWORD_PTR mask = 0;
+	for (auto cpu : cpus) {
+		if (cpu < (sizeof(DWORD_PTR) * 8)) {
+			mask |= DWORD_PTR(1) << cpu;
+		}
+	}
+	return (mask != 0) && (SetThreadAffinityMask(GetCurrentThread(), mask) != 0);
+#elif defined(D_PLATFORM_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : cpus) {
+		if (cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &set);
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+std::string streamfx::util::affinity::to_string(const cpus_t& cpus)
+{
+	// Compact ranges, like the kernel does: "0-3,8,10-11".
+	std::stringstream sstr;
+	for (std::size_t idx = 0; idx < cpus.size();) {
+		std::size_t end = idx;
+		while (((end + 1) < cpus.size()) && (cpus[end + 1] == (cpus[end] + 1))) {
+			end++;
+		}
+		if (idx != 0) {
+			sstr << ",";
+		}
+		sstr << cpus[idx];
+		if (end != idx) {
+			sstr << "-" << cpus[end];
+		}
+		idx = end + 1;
+	}
+	return sstr.str();
+}
+
+cpus_t streamfx::util::affinity::from_string(std::string_view text)
+{
+	std::set<uint32_t> cpus;
+	std::stringstream  sstr{std::string(text)};
+	for (std::string part; std::getline(sstr, part, ',');) {
+		try {
+			if (auto pos = part.find('-'); pos != std::string::npos) {
+				// Anything past what an affinity can hold is meaningless, and would take forever to walk.
+				uint64_t first = std::stoull(part.substr(0, pos));
+				uint64_t last  = std::min<uint64_t>(std::stoull(part.substr(pos + 1)), maximum_cpus - 1);
+				for (uint64_t cpu = first; cpu <= last; cpu++) {
+					cpus.insert(static_cast<uint32_t>(cpu));
+				}
+			} else if (!part.empty()) {
+				if (uint64_t cpu = std::stoull(part); cpu < maximum_cpus) {
+					cpus.insert(static_cast<uint32_t>(cpu));
+				}
+			}
+		} catch (...) {
+			D_LOG_WARNING("Ignoring invalid processor range '%s'.", part.c_str());
+		}
+	}
+	return cpus_t(cpus.begin(), cpus.end());
+}
+
+static std::shared_ptr<policy> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = policy::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
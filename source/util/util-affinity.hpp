@@ -0,0 +1,87 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "warning-enable.hpp"
+
+/* CPU affinity policy for threads owned or spawned by StreamFX.
+ *
+ * The policy assigns worker threads and encoder threads to a set of logical
+ *  processors each, and is off unless enabled in the configuration. Unless
+ *  configured otherwise, the first few physical cores are kept free for the
+ *  OBS graphics, video and audio threads, and everything else is shared by
+ *  workers and encoders. SMT siblings are never split between sets, as they
+ *  share the same execution units anyway.
+ *
+ * Threads spawned by libraries (like FFmpeg) inherit the affinity of the
+ *  thread creating them on Linux, which is why encoders are opened inside of
+ *  an affinity::scope. Windows has no such inheritance, so there only threads
+ *  we own are placed.
+ */
+
+namespace streamfx::util::affinity {
+	typedef std::vector<uint32_t> cpus_t;
+
+	enum class role : uint8_t {
+		Worker,
+		Encoder,
+	};
+
+	class policy {
+		bool                _enabled;
+		cpus_t              _allowed;
+		std::vector<cpus_t> _cores; // Logical processors grouped by physical core.
+		cpus_t              _worker;
+		cpus_t              _encoder;
+
+		public:
+		~policy();
+		policy();
+
+		bool is_enabled();
+
+		cpus_t get(role role);
+
+		/** Number of threads that make sense for a role, for thread pools in libraries.
+		 */
+		std::size_t concurrency(role role);
+
+		/** Move the current thread to the processors of a role.
+		 */
+		bool apply(role role);
+
+		/** Log which processors each thread of the process may run on, and where it ran last.
+		 */
+		void report();
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::util::affinity::policy> instance();
+	};
+
+	/** Temporarily move the current thread to the processors of a role, so that any
+	 *  threads spawned in the mean time start out there too.
+	 */
+	class scope {
+		cpus_t _previous;
+		bool   _changed;
+
+		public:
+		~scope();
+		scope(role role);
+	};
+
+	bool get_current(cpus_t& cpus);
+
+	bool set_current(const cpus_t& cpus);
+
+	std::string to_string(const cpus_t& cpus);
+
+	cpus_t from_string(std::string_view text);
+} // namespace streamfx::util::affinity
@@ -0,0 +1,123 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-capture-file.hpp"
+
+#include "warning-disable.hpp"
+#include <cstring>
+#include <stdexcept>
+#include "warning-enable.hpp"
+
+static constexpr char     capture_magic[4] = {'S', 'F', 'X', 'C'};
+static constexpr uint32_t capture_version  = 1;
+
+// Anything larger than this is a broken file, not a frame.
+static constexpr uint32_t capture_size_limit = 16384;
+
+template<typename T>
+static inline void write_value(std::ofstream& stream, const T& value)
+{
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static inline bool read_value(std::ifstream& stream, T& value)
+{
+	return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+streamfx::util::capture::writer::~writer()
+{
+	_stream.flush();
+}
+
+streamfx::util::capture::writer::writer(const std::filesystem::path& path, const header& header) : _stream(path, std::ios::binary | std::ios::trunc)
+{
+	if (!_stream) {
+		throw std::runtime_error("Failed to open capture file for writing.");
+	}
+
+	_stream.write(capture_magic, sizeof(capture_magic));
+	write_value(_stream, capture_version);
+	write_value(_stream, header.width);
+	write_value(_stream, header.height);
+	write_value(_stream, header.fps_num);
+	write_value(_stream, header.fps_den);
+	write_value(_stream, static_cast<uint32_t>(header.chain.size()));
+	_stream.write(header.chain.data(), static_cast<std::streamsize>(header.chain.size()));
+
+	if (!_stream) {
+		throw std::runtime_error("Failed to write capture header.");
+	}
+}
+
+void streamfx::util::capture::writer::write(const frame& frame)
+{
+	if (frame.data.size() != (static_cast<std::size_t>(frame.width) * frame.height * 4)) {
+		throw std::invalid_argument("Frame data does not match its size.");
+	}
+
+	write_value(_stream, frame.timestamp);
+	write_value(_stream, frame.seconds);
+	write_value(_stream, frame.width);
+	write_value(_stream, frame.height);
+	_stream.write(reinterpret_cast<const char*>(frame.data.data()), static_cast<std::streamsize>(frame.data.size()));
+
+	if (!_stream) {
+		throw std::runtime_error("Failed to write capture frame.");
+	}
+}
+
+streamfx::util::capture::reader::~reader() {}
+
+streamfx::util::capture::reader::reader(const std::filesystem::path& path) : _stream(path, std::ios::binary), _header(), _first()
+{
+	if (!_stream) {
+		throw std::runtime_error("Failed to open capture file for reading.");
+	}
+
+	char     magic[sizeof(capture_magic)] = {0};
+	uint32_t version                      = 0;
+	uint32_t length                       = 0;
+	if (!_stream.read(magic, sizeof(magic)) || (std::memcmp(magic, capture_magic, sizeof(magic)) != 0)) {
+		throw std::runtime_error("Not a capture file.");
+	}
+	if (!read_value(_stream, version) || (version != capture_version)) {
+		throw std::runtime_error("Unsupported capture file version.");
+	}
+	if (!read_value(_stream, _header.width) || !read_value(_stream, _header.height) || !read_value(_stream, _header.fps_num) || !read_value(_stream, _header.fps_den) || !read_value(_stream, length)) {
+		throw std::runtime_error("Truncated capture header.");
+	}
+
+	_header.chain.resize(length);
+	if (!_stream.read(_header.chain.data(), static_cast<std::streamsize>(length))) {
+		throw std::runtime_error("Truncated capture header.");
+	}
+
+	_first = _stream.tellg();
+}
+
+const streamfx::util::capture::header& streamfx::util::capture::reader::get_header()
+{
+	return _header;
+}
+
+bool streamfx::util::capture::reader::read(frame& frame)
+{
+	if (!read_value(_stream, frame.timestamp) || !read_value(_stream, frame.seconds) || !read_value(_stream, frame.width) || !read_value(_stream, frame.height)) {
+		return false;
+	}
+	if ((frame.width == 0) || (frame.height == 0) || (frame.width > capture_size_limit) || (frame.height > capture_size_limit)) {
+		throw std::runtime_error("Corrupted capture frame.");
+	}
+
+	frame.data.resize(static_cast<std::size_t>(frame.width) * frame.height * 4);
+	return static_cast<bool>(_stream.read(reinterpret_cast<char*>(frame.data.data()), static_cast<std::streamsize>(frame.data.size())));
+}
+
+void streamfx::util::capture::reader::rewind()
+{
+	_stream.clear();
+	_stream.seekg(_first);
+}
@@ -0,0 +1,73 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cinttypes>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "warning-enable.hpp"
+
+/* Capture files hold the input of a filter chain for a short time window, so
+ *  that the chain can later be replayed frame by frame for benchmarking.
+ *
+ * Layout, all values in native byte order (little endian on every platform OBS
+ *  supports):
+ * - Header: "SFXC", version, width, height, fps_num, fps_den, chain length,
+ *   chain (JSON with the saved filters, as written by obs_save_source).
+ * - Frames until the end of the file: timestamp, seconds since the previous
+ *   frame, width, height, RGBA pixels without padding.
+ */
+
+namespace streamfx::util::capture {
+	struct header {
+		uint32_t    width;
+		uint32_t    height;
+		uint32_t    fps_num;
+		uint32_t    fps_den;
+		std::string chain;
+	};
+
+	struct frame {
+		uint64_t             timestamp; // Video frame time in nanoseconds.
+		float                seconds;   // Time since the previous frame, as passed to video_tick.
+		uint32_t             width;
+		uint32_t             height;
+		std::vector<uint8_t> data;
+	};
+
+	class writer {
+		std::ofstream _stream;
+
+		public:
+		~writer();
+		writer(const std::filesystem::path& path, const header& header);
+
+		void write(const frame& frame);
+	};
+
+	class reader {
+		std::ifstream  _stream;
+		header         _header;
+		std::streampos _first;
+
+		public:
+		~reader();
+		reader(const std::filesystem::path& path);
+
+		const header& get_header();
+
+		/** Read the next frame.
+		 *
+		 * @return false if there are no more frames.
+		 */
+		bool read(frame& frame);
+
+		/** Start over at the first frame.
+		 */
+		void rewind();
+	};
+} // namespace streamfx::util::capture
@@ -79,7 +79,7 @@ int32_t streamfx::util::curl::xferinfo_callback(streamfx::util::curl* self, curl
 	}
 }
 
-streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _headers()
+streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _headers(), _header_list(nullptr), _multi(nullptr)
 {
 	_curl = curl_easy_init();
 	set_read_callback(nullptr);
@@ -100,6 +100,11 @@ streamfx::util::curl::curl() : _curl(), _read_callback(), _write_callback(), _he
 
 streamfx::util::curl::~curl()
 {
+	if (_multi) {
+		curl_multi_remove_handle(_multi, _curl);
+		curl_multi_cleanup(_multi);
+	}
+	release_headers();
 	curl_easy_cleanup(_curl);
 }
 
@@ -123,11 +128,11 @@ size_t perform_get_kv_size(std::string_view a, std::string_view b)
 	return a.size() + 2 + b.size() + 1;
 };
 
-CURLcode streamfx::util::curl::perform()
+void streamfx::util::curl::apply_headers()
 {
-	std::vector<char>  buffer;
-	struct curl_slist* headers = nullptr;
+	std::vector<char> buffer;
 
+	release_headers();
 	if (_headers.size() > 0) {
 		// Calculate full buffer size.
 		{
@@ -145,24 +150,80 @@ CURLcode streamfx::util::curl::perform()
 
 				snprintf(&buffer.at(buffer_offset), size, "%s: %s", kv.first.c_str(), kv.second.c_str());
 
-				headers = curl_slist_append(headers, &buffer.at(buffer_offset));
+				_header_list = curl_slist_append(_header_list, &buffer.at(buffer_offset));
 
 				buffer_offset += size;
 			}
 		}
-		set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, headers);
+		set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, _header_list);
 	}
+}
 
-	CURLcode res = curl_easy_perform(_curl);
-
-	if (headers) {
+void streamfx::util::curl::release_headers()
+{
+	if (_header_list) {
 		set_option<struct curl_slist*>(CURLOPT_HTTPHEADER, nullptr);
-		curl_slist_free_all(headers);
+		curl_slist_free_all(_header_list);
+		_header_list = nullptr;
 	}
+}
 
+CURLcode streamfx::util::curl::perform()
+{
+	apply_headers();
+	CURLcode res = curl_easy_perform(_curl);
+	release_headers();
 	return res;
 }
 
+CURLcode streamfx::util::curl::start()
+{
+	if (_multi) {
+		curl_multi_remove_handle(_multi, _curl);
+	} else {
+		_multi = curl_multi_init();
+		if (!_multi) {
+			return CURLE_OUT_OF_MEMORY;
+		}
+	}
+
+	apply_headers();
+	if (CURLMcode res = curl_multi_add_handle(_multi, _curl); res != CURLM_OK) {
+		release_headers();
+		return CURLE_FAILED_INIT;
+	}
+	return CURLE_OK;
+}
+
+bool streamfx::util::curl::step(CURLcode& result)
+{
+	if (!_multi) {
+		result = CURLE_FAILED_INIT;
+		return true;
+	}
+
+	int running = 0;
+	if (CURLMcode res = curl_multi_perform(_multi, &running); res != CURLM_OK) {
+		result = CURLE_RECV_ERROR;
+	} else if (running > 0) {
+		return false;
+	} else {
+		// Find out how the transfer ended.
+		int      queued = 0;
+		CURLMsg* msg    = nullptr;
+		result          = CURLE_RECV_ERROR;
+		while ((msg = curl_multi_info_read(_multi, &queued)) != nullptr) {
+			if ((msg->msg == CURLMSG_DONE) && (msg->easy_handle == _curl)) {
+				result = msg->data.result;
+			}
+		}
+	}
+
+	curl_multi_remove_handle(_multi, _curl);
+	release_headers();
+	return true;
+}
+
 void streamfx::util::curl::reset()
 {
 	curl_easy_reset(_curl);
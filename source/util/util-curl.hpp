@@ -31,12 +31,17 @@ namespace streamfx::util {
 		curl_xferinfo_callback_t           _xferinfo_callback;
 		curl_debug_callback_t              _debug_callback;
 		std::map<std::string, std::string> _headers;
+		struct curl_slist*                 _header_list;
+		CURLM*                             _multi;
 
 		static int32_t debug_helper(CURL* handle, curl_infotype type, char* data, size_t size, streamfx::util::curl* userptr);
 		static size_t  read_helper(void*, size_t, size_t, streamfx::util::curl*);
 		static size_t  write_helper(void*, size_t, size_t, streamfx::util::curl*);
 		static int32_t xferinfo_callback(streamfx::util::curl*, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
 
+		void apply_headers();
+		void release_headers();
+
 		public:
 		curl();
 		~curl();
@@ -101,6 +106,17 @@ namespace streamfx::util {
 
 		CURLcode perform();
 
+		/** Start a transfer without blocking, to be driven by step().
+		 */
+		CURLcode start();
+
+		/** Advance a transfer started with start() as far as possible without blocking.
+		 *
+		 * @param result Result of the transfer, once it is done.
+		 * @return true if the transfer is done.
+		 */
+		bool step(CURLcode& result);
+
 		void reset();
 
 		public /* Helpers */:
@@ -0,0 +1,173 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-hugepage.hpp"
+#include "common.hpp"
+#include "util/util-logging.hpp"
+#include "util/utility.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <new>
+#if defined(D_PLATFORM_LINUX)
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#endif
+#include "warning-enable.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::hugepage> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+namespace {
+	// Buffers smaller than this gain next to nothing from huge pages, but would waste most of one.
+	constexpr std::size_t threshold = 1024 * 1024;
+
+	// The default huge page size on x86-64 and AArch64.
+	constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+	constexpr std::size_t regular_alignment = 64;
+
+	std::atomic<std::size_t> bytes_regular;
+	std::atomic<std::size_t> bytes_transparent;
+	std::atomic<std::size_t> bytes_explicit;
+
+	std::atomic<std::size_t>& bytes_for(streamfx::util::hugepage::backing_type backing)
+	{
+		switch (backing) {
+		case streamfx::util::hugepage::backing_type::EXPLICIT:
+			return bytes_explicit;
+		case streamfx::util::hugepage::backing_type::TRANSPARENT:
+			return bytes_transparent;
+		default:
+			return bytes_regular;
+		}
+	}
+
+#if defined(D_PLATFORM_LINUX)
+	// Transparent blocks that are still alive, by address.
+	std::mutex                        transparent_lock;
+	std::map<uintptr_t, std::size_t> transparent_blocks;
+
+	// Whether transparent huge pages were used is only visible in the mappings of the process.
+	std::size_t transparent_bytes()
+	{
+		std::map<uintptr_t, std::size_t> blocks;
+		{
+			std::lock_guard<std::mutex> lock(transparent_lock);
+			blocks = transparent_blocks;
+		}
+		if (blocks.empty()) {
+			return 0;
+		}
+
+		std::ifstream smaps("/proc/self/smaps");
+		std::size_t   total = 0;
+		uintptr_t     begin = 0;
+		uintptr_t     end   = 0;
+		for (std::string line; std::getline(smaps, line);) {
+			// Mapping headers start with "begin-end", in hexadecimal.
+			if (std::size_t dash = line.find('-'); (dash != std::string::npos) && (dash != 0) && std::all_of(line.begin(), line.begin() + static_cast<std::ptrdiff_t>(dash), [](char v) { return std::isxdigit(static_cast<unsigned char>(v)) != 0; })) {
+				begin = static_cast<uintptr_t>(std::stoull(line.substr(0, dash), nullptr, 16));
+				end   = static_cast<uintptr_t>(std::stoull(line.substr(dash + 1), nullptr, 16));
+			} else if (line.compare(0, 14, "AnonHugePages:") == 0) {
+				std::size_t kib = 0;
+				std::istringstream(line.substr(14)) >> kib;
+
+				// Neighbouring mappings may have been merged with ours, so this can never be more than what we mapped.
+				std::size_t mapped = 0;
+				for (auto kv = blocks.lower_bound(begin); (kv != blocks.end()) && (kv->first < end); kv++) {
+					mapped += kv->second;
+				}
+				total += std::min(kib * 1024, mapped);
+			}
+		}
+		return total;
+	}
+#endif
+} // namespace
+
+streamfx::util::hugepage::block streamfx::util::hugepage::allocate(std::size_t size)
+{
+	block result = {nullptr, size, backing_type::REGULAR};
+
+#if defined(D_PLATFORM_LINUX)
+	if (size >= threshold) {
+		std::size_t asize = ((size + huge_page_size - 1) / huge_page_size) * huge_page_size;
+
+		// Explicit huge pages only exist if the system reserved some for us.
+		if (void* data = mmap(nullptr, asize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); data != MAP_FAILED) {
+			result = {data, asize, backing_type::EXPLICIT};
+		} else if (void* data = mmap(nullptr, asize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); data != MAP_FAILED) {
+			// Transparent huge pages are a hint, the kernel may still decide otherwise.
+			madvise(data, asize, MADV_HUGEPAGE);
+			result = {data, asize, backing_type::TRANSPARENT};
+
+			std::lock_guard<std::mutex> lock(transparent_lock);
+			transparent_blocks.emplace(reinterpret_cast<uintptr_t>(data), asize);
+		}
+	}
+#endif
+
+	if (!result.data) {
+		result.data = streamfx::util::malloc_aligned(regular_alignment, size);
+		if (!result.data) {
+			throw std::bad_alloc();
+		}
+	}
+
+	// Fault everything in now, instead of in the middle of a copy.
+	std::memset(result.data, 0, result.size);
+
+	bytes_for(result.backing) += result.size;
+	return result;
+}
+
+void streamfx::util::hugepage::free(const block& block)
+{
+	if (!block.data) {
+		return;
+	}
+
+	bytes_for(block.backing) -= block.size;
+
+#if defined(D_PLATFORM_LINUX)
+	if (block.backing == backing_type::TRANSPARENT) {
+		std::lock_guard<std::mutex> lock(transparent_lock);
+		transparent_blocks.erase(reinterpret_cast<uintptr_t>(block.data));
+	}
+	if (block.backing != backing_type::REGULAR) {
+		munmap(block.data, block.size);
+		return;
+	}
+#endif
+	streamfx::util::free_aligned(block.data);
+}
+
+void streamfx::util::hugepage::report()
+{
+	constexpr double mib      = 1024. * 1024.;
+	std::size_t      obtained = 0;
+#if defined(D_PLATFORM_LINUX)
+	obtained = transparent_bytes();
+#endif
+	D_LOG_INFO("Buffers: %.1f MiB in explicit huge pages, %.1f MiB in transparent huge pages (%.1f MiB obtained), %.1f MiB in regular pages.", static_cast<double>(bytes_explicit.load()) / mib, static_cast<double>(bytes_transparent.load()) / mib, static_cast<double>(obtained) / mib, static_cast<double>(bytes_regular.load()) / mib);
+}
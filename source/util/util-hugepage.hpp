@@ -0,0 +1,47 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "warning-disable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "warning-enable.hpp"
+
+/* Large buffers, like uncompressed frames, backed by huge pages where possible.
+ *
+ * Touching a multi-megabyte buffer with regular pages means a TLB miss and,
+ *  the first time, a page fault every 4 KiB, which shows up as time spent in
+ *  copies and conversions. On Linux, explicit huge pages (MAP_HUGETLB) are
+ *  tried first, then transparent huge pages (MADV_HUGEPAGE), and regular pages
+ *  last. Every buffer is touched right away, so that faults happen when it is
+ *  allocated instead of when it is first used.
+ */
+
+namespace streamfx::util::hugepage {
+	enum class backing_type : uint8_t {
+		REGULAR,
+		TRANSPARENT,
+		EXPLICIT,
+	};
+
+	struct block {
+		void*        data;
+		std::size_t  size;    // Size as mapped, may be larger than requested.
+		backing_type backing; // What was asked of the system.
+	};
+
+	/** Allocate at least size bytes, aligned to at least 64 bytes.
+	 *
+	 * @throws std::bad_alloc if no memory could be allocated at all.
+	 */
+	block allocate(std::size_t size);
+
+	void free(const block& block);
+
+	/** Log how much memory currently is and isn't backed by huge pages.
+	 *
+	 * Whether the kernel honored transparent huge pages is only sampled here, as that means reading all mappings of the process.
+	 */
+	void report();
+} // namespace streamfx::util::hugepage
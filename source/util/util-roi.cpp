@@ -0,0 +1,81 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#include "util-roi.hpp"
+#include "plugin.hpp"
+
+#include "warning-disable.hpp"
+#include <algorithm>
+#include "warning-enable.hpp"
+
+// Regions older than this are from producers that stopped rendering.
+static constexpr std::chrono::milliseconds stale_after{1000};
+
+streamfx::util::roi::registry::~registry() {}
+
+streamfx::util::roi::registry::registry() : _lock(), _entries() {}
+
+void streamfx::util::roi::registry::publish(const void* scope, const void* owner, std::vector<region> regions)
+{
+	// Clamp to the output, and drop anything that ends up empty.
+	for (auto& region : regions) {
+		region.left   = std::clamp(region.left, 0.f, 1.f);
+		region.top    = std::clamp(region.top, 0.f, 1.f);
+		region.right  = std::clamp(region.right, 0.f, 1.f);
+		region.bottom = std::clamp(region.bottom, 0.f, 1.f);
+	}
+	regions.erase(std::remove_if(regions.begin(), regions.end(), [](const region& region) { return (region.right <= region.left) || (region.bottom <= region.top); }), regions.end());
+
+	std::lock_guard<std::mutex> lock(_lock);
+	auto&                       entry = _entries[owner];
+	entry.scope                       = scope;
+	entry.regions                     = std::move(regions);
+	entry.published                   = std::chrono::steady_clock::now();
+}
+
+void streamfx::util::roi::registry::withdraw(const void* owner)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_entries.erase(owner);
+}
+
+std::vector<streamfx::util::roi::region> streamfx::util::roi::registry::collect(const void* scope)
+{
+	std::vector<region> regions;
+	auto                now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(_lock);
+	for (auto& kv : _entries) {
+		if ((kv.second.scope != scope) || ((now - kv.second.published) > stale_after)) {
+			continue;
+		}
+		regions.insert(regions.end(), kv.second.regions.begin(), kv.second.regions.end());
+	}
+	return regions;
+}
+
+std::shared_ptr<streamfx::util::roi::registry> streamfx::util::roi::registry::instance()
+{
+	static std::weak_ptr<streamfx::util::roi::registry> winst;
+	static std::mutex                                   mtx;
+
+	std::unique_lock<decltype(mtx)> lock(mtx);
+	auto                            instance = winst.lock();
+	if (!instance) {
+		instance = std::shared_ptr<streamfx::util::roi::registry>(new streamfx::util::roi::registry());
+		winst    = instance;
+	}
+	return instance;
+}
+
+static std::shared_ptr<streamfx::util::roi::registry> loader_instance;
+
+static auto loader = streamfx::loader(
+	[]() { // Initializer
+		loader_instance = streamfx::util::roi::registry::instance();
+	},
+	[]() { // Finalizer
+		loader_instance.reset();
+	},
+	streamfx::loader_priority::HIGH);
@@ -0,0 +1,65 @@
+// AUTOGENERATED COPYRIGHT HEADER START
+// Copyright (C) 2023 Michael Fabian 'Xaymar' Dirks <info@xaymar.com>
+// AUTOGENERATED COPYRIGHT HEADER END
+
+#pragma once
+#include "common.hpp"
+
+#include "warning-disable.hpp"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "warning-enable.hpp"
+
+/* Regions of interest are parts of the output that deserve more bits than the
+ *  rest, like the face in a talking head stream.
+ *
+ * Producers (such as the auto-framing filter) publish their regions here for
+ *  a scope, which is the video output (video_t) they appear in. Encoders only
+ *  collect the regions of the video output they encode, so a producer on one
+ *  canvas doesn't steer the encoders of another. Regions are normalized to the
+ *  output, with (0, 0) at the top left and (1, 1) at the bottom right. Anything
+ *  not republished within a second is considered stale and ignored, so that a
+ *  producer that stops rendering doesn't leave regions behind.
+ */
+
+namespace streamfx::util::roi {
+	struct region {
+		float left;
+		float top;
+		float right;
+		float bottom;
+	};
+
+	class registry {
+		struct entry {
+			const void*                           scope;
+			std::vector<region>                   regions;
+			std::chrono::steady_clock::time_point published;
+		};
+
+		std::mutex                   _lock;
+		std::map<const void*, entry> _entries;
+
+		public:
+		~registry();
+		registry();
+
+		/** Replace all regions of a producer, and move them to a scope.
+		 */
+		void publish(const void* scope, const void* owner, std::vector<region> regions);
+
+		/** Remove all regions of a producer.
+		 */
+		void withdraw(const void* owner);
+
+		/** Get the regions of all producers that are still publishing to a scope.
+		 */
+		std::vector<region> collect(const void* scope);
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::util::roi::registry> instance();
+	};
+} // namespace streamfx::util::roi
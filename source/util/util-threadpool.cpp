@@ -7,9 +7,11 @@
 #include "util-threadpool.hpp"
 #include "common.hpp"
 #include "plugin.hpp"
+#include "util/util-affinity.hpp"
 #include "util/util-logging.hpp"
 
 #include "warning-disable.hpp"
+#include <algorithm>
 #include <cstddef>
 #include "warning-enable.hpp"
 
@@ -35,16 +37,24 @@
 #define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
 #endif
 
-streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data) : _callback(callback), _data(data), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
+streamfx::util::threadpool::task::task(task_callback_t callback, task_data_t data) : _callback(callback), _step(), _data(data), _interval(0), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
+
+streamfx::util::threadpool::task::task(task_step_t step, task_data_t data, std::chrono::nanoseconds interval) : _callback(), _step(step), _data(data), _interval(interval), _lock(), _status_changed(), _cancelled(false), _completed(false), _failed(false) {}
 
 streamfx::util::threadpool::task::~task() {}
 
-void streamfx::util::threadpool::task::run()
+bool streamfx::util::threadpool::task::run()
 {
 	std::lock_guard<std::mutex> lg(_lock);
 	if (!_cancelled) {
 		try {
-			_callback(_data);
+			if (_step) {
+				if (!_step(_data)) {
+					return false;
+				}
+			} else {
+				_callback(_data);
+			}
 		} catch (const std::exception& ex) {
 			D_LOG_ERROR("Unhandled exception in Task: %s.", ex.what());
 			_failed = false;
@@ -55,6 +65,12 @@ void streamfx::util::threadpool::task::run()
 	}
 	_completed = true;
 	_status_changed.notify_all();
+	return true;
+}
+
+std::chrono::nanoseconds streamfx::util::threadpool::task::get_interval()
+{
+	return _interval;
 }
 
 void streamfx::util::threadpool::task::cancel()
@@ -101,6 +117,14 @@ streamfx::util::threadpool::threadpool::~threadpool()
 			task->cancel();
 		}
 		_tasks.clear();
+		for (auto kv : _timed) {
+			kv.second->cancel();
+		}
+		_timed.clear();
+		for (auto kv : _dependent) {
+			kv.second->cancel();
+		}
+		_dependent.clear();
 	}
 
 	{ // Notify workers to stop working.
@@ -120,7 +144,7 @@ streamfx::util::threadpool::threadpool::~threadpool()
 	}
 }
 
-streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _worker_count(0), _workers(), _tasks_lock(), _tasks_cv(), _tasks()
+streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximum) : _limits{minimum, maximum}, _workers_lock(), _worker_count(0), _workers(), _tasks_lock(), _tasks_cv(), _tasks(), _timed(), _dependent()
 {
 	// Spawn the minimum number of threads.
 	spawn(_limits.first);
@@ -129,18 +153,45 @@ streamfx::util::threadpool::threadpool::threadpool(size_t minimum, size_t maximu
 std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push(task_callback_t callback, task_data_t data /*= nullptr*/)
 {
 	std::lock_guard<std::mutex> lg(_tasks_lock);
-	constexpr size_t            threshold = 3;
 
-	// Enqueue the new task.
 	auto task = std::make_shared<streamfx::util::threadpool::task>(callback, data);
-	_tasks.emplace_back(task);
+	enqueue(task);
 
-	// Spawn additional workers if the number of queued tasks exceeds a threshold.
-	if (_tasks.size() > (threshold * _worker_count)) {
-		spawn(_tasks.size() / threshold);
+	// Return handle to caller.
+	return task;
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push_delayed(std::chrono::nanoseconds delay, task_callback_t callback, task_data_t data /*= nullptr*/)
+{
+	std::lock_guard<std::mutex> lg(_tasks_lock);
+
+	auto task = std::make_shared<streamfx::util::threadpool::task>(callback, data);
+	_timed.emplace_back(std::chrono::high_resolution_clock::now() + delay, task);
+
+	// Let a sleeping worker pick up the new wake up time.
+	_tasks_cv.notify_one();
+	return task;
+}
+
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push_after(std::shared_ptr<task> dependency, task_callback_t callback, task_data_t data /*= nullptr*/)
+{
+	std::lock_guard<std::mutex> lg(_tasks_lock);
+
+	auto task = std::make_shared<streamfx::util::threadpool::task>(callback, data);
+	if (!dependency || dependency->is_completed()) {
+		enqueue(task);
+	} else {
+		_dependent.emplace_back(dependency, task);
 	}
+	return task;
+}
 
-	// Return handle to caller.
+std::shared_ptr<streamfx::util::threadpool::task> streamfx::util::threadpool::threadpool::push_steps(task_step_t step, std::chrono::nanoseconds interval, task_data_t data /*= nullptr*/)
+{
+	std::lock_guard<std::mutex> lg(_tasks_lock);
+
+	auto task = std::make_shared<streamfx::util::threadpool::task>(step, data, interval);
+	enqueue(task);
 	return task;
 }
 
@@ -151,6 +202,51 @@ void streamfx::util::threadpool::threadpool::pop(std::shared_ptr<task> task)
 	}
 	std::lock_guard<std::mutex> lg(_tasks_lock);
 	_tasks.remove(task);
+	_timed.remove_if([&task](const auto& kv) { return kv.second == task; });
+	_dependent.remove_if([&task](const auto& kv) { return kv.second == task; });
+}
+
+void streamfx::util::threadpool::threadpool::enqueue(std::shared_ptr<task> task)
+{
+	constexpr size_t threshold = 3;
+
+	// Enqueue the new task.
+	_tasks.emplace_back(task);
+	_tasks_cv.notify_one();
+
+	// Spawn additional workers if the number of queued tasks exceeds a threshold.
+	if (_tasks.size() > (threshold * _worker_count)) {
+		spawn(_tasks.size() / threshold);
+	}
+}
+
+std::chrono::high_resolution_clock::time_point streamfx::util::threadpool::threadpool::schedule()
+{
+	auto now  = std::chrono::high_resolution_clock::now();
+	auto wake = now + std::chrono::milliseconds(250);
+
+	// Release tasks whose time has come.
+	for (auto iter = _timed.begin(); iter != _timed.end();) {
+		if (iter->first <= now) {
+			enqueue(iter->second);
+			iter = _timed.erase(iter);
+		} else {
+			wake = std::min(wake, iter->first);
+			iter++;
+		}
+	}
+
+	// Release tasks whose dependency is done.
+	for (auto iter = _dependent.begin(); iter != _dependent.end();) {
+		if (iter->first->is_completed()) {
+			enqueue(iter->second);
+			iter = _dependent.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+
+	return wake;
 }
 
 void streamfx::util::threadpool::threadpool::spawn(size_t count)
@@ -205,14 +301,22 @@ void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> w
 	pthread_setname_np(pthread_self(), "StreamFX Worker Thread");
 #endif
 
+	if (streamfx::util::affinity::policy::instance()->apply(streamfx::util::affinity::role::Worker)) {
+		streamfx::util::affinity::cpus_t cpus;
+		streamfx::util::affinity::get_current(cpus);
+		D_LOG_DEBUG("Worker thread placed on processors %s.", streamfx::util::affinity::to_string(cpus).c_str());
+	}
+
 	while (!wi->stop) {
 		{ // Try and acquire new work.
 			std::unique_lock<std::mutex> ul(_tasks_lock);
 
 			// Is there any work available right now?
+			auto wake = schedule();
 			if (_tasks.size() == 0) { // If not:
-				// Block this thread until it is notified of a change.
-				_tasks_cv.wait_until(ul, std::chrono::time_point(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(250)), [this, wi]() { return wi->stop || _tasks.size() > 0; });
+				// Block this thread until it is notified of a change, or a timed task is due.
+				_tasks_cv.wait_until(ul, wake);
+				schedule();
 			}
 
 			// If we were asked to stop, skip everything.
@@ -231,7 +335,13 @@ void streamfx::util::threadpool::threadpool::work(std::shared_ptr<worker_info> w
 		}
 
 		if (task) {
-			task->run();
+			if (!task->run()) {
+				// The task yielded, resume it later.
+				std::lock_guard<std::mutex> lg(_tasks_lock);
+				if (!task->is_cancelled()) {
+					_timed.emplace_back(std::chrono::high_resolution_clock::now() + task->get_interval(), task);
+				}
+			}
 			task.reset();
 		}
 	}
@@ -22,6 +22,14 @@ namespace streamfx::util::threadpool {
 	typedef std::shared_ptr<void>            task_data_t;
 	typedef std::function<void(task_data_t)> task_callback_t;
 
+	/** A task split into steps, returning true once it is done.
+	 *
+	 * Between steps, the task yields its worker for the given interval instead
+	 *  of blocking it, so that I/O-bound work (polling a transfer, waiting for
+	 *  a file or the GPU) doesn't starve everything else in the pool.
+	 */
+	typedef std::function<bool(task_data_t)> task_step_t;
+
 	struct worker_info {
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
@@ -39,9 +47,11 @@ namespace streamfx::util::threadpool {
 	};
 
 	class task {
-		task_callback_t _callback;
-		task_data_t     _data;
-		std::mutex      _lock;
+		task_callback_t          _callback;
+		task_step_t              _step;
+		task_data_t              _data;
+		std::chrono::nanoseconds _interval;
+		std::mutex               _lock;
 
 #if __cpp_lib_hardware_interference_size >= 201603
 		alignas(std::hardware_destructive_interference_size)
@@ -63,11 +73,21 @@ namespace streamfx::util::threadpool {
 		public:
 		task(task_callback_t callback, task_data_t data);
 
+		public:
+		task(task_step_t step, task_data_t data, std::chrono::nanoseconds interval);
+
 		public:
 		~task();
 
 		public:
-		void run();
+		/** Run the task, or the next step of it.
+		 *
+		 * @return false if the task yielded and wants to run again after get_interval().
+		 */
+		bool run();
+
+		public:
+		std::chrono::nanoseconds get_interval();
 
 		public:
 		void cancel();
@@ -112,6 +132,10 @@ namespace streamfx::util::threadpool {
 			std::condition_variable _tasks_cv;
 		std::list<std::shared_ptr<task>> _tasks;
 
+		// Tasks waiting for a point in time, or for another task to complete. Neither occupies a worker.
+		std::list<std::pair<std::chrono::high_resolution_clock::time_point, std::shared_ptr<task>>> _timed;
+		std::list<std::pair<std::shared_ptr<task>, std::shared_ptr<task>>>                        _dependent;
+
 		public:
 		~threadpool();
 
@@ -121,9 +145,30 @@ namespace streamfx::util::threadpool {
 		public:
 		std::shared_ptr<task> push(task_callback_t callback, task_data_t data = nullptr);
 
+		public:
+		/** Run a task once a delay has passed, without occupying a worker in the mean time.
+		 */
+		std::shared_ptr<task> push_delayed(std::chrono::nanoseconds delay, task_callback_t callback, task_data_t data = nullptr);
+
+		public:
+		/** Run a task once another one has completed or was cancelled.
+		 */
+		std::shared_ptr<task> push_after(std::shared_ptr<task> dependency, task_callback_t callback, task_data_t data = nullptr);
+
+		public:
+		/** Run a task in steps, yielding the worker for the given interval whenever a step isn't done yet.
+		 */
+		std::shared_ptr<task> push_steps(task_step_t step, std::chrono::nanoseconds interval, task_data_t data = nullptr);
+
 		public:
 		void pop(std::shared_ptr<task> task);
 
+		private:
+		void enqueue(std::shared_ptr<task> task);
+
+		private:
+		std::chrono::high_resolution_clock::time_point schedule();
+
 		private:
 		void spawn(size_t count = 1);
 